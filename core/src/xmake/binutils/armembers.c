@@ -0,0 +1,208 @@
+/*!A cross-platform build utility based on Lua
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Copyright (C) 2015-present, Xmake Open Source Community.
+ *
+ * @author      ruki
+ * @file        armembers.c
+ *
+ */
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * trace
+ */
+#define TB_TRACE_MODULE_NAME "armembers"
+#define TB_TRACE_MODULE_DEBUG (0)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "prefix.h"
+#include "ar/prefix.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * private implementation
+ */
+
+/* get the member name from the GNU/MSVC long names table ("//"), e.g. "/123"
+ *
+ * the names are terminated by "/\n" in GNU ar, and by '\0' in MSVC lib
+ */
+static tb_bool_t xm_binutils_armembers_longname(tb_char_t const *longnames, tb_size_t longnames_size,
+                                                xm_ar_header_t const *header, tb_char_t *name, tb_size_t name_size) {
+    tb_int64_t offset = xm_binutils_ar_parse_decimal(header->name + 1, 15);
+    tb_check_return_val(longnames && offset >= 0 && (tb_size_t)offset < longnames_size, tb_false);
+
+    tb_size_t        i = 0;
+    tb_char_t const *p = longnames + offset;
+    tb_char_t const *e = longnames + longnames_size;
+    while (p < e && *p && *p != '\n' && i + 1 < name_size) {
+        if (*p == '/' && (p + 1 == e || p[1] == '\n')) {
+            break;
+        }
+        name[i++] = *p++;
+    }
+    name[i] = '\0';
+    return i > 0;
+}
+
+/* read all members of the given ar archive, the member data will be skipped
+ *
+ * we only read the member headers, so it's fast enough to verify the members of the large archive
+ */
+static tb_bool_t xm_binutils_armembers_read(tb_stream_ref_t istream, lua_State *lua) {
+
+    // check magic, the thin archive does not contain the member data
+    tb_uint8_t magic[8];
+    tb_check_return_val(tb_stream_bread(istream, magic, 8), tb_false);
+    tb_bool_t is_thin = !tb_memcmp(magic, "!<thin>\n", 8);
+    if (!is_thin && !xm_binutils_ar_check_magic(istream, 0)) {
+        return tb_false;
+    }
+
+    tb_bool_t  ok             = tb_true;
+    tb_char_t *longnames      = tb_null;
+    tb_size_t  longnames_size = 0;
+    tb_int_t   count          = 0;
+    while (1) {
+
+        // read the member header
+        xm_ar_header_t header;
+        if (!tb_stream_bread(istream, (tb_byte_t *)&header, sizeof(header))) {
+            break;
+        }
+        if (header.fmag[0] != '`' || header.fmag[1] != '\n') {
+            ok = tb_false;
+            break;
+        }
+
+        tb_int64_t member_size = xm_binutils_ar_parse_decimal(header.size, 10);
+        if (member_size < 0) {
+            ok = tb_false;
+            break;
+        }
+
+        // read the long names table
+        tb_bool_t has_data  = tb_true;
+        tb_hize_t skip_size = 0;
+        if (header.name[0] == '/' && header.name[1] == '/') {
+            if (longnames || !member_size) {
+                ok = tb_false;
+                break;
+            }
+            longnames_size = (tb_size_t)member_size;
+            longnames      = (tb_char_t *)tb_malloc_bytes(longnames_size);
+            if (!longnames || !tb_stream_bread(istream, (tb_byte_t *)longnames, longnames_size)) {
+                ok = tb_false;
+                break;
+            }
+        } else {
+            // get the member name
+            tb_char_t name[TB_PATH_MAXN] = { 0 };
+            tb_size_t name_len           = 0;
+            tb_hize_t name_bytes         = 0;
+            if (header.name[0] == '/' && header.name[1] >= '0' && header.name[1] <= '9') {
+                if (!xm_binutils_armembers_longname(longnames, longnames_size, &header, name, sizeof(name))) {
+                    ok = tb_false;
+                    break;
+                }
+            } else if (!xm_binutils_ar_get_member_name(istream, &header, name, sizeof(name), &name_len, &name_bytes)) {
+                ok = tb_false;
+                break;
+            }
+
+            /* the symbol table and all members of the normal archive contain data,
+             * but the members of the thin archive only refer to the external files
+             */
+            tb_bool_t is_symtab = xm_binutils_ar_is_symbol_table(name);
+            has_data            = !is_thin || is_symtab;
+            if (has_data && (tb_hize_t)member_size > name_bytes) {
+                skip_size = (tb_hize_t)member_size - name_bytes;
+            }
+
+            // save this member, e.g. {name = "foo.o", size = 1024}
+            if (!is_symtab) {
+                lua_newtable(lua);
+                lua_pushstring(lua, "name");
+                lua_pushstring(lua, name);
+                lua_settable(lua, -3);
+                lua_pushstring(lua, "size");
+                lua_pushinteger(lua, (lua_Integer)(member_size - (tb_int64_t)name_bytes));
+                lua_settable(lua, -3);
+                lua_rawseti(lua, -2, ++count);
+            }
+        }
+
+        // skip the member data and padding
+        if (has_data && (member_size % 2)) {
+            skip_size++;
+        }
+        if (skip_size && !tb_stream_skip(istream, skip_size)) {
+            ok = tb_false;
+            break;
+        }
+    }
+
+    if (longnames) {
+        tb_free(longnames);
+    }
+    return ok;
+}
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */
+
+/* get all members of the static library (ar/thin ar/msvc lib)
+ *
+ * @param lua the lua state
+ *
+ * libraryfile = lua[1]
+ *
+ * @return 1 on success (members list), 2 on failure (with error message)
+ *
+ * e.g. {{name = "foo.o", size = 1024}, {name = "bar.o", size = 2048}}
+ */
+tb_int_t xm_binutils_armembers(lua_State *lua) {
+    tb_assert_and_check_return_val(lua, 0);
+
+    // get the library file path
+    tb_char_t const *libraryfile = luaL_checkstring(lua, 1);
+    tb_check_return_val(libraryfile, 0);
+
+    // open library file
+    tb_stream_ref_t istream = tb_stream_init_from_file(libraryfile, TB_FILE_MODE_RO);
+    if (!istream) {
+        lua_pushboolean(lua, tb_false);
+        lua_pushfstring(lua, "open %s failed", libraryfile);
+        return 2;
+    }
+
+    tb_bool_t ok = tb_false;
+    lua_newtable(lua);
+    if (tb_stream_open(istream)) {
+        ok = xm_binutils_armembers_read(istream, lua);
+    }
+
+    tb_stream_close(istream);
+    tb_stream_exit(istream);
+
+    if (!ok) {
+        lua_pop(lua, 1);
+        lua_pushboolean(lua, tb_false);
+        lua_pushfstring(lua, "read members of %s failed", libraryfile);
+        return 2;
+    }
+    return 1;
+}
@@ -0,0 +1,446 @@
+/*!A cross-platform build utility based on Lua
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Copyright (C) 2015-present, Xmake Open Source Community.
+ *
+ * @author      ruki
+ * @file        bloom.c
+ *
+ */
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * trace
+ */
+#define TB_TRACE_MODULE_NAME "bloom"
+#define TB_TRACE_MODULE_DEBUG (0)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "bloom.h"
+#define XXH_NAMESPACE XM_
+#define XXH_STATIC_LINKING_ONLY
+#include "xxhash/xxhash.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// the block size, we use one cache line for each item
+#define XM_BLOOM_BLOCK_SIZE (64)
+
+// the block bits
+#define XM_BLOOM_BLOCK_BITS (XM_BLOOM_BLOCK_SIZE << 3)
+
+// the block words
+#define XM_BLOOM_BLOCK_WORDS (XM_BLOOM_BLOCK_SIZE / sizeof(tb_uint64_t))
+
+// the max blocks count (1G)
+#define XM_BLOOM_BLOCK_MAXN (1 << 24)
+
+// the max hash count
+#define XM_BLOOM_HASH_MAXN (16)
+
+// the bits overhead (percent) of the blocked bloom filter, because the items are not distributed uniformly in the blocks
+#define XM_BLOOM_BITS_OVERHEAD (125)
+
+/* the data header size, it's padded to the block size to keep the blocks aligned
+ *
+ * magic:       "XMBF"
+ * version:     u8
+ * kind:        u8, full or delta
+ * hash_count:  u8
+ * probability: u8
+ * blocks:      u32be
+ * item_maxn:   u32be
+ * count:       u32be, the block count of the delta data
+ * reserved:    44 bytes
+ */
+#define XM_BLOOM_HEAD_SIZE (XM_BLOOM_BLOCK_SIZE)
+
+// the data kind
+#define XM_BLOOM_KIND_FULL  (0)
+#define XM_BLOOM_KIND_DELTA (1)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+/* the bloom filter type
+ *
+ * each item only touches one block (one cache line), and all bits of the item are tested in one block,
+ * so it need not scatter the hash probes over the whole bitmap.
+ *
+ * we still keep the legacy tbox bloom filter to load the data from the old server.
+ */
+typedef struct __xm_bloom_t {
+    // the data version
+    tb_size_t version;
+
+    // the probability
+    tb_size_t probability;
+
+    // the hash count
+    tb_size_t hash_count;
+
+    // the max item count
+    tb_size_t item_maxn;
+
+    // the legacy bloom filter
+    tb_bloom_filter_ref_t legacy;
+
+    // the blocks count
+    tb_size_t blocks_count;
+
+    // the data, header + blocks, it's aligned to the block size in the allocated buffer
+    tb_byte_t *data;
+    tb_byte_t *buffer;
+
+    // the dirty blocks bitmap for the delta data
+    tb_byte_t *dirty;
+
+    // the delta data
+    tb_byte_t *delta;
+    tb_size_t delta_maxn;
+
+} xm_bloom_t;
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * private implementation
+ */
+static __tb_inline__ tb_uint64_t *xm_bloom_block(xm_bloom_t *filter, tb_size_t index) {
+    return (tb_uint64_t *)(filter->data + XM_BLOOM_HEAD_SIZE + index * XM_BLOOM_BLOCK_SIZE);
+}
+static tb_void_t xm_bloom_head_init(xm_bloom_t *filter, tb_byte_t *head, tb_size_t kind, tb_size_t count) {
+    tb_memset(head, 0, XM_BLOOM_HEAD_SIZE);
+    tb_memcpy(head, "XMBF", 4);
+    head[4] = (tb_byte_t)XM_BLOOM_VERSION;
+    head[5] = (tb_byte_t)kind;
+    head[6] = (tb_byte_t)filter->hash_count;
+    head[7] = (tb_byte_t)filter->probability;
+    tb_bits_set_u32_be(head + 8, (tb_uint32_t)filter->blocks_count);
+    tb_bits_set_u32_be(head + 12, (tb_uint32_t)tb_min(filter->item_maxn, (tb_size_t)0xffffffff));
+    tb_bits_set_u32_be(head + 16, (tb_uint32_t)count);
+}
+static tb_bool_t xm_bloom_head_check(tb_byte_t const *data, tb_size_t size) {
+    return data && size >= XM_BLOOM_HEAD_SIZE && !tb_memcmp(data, "XMBF", 4) && data[4] == XM_BLOOM_VERSION;
+}
+static tb_bool_t xm_bloom_blocks_init(xm_bloom_t *filter, tb_size_t blocks_count) {
+    tb_assert_and_check_return_val(blocks_count && blocks_count <= XM_BLOOM_BLOCK_MAXN, tb_false);
+
+    // exit the previous blocks
+    if (filter->buffer) {
+        tb_free(filter->buffer);
+        filter->buffer = tb_null;
+        filter->data = tb_null;
+    }
+    if (filter->dirty) {
+        tb_free(filter->dirty);
+        filter->dirty = tb_null;
+    }
+
+    // init the blocks
+    filter->blocks_count = blocks_count;
+    filter->buffer = (tb_byte_t *)tb_malloc0(XM_BLOOM_HEAD_SIZE + (blocks_count + 1) * XM_BLOOM_BLOCK_SIZE);
+    filter->dirty = (tb_byte_t *)tb_malloc0((blocks_count + 7) >> 3);
+    tb_assert_and_check_return_val(filter->buffer && filter->dirty, tb_false);
+
+    // each block is in one cache line
+    filter->data = (tb_byte_t *)tb_align((tb_size_t)filter->buffer, XM_BLOOM_BLOCK_SIZE);
+
+    xm_bloom_head_init(filter, filter->data, XM_BLOOM_KIND_FULL, 0);
+    return tb_true;
+}
+static tb_void_t xm_bloom_hash(xm_bloom_t *filter,
+                                      tb_char_t const *item,
+                                      tb_size_t *pindex,
+                                      tb_uint64_t mask[XM_BLOOM_BLOCK_WORDS]) {
+    tb_uint64_t hash = XXH3_64bits(item, tb_strlen(item));
+
+    // get the block index from the high 32-bits, (hash * blocks) >> 32 is faster than modulo
+    *pindex = (tb_size_t)(((hash >> 32) * (tb_uint64_t)filter->blocks_count) >> 32);
+
+    // get the bit positions in this block by the double hashing
+    tb_size_t i;
+    tb_byte_t *bits = (tb_byte_t *)mask;
+    tb_uint32_t hash1 = (tb_uint32_t)hash;
+    tb_uint32_t hash2 = (tb_uint32_t)((hash * 0x9e3779b97f4a7c15ULL) >> 32) | 1;
+    tb_memset(mask, 0, XM_BLOOM_BLOCK_SIZE);
+    for (i = 0; i < filter->hash_count; i++) {
+        tb_uint32_t bit = (hash1 + (tb_uint32_t)i * hash2) & (XM_BLOOM_BLOCK_BITS - 1);
+        bits[bit >> 3] |= (tb_byte_t)(1 << (bit & 7));
+    }
+}
+static tb_bool_t xm_bloom_block_merge(xm_bloom_t *filter, tb_size_t index, tb_byte_t const *data) {
+    tb_size_t i;
+    tb_uint64_t changed = 0;
+    tb_uint64_t other[XM_BLOOM_BLOCK_WORDS];
+    tb_uint64_t *block = xm_bloom_block(filter, index);
+    tb_memcpy(other, data, XM_BLOOM_BLOCK_SIZE);
+    for (i = 0; i < XM_BLOOM_BLOCK_WORDS; i++) {
+        changed |= other[i] & ~block[i];
+        block[i] |= other[i];
+    }
+    if (changed) {
+        filter->dirty[index >> 3] |= (tb_byte_t)(1 << (index & 7));
+    }
+    return changed != 0;
+}
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */
+xm_bloom_ref_t xm_bloom_init(tb_size_t probability, tb_size_t hash_count, tb_size_t item_maxn, tb_size_t version) {
+    tb_assert_and_check_return_val(probability && probability < 32 && hash_count && hash_count <= XM_BLOOM_HASH_MAXN, tb_null);
+
+    tb_bool_t ok = tb_false;
+    xm_bloom_t *filter = tb_null;
+    do {
+        filter = tb_malloc0_type(xm_bloom_t);
+        tb_assert_and_check_break(filter);
+
+        filter->version = version;
+        filter->probability = probability;
+        filter->hash_count = hash_count;
+        filter->item_maxn = item_maxn;
+
+        // init the legacy bloom filter
+        if (version == XM_BLOOM_VERSION_LEGACY) {
+            filter->legacy = tb_bloom_filter_init(probability, hash_count, item_maxn, tb_element_str(tb_true));
+            tb_assert_and_check_break(filter->legacy);
+            ok = tb_true;
+            break;
+        }
+        tb_assert_and_check_break(version == XM_BLOOM_VERSION);
+
+        /* the bits count of the standard bloom filter, m = n * log2(1/p) / ln(2), 1 / ln(2) ~= 1477 / 1024,
+         * and the blocked bloom filter needs more bits for the same false positive probability
+         */
+        tb_hize_t bits = ((tb_hize_t)tb_max(item_maxn, (tb_size_t)1) * probability * 1477) >> 10;
+        bits = bits * XM_BLOOM_BITS_OVERHEAD / 100;
+        tb_hize_t blocks_count = (bits + XM_BLOOM_BLOCK_BITS - 1) / XM_BLOOM_BLOCK_BITS;
+        tb_assert_and_check_break(blocks_count <= XM_BLOOM_BLOCK_MAXN);
+        ok = xm_bloom_blocks_init(filter, (tb_size_t)blocks_count);
+
+    } while (0);
+
+    if (!ok && filter) {
+        xm_bloom_exit((xm_bloom_ref_t)filter);
+        filter = tb_null;
+    }
+    return (xm_bloom_ref_t)filter;
+}
+tb_void_t xm_bloom_exit(xm_bloom_ref_t self) {
+    xm_bloom_t *filter = (xm_bloom_t *)self;
+    tb_assert_and_check_return(filter);
+
+    if (filter->legacy) {
+        tb_bloom_filter_exit(filter->legacy);
+        filter->legacy = tb_null;
+    }
+    if (filter->buffer) {
+        tb_free(filter->buffer);
+        filter->buffer = tb_null;
+        filter->data = tb_null;
+    }
+    if (filter->dirty) {
+        tb_free(filter->dirty);
+        filter->dirty = tb_null;
+    }
+    if (filter->delta) {
+        tb_free(filter->delta);
+        filter->delta = tb_null;
+    }
+    tb_free(filter);
+}
+tb_void_t xm_bloom_clear(xm_bloom_ref_t self) {
+    xm_bloom_t *filter = (xm_bloom_t *)self;
+    tb_assert_and_check_return(filter);
+
+    if (filter->legacy) {
+        tb_bloom_filter_clear(filter->legacy);
+    } else if (filter->data) {
+        tb_memset(filter->data + XM_BLOOM_HEAD_SIZE, 0, filter->blocks_count * XM_BLOOM_BLOCK_SIZE);
+        tb_memset(filter->dirty, 0, (filter->blocks_count + 7) >> 3);
+    }
+}
+tb_bool_t xm_bloom_set(xm_bloom_ref_t self, tb_char_t const *item) {
+    xm_bloom_t *filter = (xm_bloom_t *)self;
+    tb_assert_and_check_return_val(filter && item, tb_false);
+
+    if (filter->legacy) {
+        return tb_bloom_filter_set(filter->legacy, item);
+    }
+
+    tb_size_t i;
+    tb_size_t index;
+    tb_uint64_t missing = 0;
+    tb_uint64_t mask[XM_BLOOM_BLOCK_WORDS];
+    xm_bloom_hash(filter, item, &index, mask);
+    tb_uint64_t *block = xm_bloom_block(filter, index);
+    for (i = 0; i < XM_BLOOM_BLOCK_WORDS; i++) {
+        missing |= mask[i] & ~block[i];
+        block[i] |= mask[i];
+    }
+    if (missing) {
+        filter->dirty[index >> 3] |= (tb_byte_t)(1 << (index & 7));
+    }
+    return missing != 0;
+}
+tb_bool_t xm_bloom_get(xm_bloom_ref_t self, tb_char_t const *item) {
+    xm_bloom_t *filter = (xm_bloom_t *)self;
+    tb_assert_and_check_return_val(filter && item, tb_false);
+
+    if (filter->legacy) {
+        return tb_bloom_filter_get(filter->legacy, item);
+    }
+
+    // test all bits in one block, the compiler can vectorize it
+    tb_size_t i;
+    tb_size_t index;
+    tb_uint64_t missing = 0;
+    tb_uint64_t mask[XM_BLOOM_BLOCK_WORDS];
+    xm_bloom_hash(filter, item, &index, mask);
+    tb_uint64_t const *block = xm_bloom_block(filter, index);
+    for (i = 0; i < XM_BLOOM_BLOCK_WORDS; i++) {
+        missing |= mask[i] & ~block[i];
+    }
+    return missing == 0;
+}
+tb_byte_t const *xm_bloom_data(xm_bloom_ref_t self, tb_size_t *psize) {
+    xm_bloom_t *filter = (xm_bloom_t *)self;
+    tb_assert_and_check_return_val(filter && psize, tb_null);
+
+    if (filter->legacy) {
+        *psize = tb_bloom_filter_size(filter->legacy);
+        return (tb_byte_t const *)tb_bloom_filter_data(filter->legacy);
+    }
+    *psize = XM_BLOOM_HEAD_SIZE + filter->blocks_count * XM_BLOOM_BLOCK_SIZE;
+    return filter->data;
+}
+tb_bool_t xm_bloom_data_set(xm_bloom_ref_t self, tb_byte_t const *data, tb_size_t size) {
+    xm_bloom_t *filter = (xm_bloom_t *)self;
+    tb_assert_and_check_return_val(filter && data && size, tb_false);
+
+    // load the legacy data from the old server
+    if (!xm_bloom_head_check(data, size)) {
+        if (!filter->legacy) {
+            filter->legacy = tb_bloom_filter_init(filter->probability, filter->hash_count, filter->item_maxn, tb_element_str(tb_true));
+            tb_assert_and_check_return_val(filter->legacy, tb_false);
+            filter->version = XM_BLOOM_VERSION_LEGACY;
+            if (filter->buffer) {
+                tb_free(filter->buffer);
+                filter->buffer = tb_null;
+                filter->data = tb_null;
+            }
+            if (filter->dirty) {
+                tb_free(filter->dirty);
+                filter->dirty = tb_null;
+            }
+            filter->blocks_count = 0;
+        }
+        return tb_bloom_filter_data_set(filter->legacy, data, size);
+    }
+
+    // check the data
+    tb_size_t kind = data[5];
+    tb_size_t hash_count = data[6];
+    tb_size_t blocks_count = tb_bits_get_u32_be(data + 8);
+    tb_check_return_val(kind == XM_BLOOM_KIND_FULL && hash_count && hash_count <= XM_BLOOM_HASH_MAXN, tb_false);
+    tb_check_return_val(blocks_count && blocks_count <= XM_BLOOM_BLOCK_MAXN, tb_false);
+    tb_check_return_val(size == XM_BLOOM_HEAD_SIZE + blocks_count * XM_BLOOM_BLOCK_SIZE, tb_false);
+
+    // switch to the blocked bloom filter with the geometry of the given data
+    if (filter->legacy) {
+        tb_bloom_filter_exit(filter->legacy);
+        filter->legacy = tb_null;
+    }
+    filter->version = XM_BLOOM_VERSION;
+    filter->hash_count = hash_count;
+    filter->probability = data[7];
+    filter->item_maxn = tb_bits_get_u32_be(data + 12);
+    if (!filter->data || filter->blocks_count != blocks_count) {
+        if (!xm_bloom_blocks_init(filter, blocks_count)) {
+            return tb_false;
+        }
+    } else {
+        tb_memset(filter->dirty, 0, (blocks_count + 7) >> 3);
+    }
+    xm_bloom_head_init(filter, filter->data, XM_BLOOM_KIND_FULL, 0);
+    tb_memcpy(filter->data + XM_BLOOM_HEAD_SIZE, data + XM_BLOOM_HEAD_SIZE, size - XM_BLOOM_HEAD_SIZE);
+    return tb_true;
+}
+tb_byte_t const *xm_bloom_delta(xm_bloom_ref_t self, tb_size_t *psize) {
+    xm_bloom_t *filter = (xm_bloom_t *)self;
+    tb_assert_and_check_return_val(filter && psize && !filter->legacy, tb_null);
+
+    // get the dirty blocks count
+    tb_size_t i;
+    tb_size_t count = 0;
+    for (i = 0; i < filter->blocks_count; i++) {
+        if (filter->dirty[i >> 3] & (1 << (i & 7))) {
+            count++;
+        }
+    }
+
+    // make the delta data, header + (u32be index + block) * count
+    tb_size_t size = XM_BLOOM_HEAD_SIZE + count * (4 + XM_BLOOM_BLOCK_SIZE);
+    if (size > filter->delta_maxn) {
+        filter->delta = (tb_byte_t *)tb_ralloc(filter->delta, size);
+        tb_assert_and_check_return_val(filter->delta, tb_null);
+        filter->delta_maxn = size;
+    }
+    tb_byte_t *p = filter->delta;
+    xm_bloom_head_init(filter, p, XM_BLOOM_KIND_DELTA, count);
+    p += XM_BLOOM_HEAD_SIZE;
+    for (i = 0; i < filter->blocks_count; i++) {
+        if (filter->dirty[i >> 3] & (1 << (i & 7))) {
+            tb_bits_set_u32_be(p, (tb_uint32_t)i);
+            tb_memcpy(p + 4, xm_bloom_block(filter, i), XM_BLOOM_BLOCK_SIZE);
+            p += 4 + XM_BLOOM_BLOCK_SIZE;
+        }
+    }
+    tb_memset(filter->dirty, 0, (filter->blocks_count + 7) >> 3);
+    *psize = size;
+    return filter->delta;
+}
+tb_bool_t xm_bloom_merge(xm_bloom_ref_t self, tb_byte_t const *data, tb_size_t size) {
+    xm_bloom_t *filter = (xm_bloom_t *)self;
+    tb_assert_and_check_return_val(filter && !filter->legacy, tb_false);
+
+    // check the geometry, we can only merge the data with the same blocks and hash count
+    tb_check_return_val(xm_bloom_head_check(data, size), tb_false);
+    tb_size_t kind = data[5];
+    tb_size_t count = tb_bits_get_u32_be(data + 16);
+    tb_check_return_val(data[6] == filter->hash_count && tb_bits_get_u32_be(data + 8) == filter->blocks_count, tb_false);
+
+    tb_size_t i;
+    tb_byte_t const *p = data + XM_BLOOM_HEAD_SIZE;
+    if (kind == XM_BLOOM_KIND_FULL) {
+        tb_check_return_val(size == XM_BLOOM_HEAD_SIZE + filter->blocks_count * XM_BLOOM_BLOCK_SIZE, tb_false);
+        for (i = 0; i < filter->blocks_count; i++, p += XM_BLOOM_BLOCK_SIZE) {
+            xm_bloom_block_merge(filter, i, p);
+        }
+    } else if (kind == XM_BLOOM_KIND_DELTA) {
+        tb_check_return_val(size == XM_BLOOM_HEAD_SIZE + count * (4 + XM_BLOOM_BLOCK_SIZE), tb_false);
+        for (i = 0; i < count; i++, p += 4 + XM_BLOOM_BLOCK_SIZE) {
+            tb_size_t index = tb_bits_get_u32_be(p);
+            tb_check_return_val(index < filter->blocks_count, tb_false);
+            xm_bloom_block_merge(filter, index, p + 4);
+        }
+    } else {
+        return tb_false;
+    }
+    return tb_true;
+}
@@ -0,0 +1,141 @@
+/*!A cross-platform build utility based on Lua
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Copyright (C) 2015-present, Xmake Open Source Community.
+ *
+ * @author      ruki
+ * @file        bloom.h
+ *
+ */
+#ifndef XM_BLOOM_FILTER_BLOOM_H
+#define XM_BLOOM_FILTER_BLOOM_H
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "../prefix.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// the current data version of the blocked bloom filter
+#define XM_BLOOM_VERSION (2)
+
+// the legacy data version of the tbox bloom filter, it has no data header
+#define XM_BLOOM_VERSION_LEGACY (1)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * extern
+ */
+__tb_extern_c_enter__
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+/// the bloom filter type
+typedef struct {
+    tb_int_t dummy;
+} const *xm_bloom_ref_t;
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * interfaces
+ */
+
+/*! init the bloom filter
+ *
+ * @param probability       the false positive probability, p = 1 / 2^probability
+ * @param hash_count        the hash count of each item
+ * @param item_maxn         the max item count
+ * @param version           the data version, e.g. XM_BLOOM_VERSION
+ *
+ * @return                  the bloom filter
+ */
+xm_bloom_ref_t xm_bloom_init(tb_size_t probability, tb_size_t hash_count, tb_size_t item_maxn, tb_size_t version);
+
+/*! exit the bloom filter
+ *
+ * @param filter            the bloom filter
+ */
+tb_void_t xm_bloom_exit(xm_bloom_ref_t filter);
+
+/*! clear the bloom filter
+ *
+ * @param filter            the bloom filter
+ */
+tb_void_t xm_bloom_clear(xm_bloom_ref_t filter);
+
+/*! set the given item
+ *
+ * @param filter            the bloom filter
+ * @param item              the item
+ *
+ * @return                  tb_true if this item does not exist before, otherwise tb_false (maybe false positive)
+ */
+tb_bool_t xm_bloom_set(xm_bloom_ref_t filter, tb_char_t const *item);
+
+/*! get the given item
+ *
+ * @param filter            the bloom filter
+ * @param item              the item
+ *
+ * @return                  tb_true if this item exists (maybe false positive)
+ */
+tb_bool_t xm_bloom_get(xm_bloom_ref_t filter, tb_char_t const *item);
+
+/*! get the serialized data, the data of the blocked bloom filter has a versioned header
+ *
+ * @param filter            the bloom filter
+ * @param psize             the data size
+ *
+ * @return                  the data
+ */
+tb_byte_t const *xm_bloom_data(xm_bloom_ref_t filter, tb_size_t *psize);
+
+/*! load the serialized data, the legacy data of the tbox bloom filter is also supported
+ *
+ * @param filter            the bloom filter
+ * @param data              the data
+ * @param size              the data size
+ *
+ * @return                  tb_true or tb_false
+ */
+tb_bool_t xm_bloom_data_set(xm_bloom_ref_t filter, tb_byte_t const *data, tb_size_t size);
+
+/*! get the delta data of the changed blocks since the last delta, it can be merged to the other bloom filter
+ *
+ * @param filter            the bloom filter
+ * @param psize             the data size
+ *
+ * @return                  the delta data, it's valid until the next call
+ */
+tb_byte_t const *xm_bloom_delta(xm_bloom_ref_t filter, tb_size_t *psize);
+
+/*! merge the full or delta data of the other bloom filter with the same geometry
+ *
+ * @param filter            the bloom filter
+ * @param data              the data
+ * @param size              the data size
+ *
+ * @return                  tb_true or tb_false
+ */
+tb_bool_t xm_bloom_merge(xm_bloom_ref_t filter, tb_byte_t const *data, tb_size_t size);
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * extern
+ */
+__tb_extern_c_leave__
+
+#endif
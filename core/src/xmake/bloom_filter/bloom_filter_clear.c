@@ -42,11 +42,11 @@ tb_int_t xm_bloom_filter_clear(lua_State *lua) {
     }
 
     // get the bloom filter
-    tb_bloom_filter_ref_t filter = (tb_bloom_filter_ref_t)xm_lua_topointer(lua, 1);
+    xm_bloom_ref_t filter = (xm_bloom_ref_t)xm_lua_topointer(lua, 1);
     tb_check_return_val(filter, 0);
 
     // clear filter
-    tb_bloom_filter_clear(filter);
+    xm_bloom_clear(filter);
     lua_pushboolean(lua, tb_true);
     return 1;
 }
@@ -42,11 +42,12 @@ tb_int_t xm_bloom_filter_data(lua_State *lua) {
     }
 
     // get the bloom filter
-    tb_bloom_filter_ref_t filter = (tb_bloom_filter_ref_t)xm_lua_topointer(lua, 1);
+    xm_bloom_ref_t filter = (xm_bloom_ref_t)xm_lua_topointer(lua, 1);
     tb_check_return_val(filter, 0);
 
     // get data
-    tb_pointer_t data = (tb_pointer_t)tb_bloom_filter_data(filter);
+    tb_size_t size = 0;
+    tb_pointer_t data = (tb_pointer_t)xm_bloom_data(filter, &size);
     if (data) {
         xm_lua_pushpointer(lua, data);
     } else {
@@ -42,7 +42,7 @@ tb_int_t xm_bloom_filter_data_set(lua_State *lua) {
     }
 
     // get the bloom filter
-    tb_bloom_filter_ref_t filter = (tb_bloom_filter_ref_t)xm_lua_topointer(lua, 1);
+    xm_bloom_ref_t filter = (xm_bloom_ref_t)xm_lua_topointer(lua, 1);
     tb_check_return_val(filter, 0);
 
     // get data and size
@@ -62,7 +62,7 @@ tb_int_t xm_bloom_filter_data_set(lua_State *lua) {
     tb_assert_static(sizeof(lua_Integer) >= sizeof(tb_pointer_t));
 
     // set data
-    tb_bool_t ok = tb_bloom_filter_data_set(filter, data, size);
+    tb_bool_t ok = xm_bloom_data_set(filter, data, size);
     lua_pushboolean(lua, ok);
     return 1;
 }
@@ -0,0 +1,58 @@
+/*!A cross-platform build utility based on Lua
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Copyright (C) 2015-present, Xmake Open Source Community.
+ *
+ * @author      ruki
+ * @file        bloom_filter_delta.c
+ *
+ */
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * trace
+ */
+#define TB_TRACE_MODULE_NAME "bloom_filter_delta"
+#define TB_TRACE_MODULE_DEBUG (0)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "prefix.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */
+tb_int_t xm_bloom_filter_delta(lua_State *lua) {
+    tb_assert_and_check_return_val(lua, 0);
+
+    // is pointer?
+    if (!xm_lua_ispointer(lua, 1)) {
+        return 0;
+    }
+
+    // get the bloom filter
+    xm_bloom_ref_t filter = (xm_bloom_ref_t)xm_lua_topointer(lua, 1);
+    tb_check_return_val(filter, 0);
+
+    // get the delta data of the changed blocks
+    tb_size_t size = 0;
+    tb_pointer_t data = (tb_pointer_t)xm_bloom_delta(filter, &size);
+    if (data) {
+        xm_lua_pushpointer(lua, data);
+        lua_pushinteger(lua, (tb_int_t)size);
+        return 2;
+    }
+    lua_pushnil(lua);
+    return 1;
+}
@@ -40,6 +40,7 @@ tb_int_t xm_bloom_filter_open(lua_State *lua) {
     tb_int_t probability = (tb_int_t)lua_tointeger(lua, 1);
     tb_int_t hash_count  = (tb_int_t)lua_tointeger(lua, 2);
     tb_int_t item_maxn   = (tb_int_t)lua_tointeger(lua, 3);
+    tb_int_t version     = (tb_int_t)luaL_optinteger(lua, 4, XM_BLOOM_VERSION_LEGACY);
     if (hash_count > 16 || item_maxn < 0) {
         lua_pushnil(lua);
         lua_pushfstring(lua, "invalid hash count(%p) and item maxn(%d)!", hash_count, item_maxn);
@@ -47,7 +48,7 @@ tb_int_t xm_bloom_filter_open(lua_State *lua) {
     }
 
     // init the bloom filter
-    tb_bloom_filter_ref_t filter = tb_bloom_filter_init(probability, hash_count, item_maxn, tb_element_str(tb_true));
+    xm_bloom_ref_t filter = xm_bloom_init(probability, hash_count, item_maxn, version);
     if (filter) {
         xm_lua_pushpointer(lua, (tb_pointer_t)filter);
     } else {
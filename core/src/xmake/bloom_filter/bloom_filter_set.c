@@ -42,7 +42,7 @@ tb_int_t xm_bloom_filter_set(lua_State *lua) {
     }
 
     // get the bloom filter
-    tb_bloom_filter_ref_t filter = (tb_bloom_filter_ref_t)xm_lua_topointer(lua, 1);
+    xm_bloom_ref_t filter = (xm_bloom_ref_t)xm_lua_topointer(lua, 1);
     tb_check_return_val(filter, 0);
 
     // get item
@@ -50,7 +50,7 @@ tb_int_t xm_bloom_filter_set(lua_State *lua) {
     tb_assert_and_check_return_val(item, 0);
 
     // set item
-    tb_bool_t ok = tb_bloom_filter_set(filter, item);
+    tb_bool_t ok = xm_bloom_set(filter, item);
     lua_pushboolean(lua, ok);
     return 1;
 }
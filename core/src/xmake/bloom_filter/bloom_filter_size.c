@@ -42,11 +42,12 @@ tb_int_t xm_bloom_filter_size(lua_State *lua) {
     }
 
     // get the bloom filter
-    tb_bloom_filter_ref_t filter = (tb_bloom_filter_ref_t)xm_lua_topointer(lua, 1);
+    xm_bloom_ref_t filter = (xm_bloom_ref_t)xm_lua_topointer(lua, 1);
     tb_check_return_val(filter, 0);
 
     // get size
-    tb_size_t size = tb_bloom_filter_size(filter);
+    tb_size_t size = 0;
+    xm_bloom_data(filter, &size);
     lua_pushinteger(lua, (tb_int_t)size);
     return 1;
 }
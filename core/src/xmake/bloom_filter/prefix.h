@@ -25,5 +25,6 @@
  * includes
  */
 #include "../prefix.h"
+#include "bloom.h"
 
 #endif
@@ -29,6 +29,7 @@
  * includes
  */
 #include "xmake.h"
+#include "engine_alloc.h"
 #include "io/poller.h"
 #if defined(TB_CONFIG_OS_WINDOWS)
 #include <windows.h>
@@ -87,9 +88,6 @@
 #define XM_PROC_SELF_FILE "/proc/self/path/a.out"
 #endif
 
-// hook lua memory allocator
-#define XM_HOOK_LUA_MEMALLOC (0)
-
 /* //////////////////////////////////////////////////////////////////////////////////////
  * types
  */
@@ -99,6 +97,9 @@ typedef struct __xm_engine_t {
     // the lua
     lua_State *lua;
 
+    // the lua allocator
+    xm_engine_alloc_ref_t alloc;
+
     // the engine name
     tb_char_t name[64];
 
@@ -132,6 +133,7 @@ tb_int_t xm_os_mkdir(lua_State *lua);
 tb_int_t xm_os_cpdir(lua_State *lua);
 tb_int_t xm_os_chdir(lua_State *lua);
 tb_int_t xm_os_mtime(lua_State *lua);
+tb_int_t xm_os_stats(lua_State *lua);
 tb_int_t xm_os_sleep(lua_State *lua);
 tb_int_t xm_os_mclock(lua_State *lua);
 tb_int_t xm_os_curdir(lua_State *lua);
@@ -149,6 +151,7 @@ tb_int_t xm_os_getenv(lua_State *lua);
 tb_int_t xm_os_getenvs(lua_State *lua);
 tb_int_t xm_os_cpuinfo(lua_State *lua);
 tb_int_t xm_os_meminfo(lua_State *lua);
+tb_int_t xm_os_memstats(lua_State *lua);
 tb_int_t xm_os_readlink(lua_State *lua);
 tb_int_t xm_os_filesize(lua_State *lua);
 tb_int_t xm_os_access(lua_State *lua);
@@ -232,6 +235,8 @@ tb_int_t xm_hash_uuid4(lua_State *lua);
 tb_int_t xm_hash_sha(lua_State *lua);
 tb_int_t xm_hash_md5(lua_State *lua);
 tb_int_t xm_hash_xxhash(lua_State *lua);
+tb_int_t xm_hash_xxhash_cppfile(lua_State *lua);
+tb_int_t xm_hash_files(lua_State *lua);
 tb_int_t xm_hash_rand32(lua_State *lua);
 tb_int_t xm_hash_rand64(lua_State *lua);
 tb_int_t xm_hash_rand128(lua_State *lua);
@@ -245,6 +250,8 @@ tb_int_t xm_lz4_compress(lua_State *lua);
 tb_int_t xm_lz4_decompress(lua_State *lua);
 tb_int_t xm_lz4_block_compress(lua_State *lua);
 tb_int_t xm_lz4_block_decompress(lua_State *lua);
+tb_int_t xm_lz4_block_compress_batch(lua_State *lua);
+tb_int_t xm_lz4_block_decompress_batch(lua_State *lua);
 tb_int_t xm_lz4_compress_file(lua_State *lua);
 tb_int_t xm_lz4_decompress_file(lua_State *lua);
 tb_int_t xm_lz4_compress_stream_open(lua_State *lua);
@@ -265,6 +272,8 @@ tb_int_t xm_bloom_filter_size(lua_State *lua);
 tb_int_t xm_bloom_filter_get(lua_State *lua);
 tb_int_t xm_bloom_filter_set(lua_State *lua);
 tb_int_t xm_bloom_filter_data_set(lua_State *lua);
+tb_int_t xm_bloom_filter_delta(lua_State *lua);
+tb_int_t xm_bloom_filter_merge(lua_State *lua);
 
 // the windows functions
 #ifdef TB_CONFIG_OS_WINDOWS
@@ -318,6 +327,7 @@ tb_int_t xm_fwatcher_open(lua_State *lua);
 tb_int_t xm_fwatcher_add(lua_State *lua);
 tb_int_t xm_fwatcher_remove(lua_State *lua);
 tb_int_t xm_fwatcher_wait(lua_State *lua);
+tb_int_t xm_fwatcher_wait_events(lua_State *lua);
 tb_int_t xm_fwatcher_close(lua_State *lua);
 
 // the sandbox functions
@@ -365,6 +375,7 @@ tb_int_t xm_binutils_deplibs(lua_State *lua);
 tb_int_t xm_binutils_rpath_list(lua_State *lua);
 tb_int_t xm_binutils_rpath_clean(lua_State *lua);
 tb_int_t xm_binutils_extractlib(lua_State *lua);
+tb_int_t xm_binutils_armembers(lua_State *lua);
 tb_int_t xm_binutils_format(lua_State *lua);
 
 #ifdef XM_CONFIG_API_HAVE_CURSES
@@ -378,6 +389,8 @@ tb_int_t xm_thread_exit(lua_State *lua);
 tb_int_t xm_thread_wait(lua_State *lua);
 tb_int_t xm_thread_suspend(lua_State *lua);
 tb_int_t xm_thread_resume(lua_State *lua);
+tb_int_t xm_thread_engine_pool_prewarm(lua_State *lua);
+tb_int_t xm_thread_engine_pool_stats(lua_State *lua);
 
 // the thread/mutex functions
 tb_int_t xm_thread_mutex_init(lua_State *lua);
@@ -439,6 +452,7 @@ static luaL_Reg const g_os_functions[] = {
     { "cpdir", xm_os_cpdir },
     { "chdir", xm_os_chdir },
     { "mtime", xm_os_mtime },
+    { "stats", xm_os_stats },
     { "sleep", xm_os_sleep },
     { "mclock", xm_os_mclock },
     { "curdir", xm_os_curdir },
@@ -457,6 +471,7 @@ static luaL_Reg const g_os_functions[] = {
     { "getenvs", xm_os_getenvs },
     { "cpuinfo", xm_os_cpuinfo },
     { "meminfo", xm_os_meminfo },
+    { "memstats", xm_os_memstats },
     { "readlink", xm_os_readlink },
     { "emptydir", xm_os_emptydir },
     { "strerror", xm_os_strerror },
@@ -560,6 +575,8 @@ static luaL_Reg const g_hash_functions[] = {
     { "sha", xm_hash_sha },
     { "md5", xm_hash_md5 },
     { "xxhash", xm_hash_xxhash },
+    { "xxhash_cppfile", xm_hash_xxhash_cppfile },
+    { "files", xm_hash_files },
     { "rand32", xm_hash_rand32 },
     { "rand64", xm_hash_rand64 },
     { "rand128", xm_hash_rand128 },
@@ -579,6 +596,8 @@ static luaL_Reg const g_lz4_functions[] = {
     { "decompress", xm_lz4_decompress },
     { "block_compress", xm_lz4_block_compress },
     { "block_decompress", xm_lz4_block_decompress },
+    { "block_compress_batch", xm_lz4_block_compress_batch },
+    { "block_decompress_batch", xm_lz4_block_decompress_batch },
     { "compress_file", xm_lz4_compress_file },
     { "decompress_file", xm_lz4_decompress_file },
     { "compress_stream_open", xm_lz4_compress_stream_open },
@@ -602,6 +621,8 @@ static luaL_Reg const g_bloom_filter_functions[] = {
     { "get", xm_bloom_filter_get },
     { "set", xm_bloom_filter_set },
     { "data_set", xm_bloom_filter_data_set },
+    { "delta", xm_bloom_filter_delta },
+    { "merge", xm_bloom_filter_merge },
     { tb_null, tb_null },
 };
 
@@ -652,6 +673,7 @@ static luaL_Reg const g_fwatcher_functions[] = {
     { "add", xm_fwatcher_add },
     { "remove", xm_fwatcher_remove },
     { "wait", xm_fwatcher_wait },
+    { "wait_events", xm_fwatcher_wait_events },
     { "close", xm_fwatcher_close },
     { tb_null, tb_null },
 };
@@ -720,6 +742,7 @@ static luaL_Reg const g_binutils_functions[] = {
     { "rpath_list", xm_binutils_rpath_list },
     { "rpath_clean", xm_binutils_rpath_clean },
     { "extractlib", xm_binutils_extractlib },
+    { "armembers", xm_binutils_armembers },
     { "format", xm_binutils_format },
     { tb_null, tb_null },
 };
@@ -731,6 +754,8 @@ static luaL_Reg const g_thread_functions[] = {
     { "thread_wait", xm_thread_wait },
     { "thread_resume", xm_thread_resume },
     { "thread_suspend", xm_thread_suspend },
+    { "engine_pool_prewarm", xm_thread_engine_pool_prewarm },
+    { "engine_pool_stats", xm_thread_engine_pool_stats },
     { "mutex_init", xm_thread_mutex_init },
     { "mutex_exit", xm_thread_mutex_exit },
     { "mutex_lock", xm_thread_mutex_lock },
@@ -1359,28 +1384,137 @@ static tb_void_t xm_engine_init_signal(xm_engine_t *engine) {
 #endif
 }
 
-#if XM_HOOK_LUA_MEMALLOC
-// udata is unused, it has been used by engine. see xm_engine_bind_to_lua()
-static tb_pointer_t xm_engine_lua_realloc(tb_pointer_t udata, tb_pointer_t data, size_t osize, size_t nsize) {
-    tb_pointer_t ptr = tb_null;
-    if (nsize == 0 && data) {
-        tb_free(data);
-    } else if (!data) {
-        ptr = tb_malloc((tb_size_t)nsize);
-    } else if (nsize != osize) {
-        ptr = tb_ralloc(data, (tb_size_t)nsize);
-    } else {
-        ptr = data;
-    }
-    return ptr;
+#ifndef USE_LUAJIT
+static tb_int_t xm_engine_lua_panic(lua_State *lua) {
+    tb_char_t const *msg = lua_tostring(lua, -1);
+    tb_printf("PANIC: unprotected error in call to Lua API (%s)\n", msg ? msg : "error object is not a string");
+    return 0;
 }
 #endif
 
 #ifdef XM_EMBED_ENABLE
+static tb_hize_t xm_engine_xmz_get_u64_be(tb_byte_t const *p) {
+    return ((tb_hize_t)tb_bits_get_u32_be(p) << 32) | (tb_hize_t)tb_bits_get_u32_be(p + 4);
+}
+
+/* extract the xmz v2 archive, @see xmake/modules/utils/archive/archive_xmz.lua
+ *
+ * header:  "XMZ2" [u32 blocksize]
+ * blocks:  [lz4 block] [lz4 block] ...
+ * index:   [lz4 block]
+ * trailer: [u64 index offset] [u32 index compressed size] [u32 index size] "XMZ2"
+ */
+static tb_bool_t xm_engine_extract_programfiles_v2(xm_engine_t *engine,
+                                                   tb_char_t const *programdir,
+                                                   tb_byte_t const *data,
+                                                   tb_size_t size) {
+    tb_bool_t  ok        = tb_false;
+    tb_byte_t *index     = tb_null;
+    tb_byte_t *filesdata = tb_null;
+    do {
+        // get index
+        tb_assert_and_check_break(size >= 28 && !tb_strncmp((tb_char_t const *)data + size - 4, "XMZ2", 4));
+        tb_byte_t const *trailer      = data + size - 20;
+        tb_hize_t        index_offset = xm_engine_xmz_get_u64_be(trailer);
+        tb_int_t         index_csize  = (tb_int_t)tb_bits_get_u32_be(trailer + 8);
+        tb_int_t         index_size   = (tb_int_t)tb_bits_get_u32_be(trailer + 12);
+        tb_assert_and_check_break(index_offset + index_csize <= size - 20 && index_size > 8);
+
+        index = (tb_byte_t *)tb_malloc_bytes(index_size);
+        tb_assert_and_check_break(index);
+        tb_int_t real = LZ4_decompress_safe((tb_char_t const *)data + index_offset, (tb_char_t *)index, index_csize,
+                                            index_size);
+        tb_assert_and_check_break(real == index_size);
+
+        // decompress all blocks
+        tb_byte_t const *p           = index;
+        tb_byte_t const *e           = index + index_size;
+        tb_size_t        blockcount  = (tb_size_t)tb_bits_get_u32_be(p);
+        tb_size_t        blockoffset = 8;
+        tb_hize_t        filessize   = 0;
+        p += 4;
+        tb_assert_and_check_break(p + blockcount * 8 <= e);
+        for (tb_size_t i = 0; i < blockcount; i++) {
+            filessize += tb_bits_get_u32_be(p + i * 8 + 4);
+        }
+        if (filessize) {
+            filesdata = (tb_byte_t *)tb_malloc_bytes((tb_size_t)filessize);
+            tb_assert_and_check_break(filesdata);
+        }
+        tb_size_t filesoffset = 0;
+        tb_bool_t failed      = tb_false;
+        for (tb_size_t i = 0; i < blockcount; i++, p += 8) {
+            tb_int_t csize = (tb_int_t)tb_bits_get_u32_be(p);
+            tb_int_t dsize = (tb_int_t)tb_bits_get_u32_be(p + 4);
+            if (blockoffset + csize > index_offset ||
+                LZ4_decompress_safe((tb_char_t const *)data + blockoffset, (tb_char_t *)filesdata + filesoffset, csize,
+                                    dsize) != dsize) {
+                failed = tb_true;
+                break;
+            }
+            blockoffset += csize;
+            filesoffset += dsize;
+        }
+        tb_assert_and_check_break(!failed && p + 4 <= e);
+
+        // extract files to programdir
+        tb_char_t filepath[TB_PATH_MAXN];
+        tb_long_t pos       = tb_snprintf(filepath, sizeof(filepath), "%s/", programdir);
+        tb_size_t filecount = (tb_size_t)tb_bits_get_u32_be(p);
+        p += 4;
+        for (tb_size_t i = 0; i < filecount; i++) {
+            // get filepath
+            tb_check_break_state(p + 2 <= e, failed, tb_true);
+            tb_size_t n = (tb_size_t)tb_bits_get_u16_be(p);
+            p += 2;
+            tb_check_break_state(p + n + 24 <= e && pos + n + 1 < sizeof(filepath), failed, tb_true);
+            tb_strncpy(filepath + pos, (tb_char_t const *)p, n);
+            filepath[pos + n] = '\0';
+            p += n;
+
+            // get file size and offset, we need not verify checksum for the embedded files
+            tb_hize_t filesize   = xm_engine_xmz_get_u64_be(p);
+            tb_hize_t fileoffset = xm_engine_xmz_get_u64_be(p + 8);
+            p += 24;
+            tb_check_break_state(fileoffset + filesize <= filessize, failed, tb_true);
+
+            // write file
+            tb_trace_d("extracting %s, %llu bytes ..", filepath, filesize);
+            tb_stream_ref_t stream = tb_stream_init_from_file(filepath,
+                                                              TB_FILE_MODE_RW | TB_FILE_MODE_CREAT |
+                                                                  TB_FILE_MODE_TRUNC);
+            tb_check_break_state(stream, failed, tb_true);
+            if (tb_stream_open(stream) && filesize) {
+                tb_stream_bwrit(stream, filesdata + fileoffset, (tb_size_t)filesize);
+            }
+            tb_stream_exit(stream);
+        }
+        tb_check_break(!failed);
+
+        ok = tb_true;
+    } while (0);
+
+    if (!ok) {
+        tb_trace_e("extract program files failed");
+    }
+    if (filesdata) {
+        tb_free(filesdata);
+    }
+    if (index) {
+        tb_free(index);
+    }
+    return ok;
+}
+
 static tb_bool_t xm_engine_extract_programfiles_impl(xm_engine_t *engine,
                                                      tb_char_t const *programdir,
                                                      tb_byte_t const *data,
                                                      tb_size_t size) {
+    // is xmz v2 archive?
+    if (size >= 4 && !tb_strncmp((tb_char_t const *)data, "XMZ2", 4)) {
+        return xm_engine_extract_programfiles_v2(engine, programdir, data, size);
+    }
+
     // do decompress
     tb_bool_t ok = tb_false;
     LZ4F_errorCode_t code;
@@ -1559,6 +1693,53 @@ static tb_bool_t xm_engine_load_main_script(xm_engine_t *engine, tb_char_t const
 #endif
 }
 
+// save arguments, get the program directory and load the main script, but do not call _xmake_main()
+static tb_bool_t xm_engine_load_main(xm_engine_t *engine, tb_int_t argc, tb_char_t **argv, tb_char_t **taskargv) {
+    // save main arguments to the global variable: _ARGV
+    if (!xm_engine_save_arguments(engine, argc, argv, taskargv)) {
+        return tb_false;
+    }
+
+    // get the project directory
+    tb_char_t path[TB_PATH_MAXN] = { 0 };
+    if (!xm_engine_get_project_directory(engine, path, sizeof(path))) {
+        return tb_false;
+    }
+
+    // get the program file
+    if (!xm_engine_get_program_file(engine, argv, path, sizeof(path))) {
+        return tb_false;
+    }
+
+    // get the program directory
+    if (!xm_engine_get_program_directory(engine, path, sizeof(path), path)) {
+        return tb_false;
+    }
+
+#ifdef XM_EMBED_ENABLE
+    if (!xm_engine_extract_programfiles(engine, path)) {
+        return tb_false;
+    }
+#endif
+
+    // append the main script path
+    tb_strcat(path, "/core/_xmake_main.lua");
+
+    // exists this script?
+    if (!tb_file_info(path, tb_null)) {
+        tb_printf("not found main script: %s\n", path);
+        return tb_false;
+    }
+
+    tb_trace_d("main: %s", path);
+
+    // load and execute the main script
+    if (!xm_engine_load_main_script(engine, path)) {
+        return tb_false;
+    }
+    return tb_true;
+}
+
 /* //////////////////////////////////////////////////////////////////////////////////////
  * implementation
  */
@@ -1573,11 +1754,22 @@ xm_engine_ref_t xm_engine_init(tb_char_t const *name, xm_engine_lni_initalizer_c
         // init name
         tb_strlcpy(engine->name, name, sizeof(engine->name));
 
-        // init lua
-#if XM_HOOK_LUA_MEMALLOC
-        engine->lua = lua_newstate(xm_engine_lua_realloc, tb_null);
-#else
+        /* init lua
+         *
+         * luajit only supports its own allocator on 64-bit targets, so we use the custom allocator for lua only.
+         * we can use the size class arena allocator by XMAKE_LUA_ALLOCATOR=arena
+         */
+#ifdef USE_LUAJIT
         engine->lua = luaL_newstate();
+#else
+        engine->alloc = xm_engine_alloc_init_from_env();
+        tb_assert_and_check_break(engine->alloc);
+
+        engine->lua = lua_newstate(xm_engine_alloc_realloc, (tb_pointer_t)engine->alloc);
+        tb_assert_and_check_break(engine->lua);
+
+        // luaL_newstate() also sets the panic function, we need to do it ourselves
+        lua_atpanic(engine->lua, xm_engine_lua_panic);
 #endif
         tb_assert_and_check_break(engine->lua);
 
@@ -1780,6 +1972,12 @@ tb_void_t xm_engine_exit(xm_engine_ref_t self) {
     }
     engine->lua = tb_null;
 
+    // exit lua allocator, all blocks have been freed by lua_close()
+    if (engine->alloc) {
+        xm_engine_alloc_exit(engine->alloc);
+    }
+    engine->alloc = tb_null;
+
     // exit poller
     if (engine->poller) {
         tb_poller_exit(engine->poller);
@@ -1800,46 +1998,8 @@ tb_int_t xm_engine_main(xm_engine_ref_t self, tb_int_t argc, tb_char_t **argv, t
     }
 #endif
 
-    // save main arguments to the global variable: _ARGV
-    if (!xm_engine_save_arguments(engine, argc, argv, taskargv)) {
-        return -1;
-    }
-
-    // get the project directory
-    tb_char_t path[TB_PATH_MAXN] = { 0 };
-    if (!xm_engine_get_project_directory(engine, path, sizeof(path))) {
-        return -1;
-    }
-
-    // get the program file
-    if (!xm_engine_get_program_file(engine, argv, path, sizeof(path))) {
-        return -1;
-    }
-
-    // get the program directory
-    if (!xm_engine_get_program_directory(engine, path, sizeof(path), path)) {
-        return -1;
-    }
-
-#ifdef XM_EMBED_ENABLE
-    if (!xm_engine_extract_programfiles(engine, path)) {
-        return -1;
-    }
-#endif
-
-    // append the main script path
-    tb_strcat(path, "/core/_xmake_main.lua");
-
-    // exists this script?
-    if (!tb_file_info(path, tb_null)) {
-        tb_printf("not found main script: %s\n", path);
-        return -1;
-    }
-
-    tb_trace_d("main: %s", path);
-
     // load and execute the main script
-    if (!xm_engine_load_main_script(engine, path)) {
+    if (!xm_engine_load_main(engine, argc, argv, taskargv)) {
         return -1;
     }
 
@@ -1857,6 +2017,38 @@ tb_int_t xm_engine_main(xm_engine_ref_t self, tb_int_t argc, tb_char_t **argv, t
     // get the error code
     return (tb_int_t)lua_tonumber(engine->lua, -1);
 }
+tb_bool_t xm_engine_preload(xm_engine_ref_t self, tb_char_t const **modules) {
+    xm_engine_t *engine = (xm_engine_t *)self;
+    tb_assert_and_check_return_val(engine && engine->lua, tb_false);
+
+    /* mark it as a thread engine, because all preloaded engines will be used by threads,
+     * the modules may check xmake.in_main_thread() when loading them.
+     *
+     * it will be overridden by the real thread callback when running thread.
+     */
+    lua_pushliteral(engine->lua, "");
+    lua_setglobal(engine->lua, "_THREAD_CALLBACK");
+
+    // load the main script, it will load all core modules required by main.lua
+    tb_char_t *argv[] = { engine->name, tb_null };
+    if (!xm_engine_load_main(engine, 1, argv, tb_null)) {
+        return tb_false;
+    }
+
+    // load the given modules, e.g. "sandbox/sandbox", "base/json"
+    if (modules) {
+        while (*modules) {
+            lua_getglobal(engine->lua, "require");
+            lua_pushstring(engine->lua, *modules);
+            if (lua_pcall(engine->lua, 1, 0, 0)) {
+                tb_trace_e("preload %s failed: %s", *modules, lua_tostring(engine->lua, -1));
+                lua_pop(engine->lua, 1);
+            }
+            modules++;
+        }
+    }
+    return tb_true;
+}
 tb_void_t xm_engine_register(xm_engine_ref_t self, tb_char_t const *module, luaL_Reg const funcs[]) {
     xm_engine_t *engine = (xm_engine_t *)self;
     tb_assert_and_check_return(engine && engine->lua && module && funcs);
@@ -73,6 +73,18 @@ tb_void_t xm_engine_exit(xm_engine_ref_t engine);
  */
 tb_int_t xm_engine_main(xm_engine_ref_t engine, tb_int_t argc, tb_char_t **argv, tb_char_t **taskargv);
 
+/*! preload the engine for the thread engine pool
+ *
+ * it only loads the main script and the given modules, and we will run the main entry with it later,
+ * so the new thread need not load all core modules again.
+ *
+ * @param engine            the engine
+ * @param modules           the null-terminated module names to be required, e.g. {"sandbox/sandbox", tb_null}
+ *
+ * @return                  tb_true or tb_false
+ */
+tb_bool_t xm_engine_preload(xm_engine_ref_t engine, tb_char_t const **modules);
+
 /*! register lni modules in the engine, @note we need to call it in lni_initalizer()
  *
  * @param engine            the engine
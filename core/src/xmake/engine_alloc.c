@@ -0,0 +1,250 @@
+/*!A cross-platform build utility based on Lua
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Copyright (C) 2015-present, Xmake Open Source Community.
+ *
+ * @author      ruki
+ * @file        engine_alloc.c
+ *
+ */
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * trace
+ */
+#define TB_TRACE_MODULE_NAME "engine_alloc"
+#define TB_TRACE_MODULE_DEBUG (0)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "engine_alloc.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// the max size of the small blocks
+#define XM_ENGINE_ALLOC_SMALL_MAXN (XM_ENGINE_ALLOC_CLASS_STEP * XM_ENGINE_ALLOC_CLASS_MAXN)
+
+// the arena chunk size
+#define XM_ENGINE_ALLOC_CHUNK_SIZE (64 * 1024)
+
+// the arena chunk header size, we keep the blocks aligned by the class step
+#define XM_ENGINE_ALLOC_CHUNK_HEAD (XM_ENGINE_ALLOC_CLASS_STEP)
+
+// get the size class index of the given small block size
+#define xm_engine_alloc_class(size) (((size) - 1) / XM_ENGINE_ALLOC_CLASS_STEP)
+
+// get the block size of the given size class
+#define xm_engine_alloc_class_size(index) (((index) + 1) * XM_ENGINE_ALLOC_CLASS_STEP)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+// the free block type
+typedef struct __xm_engine_alloc_block_t {
+    struct __xm_engine_alloc_block_t *next;
+} xm_engine_alloc_block_t;
+
+// the arena chunk type
+typedef struct __xm_engine_alloc_chunk_t {
+    struct __xm_engine_alloc_chunk_t *next;
+} xm_engine_alloc_chunk_t;
+
+/* the lua allocator type
+ *
+ * each engine has its own lua state and allocator, and a lua state is only used by one thread at the same time,
+ * so we need not any lock here.
+ *
+ * lua always passes the real block size as osize when resizing or freeing a block,
+ * so we can find the size class from it and the small blocks need not any header.
+ */
+typedef struct __xm_engine_alloc_t {
+    // the allocator kind
+    tb_size_t kind;
+
+    // the free lists of the size classes
+    xm_engine_alloc_block_t *freelists[XM_ENGINE_ALLOC_CLASS_MAXN];
+
+    // the arena chunks
+    xm_engine_alloc_chunk_t *chunks;
+
+    // the unused space of the current chunk
+    tb_byte_t *chunk_head;
+    tb_byte_t *chunk_tail;
+
+    // the stats
+    xm_engine_alloc_stats_t stats;
+
+} xm_engine_alloc_t;
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * private implementation
+ */
+static tb_pointer_t xm_engine_alloc_arena_malloc(xm_engine_alloc_t *alloc, tb_size_t size) {
+    if (size > XM_ENGINE_ALLOC_SMALL_MAXN) {
+        return tb_malloc(size);
+    }
+
+    // reuse the free block of this size class
+    tb_size_t index = xm_engine_alloc_class(size);
+    xm_engine_alloc_block_t *block = alloc->freelists[index];
+    if (block) {
+        alloc->freelists[index] = block->next;
+        return (tb_pointer_t)block;
+    }
+
+    // carve it from the current chunk, the rest space of the full chunk will be discarded
+    tb_size_t blocksize = xm_engine_alloc_class_size(index);
+    if (alloc->chunk_head + blocksize > alloc->chunk_tail) {
+        xm_engine_alloc_chunk_t *chunk = (xm_engine_alloc_chunk_t *)tb_malloc(XM_ENGINE_ALLOC_CHUNK_SIZE);
+        tb_check_return_val(chunk, tb_null);
+
+        chunk->next = alloc->chunks;
+        alloc->chunks = chunk;
+        alloc->chunk_head = (tb_byte_t *)chunk + XM_ENGINE_ALLOC_CHUNK_HEAD;
+        alloc->chunk_tail = (tb_byte_t *)chunk + XM_ENGINE_ALLOC_CHUNK_SIZE;
+        alloc->stats.arena += XM_ENGINE_ALLOC_CHUNK_SIZE;
+    }
+    block = (xm_engine_alloc_block_t *)alloc->chunk_head;
+    alloc->chunk_head += blocksize;
+    return (tb_pointer_t)block;
+}
+static tb_void_t xm_engine_alloc_arena_free(xm_engine_alloc_t *alloc, tb_pointer_t data, tb_size_t size) {
+    if (size > XM_ENGINE_ALLOC_SMALL_MAXN) {
+        tb_free(data);
+        return;
+    }
+    tb_size_t index = xm_engine_alloc_class(size);
+    xm_engine_alloc_block_t *block = (xm_engine_alloc_block_t *)data;
+    block->next = alloc->freelists[index];
+    alloc->freelists[index] = block;
+}
+static tb_pointer_t xm_engine_alloc_arena_ralloc(xm_engine_alloc_t *alloc, tb_pointer_t data, tb_size_t osize, tb_size_t nsize) {
+    // both are the large blocks?
+    if (osize > XM_ENGINE_ALLOC_SMALL_MAXN && nsize > XM_ENGINE_ALLOC_SMALL_MAXN) {
+        return tb_ralloc(data, nsize);
+    }
+
+    // it's still in the same size class?
+    if (osize <= XM_ENGINE_ALLOC_SMALL_MAXN && nsize <= XM_ENGINE_ALLOC_SMALL_MAXN &&
+        xm_engine_alloc_class(osize) == xm_engine_alloc_class(nsize)) {
+        return data;
+    }
+
+    // move it to the new block
+    tb_pointer_t ptr = xm_engine_alloc_arena_malloc(alloc, nsize);
+    tb_check_return_val(ptr, tb_null);
+
+    tb_memcpy(ptr, data, tb_min(osize, nsize));
+    xm_engine_alloc_arena_free(alloc, data, osize);
+    return ptr;
+}
+static tb_void_t xm_engine_alloc_stats_malloc(xm_engine_alloc_t *alloc, tb_size_t size) {
+    xm_engine_alloc_stats_t *stats = &alloc->stats;
+    stats->allocs++;
+    if (size > XM_ENGINE_ALLOC_SMALL_MAXN) {
+        stats->large++;
+    } else {
+        stats->classes[xm_engine_alloc_class(size)]++;
+    }
+}
+static tb_void_t xm_engine_alloc_stats_update(xm_engine_alloc_t *alloc, tb_size_t osize, tb_size_t nsize) {
+    xm_engine_alloc_stats_t *stats = &alloc->stats;
+    stats->live = stats->live + nsize - osize;
+    if (stats->live > stats->peak) {
+        stats->peak = stats->live;
+    }
+}
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */
+xm_engine_alloc_ref_t xm_engine_alloc_init(tb_size_t kind) {
+    xm_engine_alloc_t *alloc = tb_malloc0_type(xm_engine_alloc_t);
+    tb_assert_and_check_return_val(alloc, tb_null);
+
+    alloc->kind = kind;
+    alloc->stats.kind = kind;
+    return (xm_engine_alloc_ref_t)alloc;
+}
+xm_engine_alloc_ref_t xm_engine_alloc_init_from_env(tb_void_t) {
+    tb_size_t kind = XM_ENGINE_ALLOC_KIND_DEFAULT;
+    tb_char_t data[64] = { 0 };
+    if (tb_environment_first("XMAKE_LUA_ALLOCATOR", data, sizeof(data)) && !tb_strcmp(data, "arena")) {
+        kind = XM_ENGINE_ALLOC_KIND_ARENA;
+    }
+    return xm_engine_alloc_init(kind);
+}
+tb_void_t xm_engine_alloc_exit(xm_engine_alloc_ref_t self) {
+    xm_engine_alloc_t *alloc = (xm_engine_alloc_t *)self;
+    tb_assert_and_check_return(alloc);
+
+    // free all chunks, all blocks have been freed by lua_close()
+    xm_engine_alloc_chunk_t *chunk = alloc->chunks;
+    while (chunk) {
+        xm_engine_alloc_chunk_t *next = chunk->next;
+        tb_free(chunk);
+        chunk = next;
+    }
+    alloc->chunks = tb_null;
+    tb_free(alloc);
+}
+tb_pointer_t xm_engine_alloc_realloc(tb_pointer_t udata, tb_pointer_t data, size_t osize, size_t nsize) {
+    xm_engine_alloc_t *alloc = (xm_engine_alloc_t *)udata;
+    tb_bool_t arena = alloc->kind == XM_ENGINE_ALLOC_KIND_ARENA;
+
+    // free it
+    if (nsize == 0) {
+        if (data) {
+            if (arena) {
+                xm_engine_alloc_arena_free(alloc, data, (tb_size_t)osize);
+            } else {
+                tb_free(data);
+            }
+            alloc->stats.frees++;
+            xm_engine_alloc_stats_update(alloc, (tb_size_t)osize, 0);
+        }
+        return tb_null;
+    }
+
+    // malloc it, osize is the lua object type if data is null
+    tb_pointer_t ptr = tb_null;
+    if (!data) {
+        ptr = arena ? xm_engine_alloc_arena_malloc(alloc, (tb_size_t)nsize) : tb_malloc((tb_size_t)nsize);
+        if (ptr) {
+            xm_engine_alloc_stats_malloc(alloc, (tb_size_t)nsize);
+            xm_engine_alloc_stats_update(alloc, 0, (tb_size_t)nsize);
+        }
+        return ptr;
+    }
+
+    // resize it
+    if (nsize == osize) {
+        return data;
+    }
+    ptr = arena ? xm_engine_alloc_arena_ralloc(alloc, data, (tb_size_t)osize, (tb_size_t)nsize)
+                : tb_ralloc(data, (tb_size_t)nsize);
+    if (ptr) {
+        xm_engine_alloc_stats_update(alloc, (tb_size_t)osize, (tb_size_t)nsize);
+    }
+    return ptr;
+}
+tb_void_t xm_engine_alloc_stats(xm_engine_alloc_ref_t self, xm_engine_alloc_stats_t *stats) {
+    xm_engine_alloc_t *alloc = (xm_engine_alloc_t *)self;
+    tb_assert_and_check_return(alloc && stats);
+
+    *stats = alloc->stats;
+}
@@ -0,0 +1,135 @@
+/*!A cross-platform build utility based on Lua
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Copyright (C) 2015-present, Xmake Open Source Community.
+ *
+ * @author      ruki
+ * @file        engine_alloc.h
+ *
+ */
+#ifndef XM_ENGINE_ALLOC_H
+#define XM_ENGINE_ALLOC_H
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "prefix.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// the size class step of the small blocks
+#define XM_ENGINE_ALLOC_CLASS_STEP (16)
+
+// the size class count of the small blocks, the blocks larger than 512 bytes are allocated from tbox directly
+#define XM_ENGINE_ALLOC_CLASS_MAXN (32)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * extern
+ */
+__tb_extern_c_enter__
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+/// the lua allocator type
+typedef struct {
+    tb_int_t dummy;
+} const *xm_engine_alloc_ref_t;
+
+/// the lua allocator kind
+typedef enum __xm_engine_alloc_kind_e {
+    XM_ENGINE_ALLOC_KIND_DEFAULT = 0, //!< forward all blocks to the tbox allocator
+    XM_ENGINE_ALLOC_KIND_ARENA   = 1  //!< allocate the small blocks from the size class arena
+
+} xm_engine_alloc_kind_e;
+
+/// the lua allocator stats type
+typedef struct __xm_engine_alloc_stats_t {
+    // the allocator kind
+    tb_size_t kind;
+
+    // the live bytes
+    tb_size_t live;
+
+    // the peak of the live bytes
+    tb_size_t peak;
+
+    // the count of the allocations
+    tb_size_t allocs;
+
+    // the count of the deallocations
+    tb_size_t frees;
+
+    // the count of the allocations which are larger than the max size class
+    tb_size_t large;
+
+    // the bytes of the arena chunks
+    tb_size_t arena;
+
+    // the count of the allocations for each size class
+    tb_size_t classes[XM_ENGINE_ALLOC_CLASS_MAXN];
+
+} xm_engine_alloc_stats_t;
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * interfaces
+ */
+
+/*! init the lua allocator
+ *
+ * @param kind              the allocator kind
+ *
+ * @return                  the allocator
+ */
+xm_engine_alloc_ref_t xm_engine_alloc_init(tb_size_t kind);
+
+/*! init the lua allocator from the environment variable, e.g. XMAKE_LUA_ALLOCATOR=arena
+ *
+ * @return                  the allocator
+ */
+xm_engine_alloc_ref_t xm_engine_alloc_init_from_env(tb_void_t);
+
+/*! exit the lua allocator, @note we need to call it after lua_close()
+ *
+ * @param alloc             the allocator
+ */
+tb_void_t xm_engine_alloc_exit(xm_engine_alloc_ref_t alloc);
+
+/*! the lua allocator function, we can pass it to lua_newstate() with the allocator as udata
+ *
+ * @param udata             the allocator
+ * @param data              the block data
+ * @param osize             the old block size
+ * @param nsize             the new block size
+ *
+ * @return                  the new block data
+ */
+tb_pointer_t xm_engine_alloc_realloc(tb_pointer_t udata, tb_pointer_t data, size_t osize, size_t nsize);
+
+/*! get the lua allocator stats
+ *
+ * @param alloc             the allocator
+ * @param stats             the stats
+ */
+tb_void_t xm_engine_alloc_stats(xm_engine_alloc_ref_t alloc, xm_engine_alloc_stats_t *stats);
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * extern
+ */
+__tb_extern_c_leave__
+
+#endif
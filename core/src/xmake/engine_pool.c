@@ -39,20 +39,44 @@
 // the max engine pool count
 #define XM_ENGINE_POOL_MAXN (128)
 
+// the engine name of the prewarmed engines, it should be same as the thread engine name
+#define XM_ENGINE_POOL_ENGINE_NAME "xmake"
+
 // the singleton type of engine pool
 #define XM_ENGINE_POOL (TB_SINGLETON_TYPE_USER + 4)
 
 /* //////////////////////////////////////////////////////////////////////////////////////
- * globals
+ * types
  */
 
-/* the engine pool lock
- *
- * the pool is a singleton shared by all worker threads, which may alloc/free engines
- * concurrently (e.g. parallel batchcmds:lua/vlua jobs run in native threads), so we must
- * protect the underlying list against data races, otherwise it will be corrupted and crash.
- */
-static tb_spinlock_t g_engine_pool_lock = TB_SPINLOCK_INIT;
+// the engine pool type
+typedef struct __xm_engine_pool_t {
+    /* the idle engine slots
+     *
+     * the pool is a singleton shared by all worker threads, which may alloc/free engines
+     * concurrently (e.g. parallel batchcmds:lua/vlua jobs run in native threads).
+     *
+     * each slot holds an idle engine or null, we claim an engine by exchanging the slot with null,
+     * and give it back by CAS(null -> engine), so it's lock-free and has no ABA problem.
+     */
+    tb_atomic_t slots[XM_ENGINE_POOL_MAXN];
+
+    // the stats
+    tb_atomic_t hits;
+    tb_atomic_t misses;
+    tb_atomic_t drops;
+    tb_atomic_t prewarmed;
+
+    // the prewarm thread
+    tb_thread_ref_t prewarm_thread;
+    tb_atomic_t prewarm_count;
+    tb_atomic_t prewarm_started;
+    tb_atomic_t stopped;
+
+    // the preloaded modules, it's null-terminated
+    tb_char_t *modules[XM_ENGINE_POOL_MODULES_MAXN + 1];
+
+} xm_engine_pool_t;
 
 /* //////////////////////////////////////////////////////////////////////////////////////
  * private implementation
@@ -70,6 +94,48 @@ static tb_void_t xm_engine_pool_instance_exit(tb_handle_t engine_pool, tb_cpoint
     }
 }
 
+static xm_engine_ref_t xm_engine_pool_pop(xm_engine_pool_t *pool) {
+    tb_size_t i;
+    for (i = 0; i < XM_ENGINE_POOL_MAXN; i++) {
+        if (tb_atomic_get(&pool->slots[i])) {
+            xm_engine_ref_t engine = (xm_engine_ref_t)tb_atomic_fetch_and_set(&pool->slots[i], 0);
+            if (engine) {
+                return engine;
+            }
+        }
+    }
+    return tb_null;
+}
+
+static tb_bool_t xm_engine_pool_push(xm_engine_pool_t *pool, xm_engine_ref_t engine) {
+    tb_size_t i;
+    for (i = 0; i < XM_ENGINE_POOL_MAXN; i++) {
+        tb_long_t expected = 0;
+        if (!tb_atomic_get(&pool->slots[i]) &&
+            tb_atomic_compare_and_swap(&pool->slots[i], &expected, (tb_long_t)engine)) {
+            return tb_true;
+        }
+    }
+    return tb_false;
+}
+
+static tb_int_t xm_engine_pool_prewarm_func(tb_cpointer_t priv) {
+    xm_engine_pool_t *pool = (xm_engine_pool_t *)priv;
+    tb_assert_and_check_return_val(pool, -1);
+
+    while (!tb_atomic_get(&pool->stopped) && tb_atomic_fetch_and_sub(&pool->prewarm_count, 1) > 0) {
+        xm_engine_ref_t engine = xm_engine_init(XM_ENGINE_POOL_ENGINE_NAME, tb_null);
+        tb_assert_and_check_break(engine);
+
+        if (!xm_engine_preload(engine, (tb_char_t const **)pool->modules) || !xm_engine_pool_push(pool, engine)) {
+            xm_engine_exit(engine);
+            break;
+        }
+        tb_atomic_fetch_and_add(&pool->prewarmed, 1);
+    }
+    return 0;
+}
+
 /* //////////////////////////////////////////////////////////////////////////////////////
  * implementation
  */
@@ -79,38 +145,95 @@ xm_engine_pool_ref_t xm_engine_pool() {
 }
 
 xm_engine_pool_ref_t xm_engine_pool_init() {
-    return tb_single_list_init(0, tb_element_ptr(tb_null, tb_null));
+    return (xm_engine_pool_ref_t)tb_malloc0_type(xm_engine_pool_t);
 }
 
-tb_void_t xm_engine_pool_exit(xm_engine_pool_ref_t engine_pool) {
-    if (engine_pool) {
-        tb_for_all(xm_engine_ref_t, engine, engine_pool) {
-            if (engine) {
-                xm_engine_exit(engine);
-            }
-        }
-        tb_single_list_exit(engine_pool);
+tb_void_t xm_engine_pool_exit(xm_engine_pool_ref_t self) {
+    xm_engine_pool_t *pool = (xm_engine_pool_t *)self;
+    tb_assert_and_check_return(pool);
+
+    // wait the prewarm thread
+    tb_atomic_set(&pool->stopped, 1);
+    if (pool->prewarm_thread) {
+        tb_thread_wait(pool->prewarm_thread, -1, tb_null);
+        tb_thread_exit(pool->prewarm_thread);
+        pool->prewarm_thread = tb_null;
+    }
+
+    // exit all idle engines
+    xm_engine_ref_t engine;
+    while ((engine = xm_engine_pool_pop(pool))) {
+        xm_engine_exit(engine);
     }
-}
 
-xm_engine_ref_t xm_engine_pool_alloc(xm_engine_pool_ref_t engine_pool) {
-    xm_engine_ref_t engine = tb_null;
-    tb_spinlock_enter(&g_engine_pool_lock);
-    if (tb_single_list_size(engine_pool) > 0) {
-        engine = (xm_engine_ref_t)tb_single_list_head(engine_pool);
-        tb_single_list_remove_head(engine_pool);
+    // exit the preloaded modules
+    tb_char_t **module = pool->modules;
+    while (*module) {
+        tb_free(*module);
+        module++;
     }
-    tb_spinlock_leave(&g_engine_pool_lock);
+    tb_free(pool);
+}
+
+xm_engine_ref_t xm_engine_pool_alloc(xm_engine_pool_ref_t self) {
+    xm_engine_pool_t *pool = (xm_engine_pool_t *)self;
+    tb_assert_and_check_return_val(pool, tb_null);
+
+    xm_engine_ref_t engine = xm_engine_pool_pop(pool);
+    tb_atomic_fetch_and_add(engine ? &pool->hits : &pool->misses, 1);
     return engine;
 }
 
-tb_bool_t xm_engine_pool_free(xm_engine_pool_ref_t engine_pool, xm_engine_ref_t engine) {
-    tb_bool_t ok = tb_false;
-    tb_spinlock_enter(&g_engine_pool_lock);
-    if (tb_single_list_size(engine_pool) < XM_ENGINE_POOL_MAXN) {
-        tb_single_list_insert_tail(engine_pool, engine);
-        ok = tb_true;
+tb_bool_t xm_engine_pool_free(xm_engine_pool_ref_t self, xm_engine_ref_t engine) {
+    xm_engine_pool_t *pool = (xm_engine_pool_t *)self;
+    tb_assert_and_check_return_val(pool && engine, tb_false);
+
+    if (!tb_atomic_get(&pool->stopped) && xm_engine_pool_push(pool, engine)) {
+        return tb_true;
+    }
+    tb_atomic_fetch_and_add(&pool->drops, 1);
+    return tb_false;
+}
+
+tb_bool_t xm_engine_pool_prewarm(xm_engine_pool_ref_t self, tb_size_t count, tb_char_t const **modules) {
+    xm_engine_pool_t *pool = (xm_engine_pool_t *)self;
+    tb_assert_and_check_return_val(pool && count, tb_false);
+
+    // only prewarm it once
+    tb_long_t started = 0;
+    if (!tb_atomic_compare_and_swap(&pool->prewarm_started, &started, 1)) {
+        return tb_false;
+    }
+
+    // save the preloaded modules
+    if (modules) {
+        tb_size_t i = 0;
+        while (modules[i] && i < XM_ENGINE_POOL_MODULES_MAXN) {
+            pool->modules[i] = tb_strdup(modules[i]);
+            i++;
+        }
+    }
+
+    // start the prewarm thread, it will exit after all engines are prewarmed
+    tb_atomic_set(&pool->prewarm_count, (tb_long_t)tb_min(count, XM_ENGINE_POOL_MAXN));
+    pool->prewarm_thread = tb_thread_init("engine_pool", xm_engine_pool_prewarm_func, pool, 0);
+    return pool->prewarm_thread != tb_null;
+}
+
+tb_void_t xm_engine_pool_stats(xm_engine_pool_ref_t self, xm_engine_pool_stats_t *stats) {
+    xm_engine_pool_t *pool = (xm_engine_pool_t *)self;
+    tb_assert_and_check_return(pool && stats);
+
+    tb_size_t i;
+    tb_size_t idle = 0;
+    for (i = 0; i < XM_ENGINE_POOL_MAXN; i++) {
+        if (tb_atomic_get(&pool->slots[i])) {
+            idle++;
+        }
     }
-    tb_spinlock_leave(&g_engine_pool_lock);
-    return ok;
+    stats->hits      = (tb_size_t)tb_atomic_get(&pool->hits);
+    stats->misses    = (tb_size_t)tb_atomic_get(&pool->misses);
+    stats->drops     = (tb_size_t)tb_atomic_get(&pool->drops);
+    stats->prewarmed = (tb_size_t)tb_atomic_get(&pool->prewarmed);
+    stats->idle      = idle;
 }
@@ -26,6 +26,13 @@
  */
 #include "prefix.h"
 
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// the max preloaded modules count of the prewarmed engines
+#define XM_ENGINE_POOL_MODULES_MAXN (32)
+
 /* //////////////////////////////////////////////////////////////////////////////////////
  * extern
  */
@@ -36,7 +43,28 @@ __tb_extern_c_enter__
  */
 
 /// the xmake engine pool type
-typedef tb_single_list_ref_t xm_engine_pool_ref_t;
+typedef struct {
+    tb_int_t dummy;
+} const *xm_engine_pool_ref_t;
+
+/// the xmake engine pool stats type
+typedef struct __xm_engine_pool_stats_t {
+    // the count of the engines reused from pool
+    tb_size_t hits;
+
+    // the count of the engines created because the pool is empty
+    tb_size_t misses;
+
+    // the count of the engines exited because the pool is full
+    tb_size_t drops;
+
+    // the count of the prewarmed engines
+    tb_size_t prewarmed;
+
+    // the count of the idle engines in pool
+    tb_size_t idle;
+
+} xm_engine_pool_stats_t;
 
 /* //////////////////////////////////////////////////////////////////////////////////////
  * interfaces
@@ -61,7 +89,7 @@ tb_void_t xm_engine_pool_exit(xm_engine_pool_ref_t engine_pool);
  *
  * @param engine_pool       the engine_pool
  *
- * @return                  the engine
+ * @return                  the engine, it will return null if the pool is empty
  */
 xm_engine_ref_t xm_engine_pool_alloc(xm_engine_pool_ref_t engine_pool);
 
@@ -70,10 +98,30 @@ xm_engine_ref_t xm_engine_pool_alloc(xm_engine_pool_ref_t engine_pool);
  * @param engine_pool       the engine_pool
  * @param engine            the engine
  *
- * @return                  tb_true or tb_false
+ * @return                  tb_true or tb_false, it will return tb_false if the pool is full
  */
 tb_bool_t xm_engine_pool_free(xm_engine_pool_ref_t engine_pool, xm_engine_ref_t engine);
 
+/*! prewarm the given count of engines in a background thread
+ *
+ * the prewarmed engines have loaded the main script and the given modules,
+ * so the new threads can run the callback without loading all core modules again.
+ *
+ * @param engine_pool       the engine_pool
+ * @param count             the engine count
+ * @param modules           the null-terminated module names to be preloaded, it can be null
+ *
+ * @return                  tb_true or tb_false, it will return tb_false if it has been prewarmed
+ */
+tb_bool_t xm_engine_pool_prewarm(xm_engine_pool_ref_t engine_pool, tb_size_t count, tb_char_t const **modules);
+
+/*! get the engine_pool stats
+ *
+ * @param engine_pool       the engine_pool
+ * @param stats             the stats
+ */
+tb_void_t xm_engine_pool_stats(xm_engine_pool_ref_t engine_pool, xm_engine_pool_stats_t *stats);
+
 /* //////////////////////////////////////////////////////////////////////////////////////
  * extern
  */
@@ -0,0 +1,188 @@
+/*!A cross-platform build utility based on Lua
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Copyright (C) 2015-present, Xmake Open Source Community.
+ *
+ * @author      ruki
+ * @file        wait_events.c
+ *
+ */
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * trace
+ */
+#define TB_TRACE_MODULE_NAME "fwatcher.wait_events"
+#define TB_TRACE_MODULE_DEBUG (0)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "prefix.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// the max count of the coalesced events in one batch
+#define XM_FWATCHER_EVENTS_MAXN (4096)
+
+// the min time (ms) of collecting events, we need to report events in time even if files are changed continuously
+#define XM_FWATCHER_EVENTS_MAXTIME_MIN (1000)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+// the coalesced event type
+typedef struct __xm_fwatcher_event_item_t {
+    tb_char_t  *path;
+    tb_uint32_t hash;
+    tb_size_t   type;
+} xm_fwatcher_event_item_t;
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * private implementation
+ */
+static tb_uint32_t xm_fwatcher_event_hash(tb_char_t const *path) {
+    // fnv-1a
+    tb_uint32_t hash = 2166136261u;
+    while (*path) {
+        hash ^= (tb_byte_t)*path++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/* coalesce the new event to the last event of the same path
+ *
+ * - create + modify => create
+ * - create + delete => none, e.g. the temporary files of editors
+ * - delete + create => modify, e.g. save file by renaming the temporary file
+ * - others          => the new event
+ */
+static tb_size_t xm_fwatcher_event_coalesce(tb_size_t type, tb_size_t newtype) {
+    if (type == TB_FWATCHER_EVENT_CREATE && newtype == TB_FWATCHER_EVENT_MODIFY) {
+        return TB_FWATCHER_EVENT_CREATE;
+    } else if (type == TB_FWATCHER_EVENT_CREATE && newtype == TB_FWATCHER_EVENT_DELETE) {
+        return TB_FWATCHER_EVENT_NONE;
+    } else if (type == TB_FWATCHER_EVENT_DELETE && newtype == TB_FWATCHER_EVENT_CREATE) {
+        return TB_FWATCHER_EVENT_MODIFY;
+    }
+    return newtype;
+}
+
+static tb_bool_t xm_fwatcher_event_add(xm_fwatcher_event_item_t *items, tb_size_t *pcount, tb_fwatcher_event_t const *event) {
+    tb_uint32_t hash  = xm_fwatcher_event_hash(event->filepath);
+    tb_size_t   count = *pcount;
+    tb_size_t   i;
+    for (i = 0; i < count; i++) {
+        xm_fwatcher_event_item_t *item = &items[i];
+        if (item->hash == hash && !tb_strcmp(item->path, event->filepath)) {
+            item->type = item->type != TB_FWATCHER_EVENT_NONE ? xm_fwatcher_event_coalesce(item->type, event->event)
+                                                              : event->event;
+            return tb_true;
+        }
+    }
+    tb_check_return_val(count < XM_FWATCHER_EVENTS_MAXN, tb_false);
+
+    tb_char_t *path = tb_strdup(event->filepath);
+    tb_check_return_val(path, tb_false);
+
+    items[count].path = path;
+    items[count].hash = hash;
+    items[count].type = event->event;
+    *pcount = count + 1;
+    return tb_true;
+}
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */
+
+/* wait and coalesce the fwatcher events
+ *
+ * we wait the first event, and collect the following events until there is no any new event in the debounce time,
+ * so the save-storms of editors (e.g. write temporary file, rename, chmod) will be reported as one batch.
+ *
+ * local count, events = fwatcher.wait_events(p, timeout, debounce)
+ * => 2, {{path = "/tmp/a.c", type = 1}, {path = "/tmp/b.h", type = 2}}
+ */
+tb_int_t xm_fwatcher_wait_events(lua_State *lua) {
+    tb_assert_and_check_return_val(lua, 0);
+
+    // is pointer?
+    if (!xm_lua_ispointer(lua, 1)) {
+        return 0;
+    }
+
+    // get the fwatcher
+    tb_fwatcher_ref_t fwatcher = (tb_fwatcher_ref_t)xm_lua_topointer(lua, 1);
+    tb_check_return_val(fwatcher, 0);
+
+    // get the timeout and debounce time
+    tb_long_t timeout  = (tb_long_t)luaL_checkinteger(lua, 2);
+    tb_long_t debounce = (tb_long_t)luaL_optinteger(lua, 3, 100);
+    tb_long_t maxtime  = tb_max(debounce * 4, XM_FWATCHER_EVENTS_MAXTIME_MIN);
+
+    // wait the first event
+    tb_fwatcher_event_t event;
+    tb_long_t ok = tb_fwatcher_wait(fwatcher, &event, timeout);
+    if (ok <= 0) {
+        lua_pushinteger(lua, ok);
+        return 1;
+    }
+
+    // init items
+    xm_fwatcher_event_item_t *items = tb_nalloc0_type(XM_FWATCHER_EVENTS_MAXN, xm_fwatcher_event_item_t);
+    if (!items) {
+        lua_pushinteger(lua, -1);
+        lua_pushliteral(lua, "no memory!");
+        return 2;
+    }
+
+    // collect and coalesce the following events
+    tb_size_t count     = 0;
+    tb_hong_t starttime = tb_mclock();
+    while (ok > 0) {
+        xm_fwatcher_event_add(items, &count, &event);
+        tb_long_t elapsed = (tb_long_t)(tb_mclock() - starttime);
+        tb_check_break(elapsed < maxtime && count < XM_FWATCHER_EVENTS_MAXN);
+        ok = tb_fwatcher_wait(fwatcher, &event, tb_min(debounce, maxtime - elapsed));
+    }
+
+    // save results, we ignore the transient files which have been created and deleted
+    tb_size_t i;
+    tb_int_t  n = 0;
+    lua_newtable(lua);
+    for (i = 0; i < count; i++) {
+        xm_fwatcher_event_item_t *item = &items[i];
+        if (item->type != TB_FWATCHER_EVENT_NONE) {
+            lua_newtable(lua);
+            lua_pushstring(lua, "path");
+            lua_pushstring(lua, item->path);
+            lua_settable(lua, -3);
+            lua_pushstring(lua, "type");
+            lua_pushinteger(lua, (lua_Integer)item->type);
+            lua_settable(lua, -3);
+            lua_rawseti(lua, -2, ++n);
+        }
+        tb_free(item->path);
+    }
+    tb_free(items);
+
+    // return count and events
+    lua_pushinteger(lua, n);
+    lua_insert(lua, -2);
+    return 2;
+}
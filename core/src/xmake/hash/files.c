@@ -0,0 +1,354 @@
+/*!A cross-platform build utility based on Lua
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Copyright (C) 2015-present, Xmake Open Source Community.
+ *
+ * @author      ruki
+ * @file        files.c
+ *
+ */
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * trace
+ */
+#define TB_TRACE_MODULE_NAME "files"
+#define TB_TRACE_MODULE_DEBUG (0)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "prefix.h"
+#include "../utils/parallel.h"
+#define XXH_NAMESPACE XM_
+#define XXH_STATIC_LINKING_ONLY
+#include "xxhash/xxhash.h"
+#ifndef TB_CONFIG_OS_WINDOWS
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// we map the file to memory if it's larger than this size
+#define XM_HASH_FILES_MMAP_MINSIZE (256 * 1024)
+
+// the read buffer size of worker
+#define XM_HASH_FILES_BUFFER_SIZE (256 * 1024)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+// the hash algorithm
+typedef enum __xm_hash_files_algo_e {
+    XM_HASH_FILES_ALGO_NONE    = 0,
+    XM_HASH_FILES_ALGO_XXH32   = 1,
+    XM_HASH_FILES_ALGO_XXH64   = 2,
+    XM_HASH_FILES_ALGO_XXH128  = 3,
+    XM_HASH_FILES_ALGO_SHA1    = 4,
+    XM_HASH_FILES_ALGO_SHA256  = 5,
+    XM_HASH_FILES_ALGO_MD5     = 6,
+} xm_hash_files_algo_e;
+
+// the hash context
+typedef struct __xm_hash_files_ctx_t {
+    tb_size_t     algo;
+    XXH3_state_t *xxh3;
+    tb_sha_t      sha;
+    tb_md5_t      md5;
+} xm_hash_files_ctx_t;
+
+// the file item
+typedef struct __xm_hash_files_item_t {
+    tb_char_t const *filepath;
+    tb_char_t        digest[72];
+    tb_size_t        digest_len;
+} xm_hash_files_item_t;
+
+// the hash job, it is shared between all workers
+typedef struct __xm_hash_files_job_t {
+    tb_size_t             algo;
+    xm_hash_files_item_t *items;
+} xm_hash_files_job_t;
+
+// the local data of worker
+typedef struct __xm_hash_files_local_t {
+    xm_hash_files_ctx_t ctx;
+    tb_byte_t           buffer[XM_HASH_FILES_BUFFER_SIZE];
+} xm_hash_files_local_t;
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * private implementation
+ */
+static tb_size_t xm_hash_files_algo(tb_char_t const *name) {
+    if (!tb_strcmp(name, "xxh128") || !tb_strcmp(name, "xxhash128")) {
+        return XM_HASH_FILES_ALGO_XXH128;
+    } else if (!tb_strcmp(name, "xxh64") || !tb_strcmp(name, "xxhash64")) {
+        return XM_HASH_FILES_ALGO_XXH64;
+    } else if (!tb_strcmp(name, "xxh32") || !tb_strcmp(name, "xxhash32")) {
+        return XM_HASH_FILES_ALGO_XXH32;
+    } else if (!tb_strcmp(name, "sha256")) {
+        return XM_HASH_FILES_ALGO_SHA256;
+    } else if (!tb_strcmp(name, "sha1")) {
+        return XM_HASH_FILES_ALGO_SHA1;
+    } else if (!tb_strcmp(name, "md5")) {
+        return XM_HASH_FILES_ALGO_MD5;
+    }
+    return XM_HASH_FILES_ALGO_NONE;
+}
+
+static tb_void_t xm_hash_files_ctx_reset(xm_hash_files_ctx_t *ctx) {
+    switch (ctx->algo) {
+    case XM_HASH_FILES_ALGO_XXH32:
+    case XM_HASH_FILES_ALGO_XXH64:
+        XM_XXH3_64bits_reset(ctx->xxh3);
+        break;
+    case XM_HASH_FILES_ALGO_XXH128:
+        XM_XXH3_128bits_reset(ctx->xxh3);
+        break;
+    case XM_HASH_FILES_ALGO_SHA1:
+        tb_sha_init(&ctx->sha, 160);
+        break;
+    case XM_HASH_FILES_ALGO_SHA256:
+        tb_sha_init(&ctx->sha, 256);
+        break;
+    case XM_HASH_FILES_ALGO_MD5:
+        tb_md5_init(&ctx->md5, 0);
+        break;
+    default:
+        break;
+    }
+}
+
+static tb_void_t xm_hash_files_ctx_update(xm_hash_files_ctx_t *ctx, tb_byte_t const *data, tb_size_t size) {
+    switch (ctx->algo) {
+    case XM_HASH_FILES_ALGO_XXH32:
+    case XM_HASH_FILES_ALGO_XXH64:
+        XM_XXH3_64bits_update(ctx->xxh3, data, size);
+        break;
+    case XM_HASH_FILES_ALGO_XXH128:
+        XM_XXH3_128bits_update(ctx->xxh3, data, size);
+        break;
+    case XM_HASH_FILES_ALGO_SHA1:
+    case XM_HASH_FILES_ALGO_SHA256:
+        tb_sha_spak(&ctx->sha, data, size);
+        break;
+    case XM_HASH_FILES_ALGO_MD5:
+        tb_md5_spak(&ctx->md5, data, size);
+        break;
+    default:
+        break;
+    }
+}
+
+// make the digest string, it is the same as hash.xxhash128(), hash.sha256(), ...
+static tb_size_t xm_hash_files_ctx_final(xm_hash_files_ctx_t *ctx, tb_char_t *digest) {
+    tb_char_t        s[256];
+    tb_size_t        n      = 0;
+    tb_byte_t        buffer[32];
+    tb_uint32_t      value32;
+    XXH64_hash_t     value64;
+    XXH128_hash_t    value128;
+    tb_byte_t const *result = buffer;
+    switch (ctx->algo) {
+    case XM_HASH_FILES_ALGO_XXH32:
+        value64 = XM_XXH3_64bits_digest(ctx->xxh3);
+        value32 = (value64 >> 32) ^ (value64 & 0xffffffff);
+        result  = (tb_byte_t const *)&value32;
+        n       = 4;
+        break;
+    case XM_HASH_FILES_ALGO_XXH64:
+        value64 = XM_XXH3_64bits_digest(ctx->xxh3);
+        result  = (tb_byte_t const *)&value64;
+        n       = 8;
+        break;
+    case XM_HASH_FILES_ALGO_XXH128:
+        value128 = XM_XXH3_128bits_digest(ctx->xxh3);
+        result   = (tb_byte_t const *)&value128;
+        n        = 16;
+        break;
+    case XM_HASH_FILES_ALGO_SHA1:
+    case XM_HASH_FILES_ALGO_SHA256:
+        tb_sha_exit(&ctx->sha, buffer, sizeof(buffer));
+        n = ctx->sha.digest_len << 2;
+        break;
+    case XM_HASH_FILES_ALGO_MD5:
+        tb_md5_exit(&ctx->md5, buffer, 16);
+        n = 16;
+        break;
+    default:
+        break;
+    }
+    tb_size_t len = xm_hash_make_cstr(s, result, n);
+    tb_memcpy(digest, s, len + 1);
+    return len;
+}
+
+// hash the given file, we map the large file to memory to avoid copying data
+static tb_bool_t xm_hash_files_hash(xm_hash_files_ctx_t *ctx, tb_char_t const *filepath, tb_byte_t *buffer,
+                                    tb_size_t buffer_size) {
+    tb_bool_t ok = tb_false;
+    xm_hash_files_ctx_reset(ctx);
+#ifndef TB_CONFIG_OS_WINDOWS
+    tb_int_t fd = open(filepath, O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+            tb_size_t   size = (tb_size_t)st.st_size;
+            tb_pointer_t data = MAP_FAILED;
+            if (size >= XM_HASH_FILES_MMAP_MINSIZE) {
+                data = mmap(tb_null, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            }
+            if (data != MAP_FAILED) {
+#ifdef MADV_SEQUENTIAL
+                madvise(data, size, MADV_SEQUENTIAL);
+#endif
+                xm_hash_files_ctx_update(ctx, (tb_byte_t const *)data, size);
+                munmap(data, size);
+                ok = tb_true;
+            } else {
+                ssize_t real;
+                while ((real = read(fd, buffer, buffer_size)) > 0) {
+                    xm_hash_files_ctx_update(ctx, buffer, (tb_size_t)real);
+                }
+                ok = real == 0;
+            }
+        }
+        close(fd);
+    }
+#else
+    tb_file_ref_t file = tb_file_init(filepath, TB_FILE_MODE_RO);
+    if (file) {
+        tb_long_t real;
+        while ((real = tb_file_read(file, buffer, buffer_size)) > 0) {
+            xm_hash_files_ctx_update(ctx, buffer, (tb_size_t)real);
+        }
+        ok = real == 0;
+        tb_file_exit(file);
+    }
+#endif
+    return ok;
+}
+
+static tb_pointer_t xm_hash_files_local_init(tb_cpointer_t priv) {
+    xm_hash_files_job_t *job = (xm_hash_files_job_t *)priv;
+    xm_hash_files_local_t *local = tb_malloc0_type(xm_hash_files_local_t);
+    tb_assert_and_check_return_val(job && local, tb_null);
+
+    local->ctx.algo = job->algo;
+    local->ctx.xxh3 = XM_XXH3_createState();
+    if (!local->ctx.xxh3) {
+        tb_free(local);
+        return tb_null;
+    }
+    return local;
+}
+static tb_void_t xm_hash_files_local_exit(tb_pointer_t priv, tb_cpointer_t job) {
+    xm_hash_files_local_t *local = (xm_hash_files_local_t *)priv;
+    if (local) {
+        XM_XXH3_freeState(local->ctx.xxh3);
+        tb_free(local);
+    }
+}
+static tb_void_t xm_hash_files_done(tb_size_t index, tb_pointer_t priv, tb_cpointer_t job) {
+    xm_hash_files_local_t *local = (xm_hash_files_local_t *)priv;
+    xm_hash_files_item_t  *item  = &((xm_hash_files_job_t *)job)->items[index];
+    if (xm_hash_files_hash(&local->ctx, item->filepath, local->buffer, XM_HASH_FILES_BUFFER_SIZE)) {
+        item->digest_len = xm_hash_files_ctx_final(&local->ctx, item->digest);
+    }
+}
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */
+
+/* hash files in parallel
+ *
+ * local digests = hash._files({"/tmp/a", "/tmp/b"}, "xxh128", 8)
+ *
+ * @return the digests table, e.g. {["/tmp/a"] = "xxx", ["/tmp/b"] = false}
+ */
+tb_int_t xm_hash_files(lua_State *lua) {
+    tb_assert_and_check_return_val(lua, 0);
+
+    // get files and algorithm
+    luaL_checktype(lua, 1, LUA_TTABLE);
+    tb_char_t const *algoname = luaL_optstring(lua, 2, "xxh128");
+    tb_size_t        algo     = xm_hash_files_algo(algoname);
+    if (algo == XM_HASH_FILES_ALGO_NONE) {
+        lua_pushnil(lua);
+        lua_pushfstring(lua, "unknown hash algorithm(%s)!", algoname);
+        return 2;
+    }
+
+    // get threads count
+    tb_size_t i;
+    tb_size_t count   = (tb_size_t)lua_objlen(lua, 1);
+    tb_long_t threads = (tb_long_t)luaL_optinteger(lua, 3, 0);
+
+    // init items, the file paths are referenced by lua stack during hashing
+    xm_hash_files_job_t job;
+    tb_memset(&job, 0, sizeof(job));
+    job.algo = algo;
+    if (count) {
+        job.items = tb_nalloc0_type(count, xm_hash_files_item_t);
+        if (!job.items) {
+            lua_pushnil(lua);
+            lua_pushliteral(lua, "no memory!");
+            return 2;
+        }
+    }
+    for (i = 0; i < count; i++) {
+        lua_rawgeti(lua, 1, (tb_int_t)(i + 1));
+        job.items[i].filepath = lua_tostring(lua, -1);
+        lua_pop(lua, 1);
+        if (!job.items[i].filepath) {
+            tb_free(job.items);
+            lua_pushnil(lua);
+            lua_pushfstring(lua, "invalid file path at index(%d)!", (tb_int_t)(i + 1));
+            return 2;
+        }
+    }
+
+    // hash files in parallel
+    xm_parallel_task_t task;
+    tb_memset(&task, 0, sizeof(task));
+    task.count      = count;
+    task.priv       = &job;
+    task.done       = xm_hash_files_done;
+    task.local_init = xm_hash_files_local_init;
+    task.local_exit = xm_hash_files_local_exit;
+    xm_parallel_for(&task, threads > 0 ? (tb_size_t)threads : 0);
+
+    // save results
+    lua_createtable(lua, 0, (tb_int_t)count);
+    for (i = 0; i < count; i++) {
+        xm_hash_files_item_t *item = &job.items[i];
+        lua_pushstring(lua, item->filepath);
+        if (item->digest_len) {
+            lua_pushlstring(lua, item->digest, item->digest_len);
+        } else {
+            lua_pushboolean(lua, tb_false);
+        }
+        lua_rawset(lua, -3);
+    }
+    if (job.items) {
+        tb_free(job.items);
+    }
+    return 1;
+}
@@ -0,0 +1,290 @@
+/*!A cross-platform build utility based on Lua
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Copyright (C) 2015-present, Xmake Open Source Community.
+ *
+ * @author      ruki
+ * @file        xxhash_cppfile.c
+ *
+ */
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * trace
+ */
+#define TB_TRACE_MODULE_NAME "xxhash_cppfile"
+#define TB_TRACE_MODULE_DEBUG (0)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "prefix.h"
+#define XXH_NAMESPACE XM_
+#define XXH_STATIC_LINKING_ONLY
+#include "xxhash/xxhash.h"
+#include <string.h>
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// the max size of the line marker, the longer directive lines will be hashed directly
+#define XM_HASH_CPPFILE_LINE_MAXN (4096)
+
+// the max count of the path prefixes
+#define XM_HASH_CPPFILE_PREFIX_MAXN (16)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+// the path prefix map type
+typedef struct __xm_hash_cppfile_prefix_t {
+    tb_char_t const *from;
+    tb_size_t from_n;
+    tb_char_t const *to;
+    tb_size_t to_n;
+} xm_hash_cppfile_prefix_t;
+
+// the hash state type
+typedef struct __xm_hash_cppfile_t {
+    tb_size_t mode;
+    XXH3_state_t *state;
+    xm_hash_cppfile_prefix_t prefixes[XM_HASH_CPPFILE_PREFIX_MAXN];
+    tb_size_t prefixes_count;
+    tb_byte_t line[XM_HASH_CPPFILE_LINE_MAXN];
+    tb_size_t line_size;
+} xm_hash_cppfile_t;
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * private implementation
+ */
+static tb_void_t xm_hash_cppfile_update(xm_hash_cppfile_t *cppfile, tb_pointer_t data, tb_size_t size) {
+    if (cppfile->mode == 128) {
+        XM_XXH3_128bits_update(cppfile->state, data, size);
+    } else {
+        XM_XXH3_64bits_update(cppfile->state, data, size);
+    }
+}
+static tb_bool_t xm_hash_cppfile_prefix_match(tb_byte_t const *data, tb_size_t size, xm_hash_cppfile_prefix_t const *prefix) {
+    if (size < prefix->from_n) {
+        return tb_false;
+    }
+#ifdef TB_CONFIG_OS_WINDOWS
+    if (tb_strnicmp((tb_char_t const *)data, prefix->from, prefix->from_n)) {
+        return tb_false;
+    }
+#else
+    if (tb_memcmp(data, prefix->from, prefix->from_n)) {
+        return tb_false;
+    }
+#endif
+
+    // we only match the whole directory, e.g. /tmp/foo cannot match /tmp/foobar
+    if (size > prefix->from_n) {
+        tb_char_t ch = (tb_char_t)data[prefix->from_n];
+        return ch == '/' || ch == '\\' || ch == '"';
+    }
+    return tb_true;
+}
+
+/* hash the line marker, we replace the path prefix with the mapped prefix, e.g.
+ *
+ * # 1 "/home/runner/work/foo/src/foo.c" -> # 1 "./src/foo.c"
+ * #line 1 "C:\\work\\foo\\src\\foo.c"   -> #line 1 ".\\src\\foo.c"
+ */
+static tb_void_t xm_hash_cppfile_linemarker(xm_hash_cppfile_t *cppfile) {
+    tb_byte_t *line = cppfile->line;
+    tb_size_t size = cppfile->line_size;
+    tb_byte_t const *quote = (tb_byte_t const *)memchr(line, '"', size);
+    if (quote) {
+        tb_size_t offset = quote + 1 - line;
+        tb_size_t i;
+        for (i = 0; i < cppfile->prefixes_count; i++) {
+            xm_hash_cppfile_prefix_t const *prefix = &cppfile->prefixes[i];
+            if (xm_hash_cppfile_prefix_match(line + offset, size - offset, prefix)) {
+                xm_hash_cppfile_update(cppfile, line, offset);
+                xm_hash_cppfile_update(cppfile, (tb_pointer_t)prefix->to, prefix->to_n);
+                xm_hash_cppfile_update(cppfile, line + offset + prefix->from_n, size - offset - prefix->from_n);
+                return;
+            }
+        }
+    }
+    xm_hash_cppfile_update(cppfile, line, size);
+}
+
+// hash the given data, we only need to buffer the directive lines
+static tb_void_t xm_hash_cppfile_data(xm_hash_cppfile_t *cppfile, tb_byte_t const *data, tb_size_t size,
+                                      tb_bool_t *pline_start, tb_bool_t *pline_marker) {
+    tb_byte_t const *p = data;
+    tb_byte_t const *e = data + size;
+    while (p < e) {
+        // is the line marker?
+        if (*pline_start) {
+            *pline_start = tb_false;
+            if (*p == '#') {
+                *pline_marker = tb_true;
+                cppfile->line_size = 0;
+            }
+        }
+
+        // get the line data
+        tb_byte_t const *lf = (tb_byte_t const *)memchr(p, '\n', e - p);
+        tb_size_t n = lf ? lf + 1 - p : e - p;
+        if (*pline_marker) {
+            if (cppfile->line_size + n <= XM_HASH_CPPFILE_LINE_MAXN) {
+                tb_memcpy(cppfile->line + cppfile->line_size, p, n);
+                cppfile->line_size += n;
+            } else {
+                // it's too long, we hash it directly
+                xm_hash_cppfile_update(cppfile, cppfile->line, cppfile->line_size);
+                xm_hash_cppfile_update(cppfile, (tb_pointer_t)p, n);
+                cppfile->line_size = 0;
+                *pline_marker = tb_false;
+            }
+        } else {
+            xm_hash_cppfile_update(cppfile, (tb_pointer_t)p, n);
+        }
+
+        // the line is finished?
+        if (lf) {
+            if (*pline_marker) {
+                xm_hash_cppfile_linemarker(cppfile);
+                cppfile->line_size = 0;
+                *pline_marker = tb_false;
+            }
+            *pline_start = tb_true;
+        }
+        p += n;
+    }
+}
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */
+
+/* hash the preprocessed file and map the path prefixes of the line markers,
+ * so the same code in the different directories has the same hash value
+ *
+ * hash.xxhash_cppfile(128, "/tmp/foo.i", {"/home/runner/work/foo", "."})
+ */
+tb_int_t xm_hash_xxhash_cppfile(lua_State *lua) {
+    tb_assert_and_check_return_val(lua, 0);
+
+    // get mode
+    tb_size_t mode = (tb_size_t)lua_tointeger(lua, 1);
+    if (mode != 64 && mode != 128) {
+        lua_pushnil(lua);
+        lua_pushfstring(lua, "invalid mode(%d)!", (tb_int_t)mode);
+        return 2;
+    }
+
+    // get the filename
+    tb_char_t const *filename = luaL_checkstring(lua, 2);
+    tb_check_return_val(filename, 0);
+
+    // init the hash state
+    xm_hash_cppfile_t *cppfile = tb_malloc0_type(xm_hash_cppfile_t);
+    tb_assert_and_check_return_val(cppfile, 0);
+    cppfile->mode = mode;
+
+    // get the path prefixes, e.g. {from1, to1, from2, to2, ...}
+    if (lua_istable(lua, 3)) {
+        tb_size_t i;
+        tb_size_t n = (tb_size_t)lua_objlen(lua, 3);
+        for (i = 1; i + 1 <= n && cppfile->prefixes_count < XM_HASH_CPPFILE_PREFIX_MAXN; i += 2) {
+            size_t from_n = 0;
+            size_t to_n = 0;
+            lua_rawgeti(lua, 3, (tb_int_t)i);
+            lua_rawgeti(lua, 3, (tb_int_t)i + 1);
+            tb_char_t const *from = lua_tolstring(lua, -2, &from_n);
+            tb_char_t const *to = lua_tolstring(lua, -1, &to_n);
+            lua_pop(lua, 2);
+            if (from && to && from_n) {
+                // the strings are still referenced by the table
+                xm_hash_cppfile_prefix_t *prefix = &cppfile->prefixes[cppfile->prefixes_count++];
+                prefix->from = from;
+                prefix->from_n = (tb_size_t)from_n;
+                prefix->to = to;
+                prefix->to_n = (tb_size_t)to_n;
+            }
+        }
+    }
+
+    // hash file
+    tb_bool_t ok = tb_false;
+    tb_stream_ref_t stream = tb_stream_init_from_file(filename, TB_FILE_MODE_RO);
+    if (stream) {
+        cppfile->state = XM_XXH3_createState();
+        if (tb_stream_open(stream) && cppfile->state) {
+            if (mode == 128) {
+                XM_XXH3_128bits_reset(cppfile->state);
+            } else {
+                XM_XXH3_64bits_reset(cppfile->state);
+            }
+
+            // read data and update xxhash
+            tb_bool_t line_start = tb_true;
+            tb_bool_t line_marker = tb_false;
+            tb_byte_t data[TB_STREAM_BLOCK_MAXN];
+            while (!tb_stream_beof(stream)) {
+                tb_long_t real = tb_stream_read(stream, data, sizeof(data));
+                if (real > 0) {
+                    xm_hash_cppfile_data(cppfile, data, (tb_size_t)real, &line_start, &line_marker);
+                } else if (!real) {
+                    real = tb_stream_wait(stream, TB_STREAM_WAIT_READ, tb_stream_timeout(stream));
+                    tb_check_break(real > 0);
+                    tb_assert_and_check_break(real & TB_STREAM_WAIT_READ);
+                } else {
+                    break;
+                }
+            }
+
+            // the last line has no line feed?
+            if (line_marker) {
+                xm_hash_cppfile_linemarker(cppfile);
+            }
+
+            // compuate hash
+            tb_byte_t const *buffer = tb_null;
+            XXH64_hash_t value64;
+            XXH128_hash_t value128;
+            if (mode == 128) {
+                value128 = XM_XXH3_128bits_digest(cppfile->state);
+                buffer = (tb_byte_t const *)&value128;
+            } else {
+                value64 = XM_XXH3_64bits_digest(cppfile->state);
+                buffer = (tb_byte_t const *)&value64;
+            }
+
+            tb_char_t s[256];
+            tb_size_t len = xm_hash_make_cstr(s, buffer, mode >> 3);
+            lua_pushlstring(lua, s, len);
+            ok = tb_true;
+        }
+        tb_stream_exit(stream);
+    }
+
+    // exit the hash state
+    if (cppfile->state) {
+        XM_XXH3_freeState(cppfile->state);
+    }
+    tb_free(cppfile);
+
+    if (!ok) {
+        lua_pushnil(lua);
+        lua_pushfstring(lua, "failed to read file: %s", filename);
+        return 2;
+    }
+    return 1;
+}
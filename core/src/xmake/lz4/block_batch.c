@@ -0,0 +1,172 @@
+/*!A cross-platform build utility based on Lua
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Copyright (C) 2015-present, Xmake Open Source Community.
+ *
+ * @author      ruki
+ * @file        block_batch.c
+ *
+ */
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * trace
+ */
+#define TB_TRACE_MODULE_NAME "block_batch"
+#define TB_TRACE_MODULE_DEBUG (0)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "prefix.h"
+#include "../utils/parallel.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// the max size of the output buffers in flight, we push the results of each round to lua and free them
+#define XM_LZ4_BLOCK_BATCH_INFLIGHT_MAXN (64 * 1024 * 1024)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+// the block item
+typedef struct __xm_lz4_block_item_t {
+    tb_char_t const *data;
+    tb_int_t         size;
+    tb_char_t       *output;
+    tb_int_t         output_maxn;
+    tb_int_t         output_size;
+} xm_lz4_block_item_t;
+
+// the batch job, it is shared between all workers
+typedef struct __xm_lz4_block_job_t {
+    xm_lz4_block_item_t *items;
+    tb_bool_t            decompress;
+} xm_lz4_block_job_t;
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * private implementation
+ */
+static tb_void_t xm_lz4_block_batch_done(tb_size_t index, tb_pointer_t local, tb_cpointer_t priv) {
+    xm_lz4_block_job_t  *job  = (xm_lz4_block_job_t *)priv;
+    xm_lz4_block_item_t *item = &job->items[index];
+    item->output = (tb_char_t *)tb_malloc_bytes(item->output_maxn);
+    tb_check_return(item->output);
+
+    if (job->decompress) {
+        item->output_size = LZ4_decompress_safe(item->data, item->output, item->size, item->output_maxn);
+    } else {
+        item->output_size = LZ4_compress_default(item->data, item->output, item->size, item->output_maxn);
+    }
+}
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */
+tb_int_t xm_lz4_block_batch(lua_State *lua, tb_bool_t decompress) {
+    tb_assert_and_check_return_val(lua, 0);
+
+    // get blocks count and threads
+    tb_size_t i;
+    luaL_checktype(lua, 1, LUA_TTABLE);
+    if (decompress) {
+        luaL_checktype(lua, 2, LUA_TTABLE);
+    }
+    tb_size_t count   = (tb_size_t)lua_objlen(lua, 1);
+    tb_long_t threads = (tb_long_t)luaL_optinteger(lua, decompress ? 3 : 2, 0);
+
+    // init items, all block data are still referenced by the blocks table
+    xm_lz4_block_job_t job;
+    tb_memset(&job, 0, sizeof(job));
+    job.decompress = decompress;
+    if (count) {
+        job.items = tb_nalloc0_type(count, xm_lz4_block_item_t);
+        if (!job.items) {
+            lua_pushnil(lua);
+            lua_pushliteral(lua, "no memory!");
+            return 2;
+        }
+    }
+    for (i = 0; i < count; i++) {
+        size_t size = 0;
+        xm_lz4_block_item_t *item = &job.items[i];
+        lua_rawgeti(lua, 1, (tb_int_t)(i + 1));
+        item->data = lua_tolstring(lua, -1, &size);
+        item->size = (tb_int_t)size;
+        lua_pop(lua, 1);
+        if (decompress) {
+            lua_rawgeti(lua, 2, (tb_int_t)(i + 1));
+            item->output_maxn = (tb_int_t)lua_tointeger(lua, -1);
+            lua_pop(lua, 1);
+        } else if (size <= LZ4_MAX_INPUT_SIZE) {
+            item->output_maxn = LZ4_compressBound(item->size);
+        }
+        if (!item->data || !size || item->output_maxn <= 0) {
+            tb_free(job.items);
+            lua_pushnil(lua);
+            lua_pushfstring(lua, decompress ? "invalid block data or size at index(%d)!" : "invalid block data at index(%d)!", (tb_int_t)(i + 1));
+            return 2;
+        }
+    }
+
+    // do blocks in parallel, the output buffers in flight are limited in each round
+    tb_bool_t ok = tb_true;
+    tb_size_t start = 0;
+    xm_lz4_block_item_t *items = job.items;
+    lua_createtable(lua, (tb_int_t)count, 0);
+    while (ok && start < count) {
+        tb_size_t end = start;
+        tb_size_t size = 0;
+        while (end < count && (end == start || size + items[end].output_maxn <= XM_LZ4_BLOCK_BATCH_INFLIGHT_MAXN)) {
+            size += items[end].output_maxn;
+            end++;
+        }
+
+        xm_parallel_task_t task;
+        tb_memset(&task, 0, sizeof(task));
+        job.items  = items + start;
+        task.count = end - start;
+        task.priv  = &job;
+        task.done  = xm_lz4_block_batch_done;
+        xm_parallel_for(&task, threads > 0 ? (tb_size_t)threads : 0);
+
+        // save results
+        for (i = start; i < end; i++) {
+            xm_lz4_block_item_t *item = &items[i];
+            if (item->output && (decompress ? item->output_size == item->output_maxn : item->output_size > 0)) {
+                lua_pushlstring(lua, item->output, item->output_size);
+                lua_rawseti(lua, -2, (tb_int_t)(i + 1));
+            } else {
+                ok = tb_false;
+            }
+            if (item->output) {
+                tb_free(item->output);
+                item->output = tb_null;
+            }
+        }
+        start = end;
+    }
+    if (items) {
+        tb_free(items);
+    }
+    if (!ok) {
+        lua_pop(lua, 1);
+        lua_pushnil(lua);
+        lua_pushstring(lua, decompress ? "decompress block data failed!" : "compress block data failed!");
+        return 2;
+    }
+    return 1;
+}
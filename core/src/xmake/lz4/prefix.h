@@ -78,6 +78,15 @@ typedef struct __xm_lz4_dstream_t {
  * interfaces
  */
 
+/* compress or decompress the given lua blocks in parallel
+ *
+ * @param lua           the lua state, the arguments are (blocks, [realsizes], threads)
+ * @param decompress    decompress blocks?
+ *
+ * @return              the results count on the lua stack
+ */
+tb_int_t xm_lz4_block_batch(lua_State *lua, tb_bool_t decompress);
+
 static __tb_inline__ tb_void_t xm_lz4_cstream_exit(xm_lz4_cstream_t *stream) {
     if (stream) {
         if (stream->cctx) {
@@ -29,6 +29,217 @@
  * includes
  */
 #include "prefix.h"
+#if defined(TB_CONFIG_OS_WINDOWS)
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+#if defined(TB_CONFIG_OS_LINUX)
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// the ioctl of reflink (btrfs, xfs, ...), @see linux/fs.h
+#if defined(TB_CONFIG_OS_LINUX) && !defined(FICLONE)
+#define FICLONE _IOW(0x94, 9, int)
+#endif
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+// the copy strategy
+typedef enum __xm_os_cpfile_strategy_e {
+    XM_OS_CPFILE_STRATEGY_AUTO     = 0, //!< reflink -> copy_file_range -> read/write
+    XM_OS_CPFILE_STRATEGY_COPY     = 1, //!< always copy the file data
+    XM_OS_CPFILE_STRATEGY_HARDLINK = 2, //!< hardlink to the source file, fallback to auto
+    XM_OS_CPFILE_STRATEGY_SYMLINK  = 3, //!< symlink to the source file, fallback to auto
+} xm_os_cpfile_strategy_e;
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * private implementation
+ */
+static tb_size_t xm_os_cpfile_strategy(tb_char_t const *strategy) {
+    if (strategy) {
+        if (!tb_strcmp(strategy, "copy")) {
+            return XM_OS_CPFILE_STRATEGY_COPY;
+        } else if (!tb_strcmp(strategy, "hardlink")) {
+            return XM_OS_CPFILE_STRATEGY_HARDLINK;
+        } else if (!tb_strcmp(strategy, "symlink")) {
+            return XM_OS_CPFILE_STRATEGY_SYMLINK;
+        }
+    }
+    return XM_OS_CPFILE_STRATEGY_AUTO;
+}
+
+// create the parent directory of the given file path
+static tb_bool_t xm_os_cpfile_mkparent(tb_char_t const *filepath) {
+    tb_char_t        data[TB_PATH_MAXN];
+    tb_char_t const *dir = tb_path_directory(filepath, data, sizeof(data));
+    return dir && (tb_file_info(dir, tb_null) || tb_directory_create(dir));
+}
+
+#if !defined(TB_CONFIG_OS_WINDOWS)
+// is the same file? e.g. it has been hardlinked to the source file
+//
+// we use lstat() for the destination file, because it may be a stale symlink to the other file (e.g. the build cache)
+static tb_bool_t xm_os_cpfile_is_same(tb_char_t const *src, tb_char_t const *dst) {
+    struct stat src_st;
+    struct stat dst_st;
+    return lstat(src, &src_st) == 0 && lstat(dst, &dst_st) == 0 && src_st.st_dev == dst_st.st_dev &&
+           src_st.st_ino == dst_st.st_ino;
+}
+#endif
+
+/* remove the old destination file before linking or copying it
+ *
+ * the destination file may be linked to the other file (e.g. the build cache),
+ * so we must not write data through it.
+ *
+ * @param linked_only   only remove it if it is a symlink or has multiple hardlinks, e.g. copy_if_different
+ */
+static tb_void_t xm_os_cpfile_unlink(tb_char_t const *src, tb_char_t const *dst, tb_bool_t linked_only) {
+
+    // we must not remove the source file itself
+    tb_char_t        srcpath[TB_PATH_MAXN];
+    tb_char_t        dstpath[TB_PATH_MAXN];
+    tb_char_t const *srcabs = tb_path_absolute(src, srcpath, sizeof(srcpath));
+    tb_char_t const *dstabs = tb_path_absolute(dst, dstpath, sizeof(dstpath));
+#if defined(TB_CONFIG_OS_WINDOWS)
+    if (!srcabs || !dstabs || !tb_stricmp(srcabs, dstabs)) {
+        return;
+    }
+    if (linked_only) {
+        return;
+    }
+    tb_file_remove(dst);
+#else
+    if (!srcabs || !dstabs || !tb_strcmp(srcabs, dstabs)) {
+        return;
+    }
+    struct stat st;
+    if (lstat(dst, &st) != 0) {
+        return;
+    }
+    if (linked_only && !S_ISLNK(st.st_mode) && st.st_nlink <= 1) {
+        return;
+    }
+    unlink(dst);
+#endif
+}
+
+// link the destination file to the source file, the old destination file will be replaced
+static tb_bool_t xm_os_cpfile_link(tb_char_t const *src, tb_char_t const *dst, tb_bool_t is_symlink) {
+#if !defined(TB_CONFIG_OS_WINDOWS)
+    if (xm_os_cpfile_is_same(src, dst)) {
+        return tb_true;
+    }
+#endif
+    xm_os_cpfile_unlink(src, dst, tb_false);
+    if (is_symlink) {
+        // we always use the absolute source path, because the link is relative to the destination directory
+        tb_char_t        srcpath[TB_PATH_MAXN];
+        tb_char_t const *srcabs = tb_path_absolute(src, srcpath, sizeof(srcpath));
+        tb_check_return_val(srcabs, tb_false);
+        if (!tb_file_link(srcabs, dst)) {
+            return xm_os_cpfile_mkparent(dst) && tb_file_link(srcabs, dst);
+        }
+        return tb_true;
+    }
+#if defined(TB_CONFIG_OS_WINDOWS)
+    tb_wchar_t srcpath_w[TB_PATH_MAXN];
+    tb_wchar_t dstpath_w[TB_PATH_MAXN];
+    if (tb_atow(srcpath_w, src, TB_PATH_MAXN) == (tb_size_t)-1 ||
+        tb_atow(dstpath_w, dst, TB_PATH_MAXN) == (tb_size_t)-1) {
+        return tb_false;
+    }
+    if (!CreateHardLinkW(dstpath_w, srcpath_w, tb_null)) {
+        return xm_os_cpfile_mkparent(dst) && CreateHardLinkW(dstpath_w, srcpath_w, tb_null);
+    }
+    return tb_true;
+#else
+    if (link(src, dst) != 0) {
+        return errno == ENOENT && xm_os_cpfile_mkparent(dst) && link(src, dst) == 0;
+    }
+    return tb_true;
+#endif
+}
+
+#if defined(TB_CONFIG_OS_LINUX)
+/* copy file data in the kernel, we try reflink (FICLONE) first, then copy_file_range
+ *
+ * it only works for regular files, and we return false to fallback to tb_file_copy() if it fails
+ */
+static tb_bool_t xm_os_cpfile_fast(tb_char_t const *src, tb_char_t const *dst, tb_bool_t is_writeable) {
+    tb_int_t  ifd = -1;
+    tb_int_t  ofd = -1;
+    tb_bool_t ok  = tb_false;
+    do {
+        // open the source file
+        struct stat st;
+        ifd = open(src, O_RDONLY | O_CLOEXEC);
+        tb_check_break(ifd >= 0);
+        tb_check_break(fstat(ifd, &st) == 0 && S_ISREG(st.st_mode));
+
+        // the pseudo files (e.g. /proc/*, sysfs, some fuse files) may report zero size, we need to read them by tb_file_copy()
+        tb_check_break(st.st_size > 0);
+
+        // we must not truncate the source file if it has been linked to the destination file
+        tb_check_break(!xm_os_cpfile_is_same(src, dst));
+
+        // open the destination file
+        mode_t mode = st.st_mode & 0777;
+        if (is_writeable) {
+            mode |= S_IWUSR;
+        }
+        ofd = open(dst, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, mode | S_IWUSR);
+        if (ofd < 0 && errno == ENOENT && xm_os_cpfile_mkparent(dst)) {
+            ofd = open(dst, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, mode | S_IWUSR);
+        }
+        tb_check_break(ofd >= 0);
+
+        // try to clone it (reflink) first, it will share the data blocks on btrfs/xfs
+        if (ioctl(ofd, FICLONE, ifd) == 0) {
+            ok = tb_true;
+        }
+#ifdef __NR_copy_file_range
+        // try to copy it in the kernel, it may be server-side copy on nfs or clone on some filesystems
+        else {
+            tb_hize_t left = (tb_hize_t)st.st_size;
+            while (left) {
+                ssize_t real = (ssize_t)syscall(__NR_copy_file_range, ifd, tb_null, ofd, tb_null, (size_t)tb_min(left, (tb_hize_t)0x40000000), 0);
+                if (real <= 0) {
+                    break;
+                }
+                left -= (tb_hize_t)real;
+            }
+            // the file may be shorter than its reported size, we fallback to tb_file_copy() if the result is short
+            ok = !left;
+        }
+#endif
+        tb_check_break(ok);
+
+        // restore the file mode, because it may be masked by umask
+        fchmod(ofd, mode);
+
+    } while (0);
+
+    if (ifd >= 0) {
+        close(ifd);
+    }
+    if (ofd >= 0) {
+        close(ofd);
+    }
+    return ok;
+}
+#endif
 
 /* //////////////////////////////////////////////////////////////////////////////////////
  * implementation
@@ -58,6 +269,37 @@ tb_int_t xm_os_cpfile(lua_State *lua) {
         flags |= TB_FILE_COPY_IF_DIFFERENT;
     }
 
+    // get the copy strategy, e.g. auto, copy, hardlink, symlink
+    tb_size_t strategy = xm_os_cpfile_strategy(luaL_optstring(lua, 6, tb_null));
+
+    /* remove the old destination file first if it has been linked to the other file, e.g. the build cache
+     *
+     * we only remove the symlink or hardlink, the other destination files are still written through,
+     * and xm_os_cpfile_link() will replace the destination file if we use the hardlink/symlink strategy.
+     */
+    xm_os_cpfile_unlink(src, dst, tb_true);
+
+    // link it? we need not copy data for the readonly files, e.g. the build cache
+    if ((strategy == XM_OS_CPFILE_STRATEGY_HARDLINK || strategy == XM_OS_CPFILE_STRATEGY_SYMLINK) &&
+        !copy_if_different && !is_writeable) {
+        if (xm_os_cpfile_link(src, dst, strategy == XM_OS_CPFILE_STRATEGY_SYMLINK)) {
+            lua_pushboolean(lua, tb_true);
+            return 1;
+        }
+    }
+
+#if defined(TB_CONFIG_OS_LINUX)
+    // try to copy it in the kernel, symlinks and copy_if_different are still handled by tb_file_copy
+    if (strategy != XM_OS_CPFILE_STRATEGY_COPY && !copy_if_different) {
+        tb_file_info_t info;
+        if (!(is_symlink && tb_file_info(src, &info) && (info.flags & TB_FILE_FLAG_LINK)) &&
+            xm_os_cpfile_fast(src, dst, is_writeable)) {
+            lua_pushboolean(lua, tb_true);
+            return 1;
+        }
+    }
+#endif
+
     // do copy
     lua_pushboolean(lua, tb_file_copy(src, dst, flags));
     return 1;
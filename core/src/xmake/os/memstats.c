@@ -0,0 +1,95 @@
+/*!A cross-platform build utility based on Lua
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Copyright (C) 2015-present, Xmake Open Source Community.
+ *
+ * @author      ruki
+ * @file        memstats.c
+ *
+ */
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * trace
+ */
+#define TB_TRACE_MODULE_NAME "memstats"
+#define TB_TRACE_MODULE_DEBUG (0)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "prefix.h"
+#include "../engine_alloc.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * private implementation
+ */
+static tb_void_t xm_os_memstats_set(lua_State *lua, tb_char_t const *name, tb_size_t value) {
+    lua_pushstring(lua, name);
+    lua_pushinteger(lua, (lua_Integer)value);
+    lua_settable(lua, -3);
+}
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */
+
+/* get the memory stats of the lua state in the current engine
+ *
+ * local stats = os.memstats()
+ * => {allocator = "arena", live = 1024, peak = 2048, allocs = 10, frees = 2, large = 1, arena = 65536, classes = {[16] = 5, [32] = 4}}
+ *
+ * the allocator is "builtin" if we cannot use the custom allocator (e.g. luajit), and we only have the live bytes.
+ */
+tb_int_t xm_os_memstats(lua_State *lua) {
+    tb_assert_and_check_return_val(lua, 0);
+
+    tb_pointer_t udata = tb_null;
+    lua_Alloc allocf = lua_getallocf(lua, &udata);
+
+    lua_newtable(lua);
+    if (allocf == xm_engine_alloc_realloc && udata) {
+        xm_engine_alloc_stats_t stats;
+        xm_engine_alloc_stats((xm_engine_alloc_ref_t)udata, &stats);
+
+        lua_pushstring(lua, "allocator");
+        lua_pushstring(lua, stats.kind == XM_ENGINE_ALLOC_KIND_ARENA ? "arena" : "default");
+        lua_settable(lua, -3);
+        xm_os_memstats_set(lua, "live", stats.live);
+        xm_os_memstats_set(lua, "peak", stats.peak);
+        xm_os_memstats_set(lua, "allocs", stats.allocs);
+        xm_os_memstats_set(lua, "frees", stats.frees);
+        xm_os_memstats_set(lua, "large", stats.large);
+        xm_os_memstats_set(lua, "arena", stats.arena);
+
+        // the allocation counts of the size classes, e.g. {[16] = 100, [32] = 10}
+        lua_pushstring(lua, "classes");
+        lua_newtable(lua);
+        tb_size_t i;
+        for (i = 0; i < XM_ENGINE_ALLOC_CLASS_MAXN; i++) {
+            if (stats.classes[i]) {
+                lua_pushinteger(lua, (lua_Integer)((i + 1) * XM_ENGINE_ALLOC_CLASS_STEP));
+                lua_pushinteger(lua, (lua_Integer)stats.classes[i]);
+                lua_settable(lua, -3);
+            }
+        }
+        lua_settable(lua, -3);
+    } else {
+        tb_size_t live = (tb_size_t)lua_gc(lua, LUA_GCCOUNT, 0) * 1024 + (tb_size_t)lua_gc(lua, LUA_GCCOUNTB, 0);
+        lua_pushstring(lua, "allocator");
+        lua_pushstring(lua, "builtin");
+        lua_settable(lua, -3);
+        xm_os_memstats_set(lua, "live", live);
+    }
+    return 1;
+}
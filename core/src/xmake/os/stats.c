@@ -0,0 +1,185 @@
+/*!A cross-platform build utility based on Lua
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Copyright (C) 2015-present, Xmake Open Source Community.
+ *
+ * @author      ruki
+ * @file        stats.c
+ *
+ */
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * trace
+ */
+#define TB_TRACE_MODULE_NAME "stats"
+#define TB_TRACE_MODULE_DEBUG (0)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "prefix.h"
+#include "../utils/parallel.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+// the stat fields
+typedef enum __xm_os_stats_field_e {
+    XM_OS_STATS_FIELD_NONE  = 0,
+    XM_OS_STATS_FIELD_MTIME = 1,
+    XM_OS_STATS_FIELD_SIZE  = 2,
+    XM_OS_STATS_FIELD_TYPE  = 4,
+} xm_os_stats_field_e;
+
+// the path item
+typedef struct __xm_os_stats_item_t {
+    tb_char_t const *path;
+    tb_file_info_t   info;
+    tb_bool_t        ok;
+} xm_os_stats_item_t;
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * private implementation
+ */
+static tb_size_t xm_os_stats_field(tb_char_t const *name) {
+    if (!tb_strcmp(name, "mtime")) {
+        return XM_OS_STATS_FIELD_MTIME;
+    } else if (!tb_strcmp(name, "size")) {
+        return XM_OS_STATS_FIELD_SIZE;
+    } else if (!tb_strcmp(name, "type")) {
+        return XM_OS_STATS_FIELD_TYPE;
+    }
+    return XM_OS_STATS_FIELD_NONE;
+}
+
+static tb_void_t xm_os_stats_done(tb_size_t index, tb_pointer_t local, tb_cpointer_t priv) {
+    xm_os_stats_item_t *item = &((xm_os_stats_item_t *)priv)[index];
+    item->ok = tb_file_info(item->path, &item->info);
+}
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */
+
+/* get the stats of the given paths in parallel
+ *
+ * local stats = os._stats({"/tmp/a", "/tmp/b"}, {"mtime", "size", "type"}, 4)
+ *
+ * @return the parallel arrays, the mtime and size of the non-existent path are 0, and its type is false,
+ *         we only get the size of file like os.filesize(),
+ *         e.g. {mtime = {1712345678, 0}, size = {1024, 0}, type = {"file", false}}
+ */
+tb_int_t xm_os_stats(lua_State *lua) {
+    tb_assert_and_check_return_val(lua, 0);
+
+    // get paths and fields
+    tb_size_t i;
+    luaL_checktype(lua, 1, LUA_TTABLE);
+    tb_size_t fields = XM_OS_STATS_FIELD_NONE;
+    if (lua_istable(lua, 2)) {
+        tb_size_t fields_count = (tb_size_t)lua_objlen(lua, 2);
+        for (i = 0; i < fields_count; i++) {
+            lua_rawgeti(lua, 2, (tb_int_t)(i + 1));
+            tb_char_t const *name = lua_tostring(lua, -1);
+            tb_size_t field = name ? xm_os_stats_field(name) : XM_OS_STATS_FIELD_NONE;
+            lua_pop(lua, 1);
+            if (field == XM_OS_STATS_FIELD_NONE) {
+                lua_pushnil(lua);
+                lua_pushfstring(lua, "unknown stat field(%s)!", name ? name : "");
+                return 2;
+            }
+            fields |= field;
+        }
+    } else {
+        fields = XM_OS_STATS_FIELD_MTIME | XM_OS_STATS_FIELD_SIZE | XM_OS_STATS_FIELD_TYPE;
+    }
+
+    // get threads count, it's serial by default because stat is very fast on the local filesystem
+    tb_size_t count   = (tb_size_t)lua_objlen(lua, 1);
+    tb_long_t threads = (tb_long_t)luaL_optinteger(lua, 3, 1);
+
+    // init items, the paths are referenced by lua stack during stating
+    xm_os_stats_item_t *items = tb_null;
+    if (count) {
+        items = tb_nalloc0_type(count, xm_os_stats_item_t);
+        if (!items) {
+            lua_pushnil(lua);
+            lua_pushliteral(lua, "no memory!");
+            return 2;
+        }
+    }
+    for (i = 0; i < count; i++) {
+        lua_rawgeti(lua, 1, (tb_int_t)(i + 1));
+        items[i].path = lua_tostring(lua, -1);
+        lua_pop(lua, 1);
+        if (!items[i].path) {
+            tb_free(items);
+            lua_pushnil(lua);
+            lua_pushfstring(lua, "invalid path at index(%d)!", (tb_int_t)(i + 1));
+            return 2;
+        }
+    }
+
+    // stat paths in parallel
+    xm_parallel_task_t task;
+    tb_memset(&task, 0, sizeof(task));
+    task.count = count;
+    task.priv  = items;
+    task.done  = xm_os_stats_done;
+    xm_parallel_for(&task, threads > 0 ? (tb_size_t)threads : 1);
+
+    // save results
+    lua_newtable(lua);
+    if (fields & XM_OS_STATS_FIELD_MTIME) {
+        lua_pushliteral(lua, "mtime");
+        lua_createtable(lua, (tb_int_t)count, 0);
+        for (i = 0; i < count; i++) {
+            xm_os_stats_item_t *item = &items[i];
+            lua_pushinteger(lua, item->ok ? (lua_Integer)item->info.mtime : 0);
+            lua_rawseti(lua, -2, (tb_int_t)(i + 1));
+        }
+        lua_rawset(lua, -3);
+    }
+    if (fields & XM_OS_STATS_FIELD_SIZE) {
+        lua_pushliteral(lua, "size");
+        lua_createtable(lua, (tb_int_t)count, 0);
+        for (i = 0; i < count; i++) {
+            xm_os_stats_item_t *item = &items[i];
+            lua_pushinteger(lua, (item->ok && item->info.type == TB_FILE_TYPE_FILE) ? (lua_Integer)item->info.size : 0);
+            lua_rawseti(lua, -2, (tb_int_t)(i + 1));
+        }
+        lua_rawset(lua, -3);
+    }
+    if (fields & XM_OS_STATS_FIELD_TYPE) {
+        lua_pushliteral(lua, "type");
+        lua_createtable(lua, (tb_int_t)count, 0);
+        for (i = 0; i < count; i++) {
+            xm_os_stats_item_t *item = &items[i];
+            if (item->ok && item->info.type == TB_FILE_TYPE_DIRECTORY) {
+                lua_pushliteral(lua, "directory");
+            } else if (item->ok && item->info.type == TB_FILE_TYPE_FILE) {
+                lua_pushliteral(lua, "file");
+            } else {
+                lua_pushboolean(lua, tb_false);
+            }
+            lua_rawseti(lua, -2, (tb_int_t)(i + 1));
+        }
+        lua_rawset(lua, -3);
+    }
+    if (items) {
+        tb_free(items);
+    }
+    return 1;
+}
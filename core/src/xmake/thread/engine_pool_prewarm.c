@@ -0,0 +1,64 @@
+/*!A cross-platform build utility based on Lua
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Copyright (C) 2015-present, Xmake Open Source Community.
+ *
+ * @author      ruki
+ * @file        engine_pool_prewarm.c
+ *
+ */
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * trace
+ */
+#define TB_TRACE_MODULE_NAME "thread_engine_pool"
+#define TB_TRACE_MODULE_DEBUG (0)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "prefix.h"
+#include "../engine.h"
+#include "../engine_pool.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */
+
+/* prewarm the thread engines in background
+ *
+ * thread.engine_pool_prewarm(count, {"sandbox/sandbox", "base/json"})
+ */
+tb_int_t xm_thread_engine_pool_prewarm(lua_State *lua) {
+    tb_assert_and_check_return_val(lua, 0);
+
+    // get the engine count
+    tb_size_t count = (tb_size_t)luaL_checkinteger(lua, 1);
+
+    // get the preloaded modules
+    tb_size_t i = 0;
+    tb_char_t const *modules[XM_ENGINE_POOL_MODULES_MAXN + 1] = { tb_null };
+    if (lua_istable(lua, 2)) {
+        tb_size_t n = (tb_size_t)lua_objlen(lua, 2);
+        for (i = 0; i < n && i < XM_ENGINE_POOL_MODULES_MAXN; i++) {
+            lua_rawgeti(lua, 2, (tb_int_t)(i + 1));
+            modules[i] = lua_tostring(lua, -1);
+            lua_pop(lua, 1);
+        }
+    }
+
+    // the module strings are still referenced by the table, and the pool will copy them
+    lua_pushboolean(lua, xm_engine_pool_prewarm(xm_engine_pool(), count, i ? modules : tb_null));
+    return 1;
+}
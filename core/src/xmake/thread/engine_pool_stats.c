@@ -0,0 +1,67 @@
+/*!A cross-platform build utility based on Lua
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Copyright (C) 2015-present, Xmake Open Source Community.
+ *
+ * @author      ruki
+ * @file        engine_pool_stats.c
+ *
+ */
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * trace
+ */
+#define TB_TRACE_MODULE_NAME "thread_engine_pool"
+#define TB_TRACE_MODULE_DEBUG (0)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "prefix.h"
+#include "../engine.h"
+#include "../engine_pool.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */
+
+/* get the thread engine pool stats
+ *
+ * local stats = thread.engine_pool_stats()
+ * => {hits = 10, misses = 2, drops = 0, prewarmed = 2, idle = 2}
+ */
+tb_int_t xm_thread_engine_pool_stats(lua_State *lua) {
+    tb_assert_and_check_return_val(lua, 0);
+
+    xm_engine_pool_stats_t stats = { 0 };
+    xm_engine_pool_stats(xm_engine_pool(), &stats);
+
+    lua_newtable(lua);
+    lua_pushliteral(lua, "hits");
+    lua_pushinteger(lua, (lua_Integer)stats.hits);
+    lua_settable(lua, -3);
+    lua_pushliteral(lua, "misses");
+    lua_pushinteger(lua, (lua_Integer)stats.misses);
+    lua_settable(lua, -3);
+    lua_pushliteral(lua, "drops");
+    lua_pushinteger(lua, (lua_Integer)stats.drops);
+    lua_settable(lua, -3);
+    lua_pushliteral(lua, "prewarmed");
+    lua_pushinteger(lua, (lua_Integer)stats.prewarmed);
+    lua_settable(lua, -3);
+    lua_pushliteral(lua, "idle");
+    lua_pushinteger(lua, (lua_Integer)stats.idle);
+    lua_settable(lua, -3);
+    return 1;
+}
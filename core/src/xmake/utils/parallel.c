@@ -0,0 +1,199 @@
+/*!A cross-platform build utility based on Lua
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Copyright (C) 2015-present, Xmake Open Source Community.
+ *
+ * @author      ruki
+ * @file        parallel.c
+ *
+ */
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * trace
+ */
+#define TB_TRACE_MODULE_NAME "parallel"
+#define TB_TRACE_MODULE_DEBUG (0)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "parallel.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// the singleton type of parallel workers
+#define XM_PARALLEL (TB_SINGLETON_TYPE_USER + 5)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+// the parallel workers type
+typedef struct __xm_parallel_t {
+    // the worker threads, they are created on demand and only exited at exit
+    tb_thread_ref_t threads[XM_PARALLEL_THREADS_MAXN];
+    tb_size_t threads_count;
+
+    // only one task is running at the same time
+    tb_mutex_ref_t lock;
+
+    // wake up the workers to do the current task
+    tb_semaphore_ref_t wakeup;
+
+    // it will be posted after all woken workers have done the current task
+    tb_event_ref_t done;
+
+    // the current task
+    xm_parallel_task_t const *task;
+
+    // the next item index of the current task
+    tb_atomic_t next;
+
+    // the count of the woken workers which are still doing the current task
+    tb_atomic_t pending;
+
+    // is stopped?
+    tb_atomic_t stopped;
+
+} xm_parallel_t;
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * private implementation
+ */
+static tb_void_t xm_parallel_task_done(xm_parallel_task_t const *task, tb_atomic_t *next) {
+    tb_pointer_t local = task->local_init ? task->local_init(task->priv) : tb_null;
+    if (!task->local_init || local) {
+        while (1) {
+            tb_size_t index = (tb_size_t)tb_atomic_fetch_and_add(next, 1);
+            tb_check_break(index < task->count);
+            task->done(index, local, task->priv);
+        }
+    }
+    if (local && task->local_exit) {
+        task->local_exit(local, task->priv);
+    }
+}
+static tb_int_t xm_parallel_worker(tb_cpointer_t priv) {
+    xm_parallel_t *parallel = (xm_parallel_t *)priv;
+    tb_assert_and_check_return_val(parallel, -1);
+
+    while (tb_semaphore_wait(parallel->wakeup, -1) > 0 && !tb_atomic_get(&parallel->stopped)) {
+        xm_parallel_task_done(parallel->task, &parallel->next);
+        if (tb_atomic_fetch_and_sub(&parallel->pending, 1) == 1) {
+            tb_event_post(parallel->done);
+        }
+    }
+    return 0;
+}
+static tb_handle_t xm_parallel_instance_init(tb_cpointer_t *ppriv) {
+    tb_bool_t ok = tb_false;
+    xm_parallel_t *parallel = tb_null;
+    do {
+        parallel = tb_malloc0_type(xm_parallel_t);
+        tb_assert_and_check_break(parallel);
+
+        parallel->lock = tb_mutex_init();
+        parallel->wakeup = tb_semaphore_init(0);
+        parallel->done = tb_event_init();
+        tb_assert_and_check_break(parallel->lock && parallel->wakeup && parallel->done);
+
+        ok = tb_true;
+    } while (0);
+
+    if (!ok && parallel) {
+        if (parallel->lock) {
+            tb_mutex_exit(parallel->lock);
+        }
+        if (parallel->wakeup) {
+            tb_semaphore_exit(parallel->wakeup);
+        }
+        if (parallel->done) {
+            tb_event_exit(parallel->done);
+        }
+        tb_free(parallel);
+        parallel = tb_null;
+    }
+    return (tb_handle_t)parallel;
+}
+static tb_void_t xm_parallel_instance_exit(tb_handle_t handle, tb_cpointer_t priv) {
+    xm_parallel_t *parallel = (xm_parallel_t *)handle;
+    tb_assert_and_check_return(parallel);
+
+    // stop and wait all workers
+    tb_size_t i;
+    tb_atomic_set(&parallel->stopped, 1);
+    if (parallel->threads_count) {
+        tb_semaphore_post(parallel->wakeup, parallel->threads_count);
+    }
+    for (i = 0; i < parallel->threads_count; i++) {
+        tb_thread_wait(parallel->threads[i], -1, tb_null);
+        tb_thread_exit(parallel->threads[i]);
+    }
+    tb_mutex_exit(parallel->lock);
+    tb_semaphore_exit(parallel->wakeup);
+    tb_event_exit(parallel->done);
+    tb_free(parallel);
+}
+static xm_parallel_t *xm_parallel() {
+    return (xm_parallel_t *)tb_singleton_instance(
+        XM_PARALLEL, xm_parallel_instance_init, xm_parallel_instance_exit, tb_null, tb_null);
+}
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */
+tb_void_t xm_parallel_for(xm_parallel_task_t const *task, tb_size_t threads) {
+    tb_assert_and_check_return(task && task->done);
+
+    // get the threads count
+    tb_atomic_t next;
+    tb_atomic_init(&next, 0);
+    if (!threads) {
+        threads = tb_cpu_count();
+    }
+    threads = tb_min(threads, XM_PARALLEL_THREADS_MAXN);
+    threads = tb_min(threads, task->count);
+
+    // do it serially if we need not more threads or other task is running, e.g. it's called in the other native thread
+    xm_parallel_t *parallel = threads > 1 ? xm_parallel() : tb_null;
+    if (!parallel || !tb_mutex_enter_try(parallel->lock)) {
+        xm_parallel_task_done(task, &next);
+        return;
+    }
+
+    // create more workers on demand
+    tb_size_t i;
+    for (i = parallel->threads_count; i + 1 < threads; i++) {
+        tb_thread_ref_t thread = tb_thread_init("parallel", xm_parallel_worker, parallel, 0);
+        tb_check_break(thread);
+        parallel->threads[parallel->threads_count++] = thread;
+    }
+
+    // wake up workers and do the task with them
+    tb_size_t workers = tb_min(threads - 1, parallel->threads_count);
+    parallel->task = task;
+    tb_atomic_set(&parallel->next, 0);
+    tb_atomic_set(&parallel->pending, (tb_long_t)workers);
+    if (workers) {
+        tb_semaphore_post(parallel->wakeup, workers);
+    }
+    xm_parallel_task_done(task, &parallel->next);
+    if (workers) {
+        tb_event_wait(parallel->done, -1);
+    }
+    parallel->task = tb_null;
+    tb_mutex_leave(parallel->lock);
+}
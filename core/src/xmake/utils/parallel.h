@@ -0,0 +1,73 @@
+/*!A cross-platform build utility based on Lua
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Copyright (C) 2015-present, Xmake Open Source Community.
+ *
+ * @author      ruki
+ * @file        parallel.h
+ *
+ */
+#ifndef XM_UTILS_PARALLEL_H
+#define XM_UTILS_PARALLEL_H
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "prefix.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// the max count of the parallel threads, including the current thread
+#define XM_PARALLEL_THREADS_MAXN (64)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+// the parallel task type
+typedef struct __xm_parallel_task_t {
+    // the items count
+    tb_size_t count;
+
+    // the private data
+    tb_cpointer_t priv;
+
+    // do the item at the given index, the local data is owned by the current thread
+    tb_void_t (*done)(tb_size_t index, tb_pointer_t local, tb_cpointer_t priv);
+
+    // init the local data of the current thread, e.g. the read buffer, it's optional
+    tb_pointer_t (*local_init)(tb_cpointer_t priv);
+
+    // exit the local data of the current thread, it's optional
+    tb_void_t (*local_exit)(tb_pointer_t local, tb_cpointer_t priv);
+
+} xm_parallel_task_t;
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * interfaces
+ */
+
+/* do all items of the given task in parallel and wait them
+ *
+ * the worker threads are shared and reused by all tasks, we need not create them for each call.
+ * the current thread also does items, and the task will be done serially if other task is running.
+ *
+ * @param task      the task
+ * @param threads   the max threads count, including the current thread, it will use the cpu count if it's 0
+ */
+tb_void_t xm_parallel_for(xm_parallel_task_t const *task, tb_size_t threads);
+
+#endif
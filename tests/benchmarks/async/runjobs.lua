@@ -24,10 +24,36 @@ function test_run_proc(total, comax)
     print("runjobs_proc(%d/%d): %d ms", total, comax, t1)
 end
 
+-- measure the process spawns per second with the given heap size (mb)
+--
+-- we allocate some memory to increase the rss of xmake process first, the fork path will become slower
+-- if there is a large heap, but posix_spawn/vfork need not copy the page tables.
+function test_run_proc_heap(total, comax, heapsize, opt)
+    opt = opt or {}
+    local ballast = {}
+    local block = string.rep("x", 1024 * 1024 - 64)
+    for i = 1, heapsize do
+        ballast[i] = block .. tostring(i)
+    end
+    local curdir = opt.curdir and os.tmpdir() or nil
+    local f = function () os.runv(os.programfile(), {"--version"}, {curdir = curdir}) end
+    local t = os.mclock()
+    runjobs("test", f, {total = total, comax = comax})
+    t = os.mclock() - t
+    print("runjobs_proc(%d/%d, heap: %dmb%s): %d ms, %.1f spawns/s", total, comax, heapsize,
+        curdir and ", curdir" or "", t, total * 1000 / math.max(t, 1))
+    ballast = nil
+    collectgarbage()
+end
+
 function main()
     test_run(10000, 1)
     test_run(10000, 10)
     test_run(10000, 100)
     test_run_proc(1000, 10)
+    for _, heapsize in ipairs({0, 256, 1024}) do
+        test_run_proc_heap(1000, 10, heapsize)
+        test_run_proc_heap(1000, 10, heapsize, {curdir = true})
+    end
 end
 
@@ -0,0 +1,61 @@
+import("core.base.bytes")
+import("core.base.socket")
+import("core.base.scheduler")
+import("private.service.stream", {alias = "socket_stream"})
+
+local PORT = 9092
+
+function _server(sock, count)
+    local sock_client = sock:accept()
+    if sock_client then
+        local stream = socket_stream(sock_client)
+        for i = 1, count do
+            if not stream:recv_data() then
+                break
+            end
+        end
+        sock_client:close()
+    end
+end
+
+function _client(count, data)
+    local sock = socket.connect("127.0.0.1", PORT)
+    if sock then
+        local stream = socket_stream(sock)
+        for i = 1, count do
+            if not stream:send_data(data) then
+                break
+            end
+        end
+        stream:flush()
+        sock:close()
+    end
+end
+
+-- measure the throughput of the service stream over loopback
+--
+-- the small messages are batched in the stream caches, and the large messages bypass them,
+-- so we can compare the syscall cost of both paths of private.service.stream.
+--
+function test_stream(count, size)
+    local data = bytes(string.rep("x", size))
+    local sock = socket.bind("127.0.0.1", PORT)
+    sock:listen(100)
+    local t = os.mclock()
+    scheduler.co_group_begin("test", function ()
+        scheduler.co_start(_server, sock, count)
+        scheduler.co_start(_client, count, data)
+    end)
+    scheduler.co_group_wait("test")
+    t = os.mclock() - t
+    sock:close()
+    print("stream(%d x %d bytes): %d ms, %.1f msgs/s, %.1f mb/s", count, size, t,
+        count * 1000 / math.max(t, 1), count * size * 1000 / math.max(t, 1) / (1024 * 1024))
+end
+
+function main()
+    test_stream(100000, 16)
+    test_stream(10000, 4096)
+    test_stream(1000, 65536)
+    test_stream(100, 4 * 1024 * 1024)
+end
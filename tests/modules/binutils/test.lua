@@ -305,3 +305,61 @@ function test_readsyms(t)
 
     os.tryrm(tempdir)
 end
+
+function test_armembers(t)
+    local tempdir = "temp/binutils_armembers"
+    os.tryrm(tempdir)
+    os.mkdir(tempdir)
+
+    local function _pad(str, n)
+        if #str < n then
+            return str .. string.rep(" ", n - #str)
+        end
+        return str:sub(1, n)
+    end
+    local function _ar_header(name, size)
+        return _pad(name, 16) ..
+               _pad("0", 12) ..
+               _pad("0", 6) ..
+               _pad("0", 6) ..
+               _pad("644", 8) ..
+               _pad(tostring(size), 10) ..
+               "`\n"
+    end
+    local function _ar_member(name, data)
+        return _ar_header(name, #data) .. data .. ((#data % 2 == 1) and "\n" or "")
+    end
+
+    -- gnu ar with symbol table and long names table
+    local longnames = "a_very_long_object_file_name.cpp.o/\n"
+    local arfile = path.join(tempdir, "libfoo.a")
+    io.writefile(arfile, "!<arch>\n" ..
+        _ar_member("/", string.char(0x00, 0x00, 0x00, 0x00)) ..
+        _ar_member("//", longnames) ..
+        _ar_member("foo.cpp.o/", "12345") ..
+        _ar_member("/0", "123456"), {encoding = "binary"})
+    local members = binutils.armembers(arfile)
+    t:are_equal(#members, 2)
+    t:are_equal(members[1].name, "foo.cpp.o")
+    t:are_equal(members[1].size, 5)
+    t:are_equal(members[2].name, "a_very_long_object_file_name.cpp.o")
+    t:are_equal(members[2].size, 6)
+
+    -- thin archive, the member data is not stored in archive
+    local thinfile = path.join(tempdir, "libthin.a")
+    local thinnames = "build/foo.cpp.o/\n"
+    io.writefile(thinfile, "!<thin>\n" ..
+        _ar_member("//", thinnames) ..
+        _ar_header("/0", 1024), {encoding = "binary"})
+    members = binutils.armembers(thinfile)
+    t:are_equal(#members, 1)
+    t:are_equal(members[1].name, "build/foo.cpp.o")
+    t:are_equal(members[1].size, 1024)
+
+    -- invalid archive
+    local badfile = path.join(tempdir, "libbad.a")
+    io.writefile(badfile, "12345678")
+    t:require(not try { function () return binutils.armembers(badfile) end })
+
+    os.tryrm(tempdir)
+end
@@ -22,3 +22,31 @@ function test_bloom_filter(t)
     t:are_equal(filter2:get("not exists"), false)
 end
 
+
+function test_bloom_filter_legacy(t)
+    local filter = bloom_filter.new({version = bloom_filter.VERSION_LEGACY})
+    t:are_equal(filter:set("hello"), true)
+    t:are_equal(filter:get("hello"), true)
+
+    -- the new filter can still load the legacy data
+    local filter2 = bloom_filter.new()
+    filter2:data_set(filter:data())
+    t:are_equal(filter2:get("hello"), true)
+    t:are_equal(filter2:get("not exists"), false)
+end
+
+function test_bloom_filter_delta(t)
+    local filter = bloom_filter.new()
+    filter:set("hello")
+    local filter2 = bloom_filter.new()
+    filter2:merge(filter:data())
+    t:are_equal(filter2:get("hello"), true)
+
+    -- only merge the changed blocks
+    filter:delta()
+    filter:set("xmake")
+    filter2:merge(filter:delta())
+    t:are_equal(filter2:get("hello"), true)
+    t:are_equal(filter2:get("xmake"), true)
+    t:are_equal(filter2:get("not exists"), false)
+end
@@ -1,6 +1,7 @@
 import("core.cache.memcache")
 import("core.cache.localcache")
 import("core.cache.globalcache")
+import("core.cache.fingerprintcache")
 
 function test_memcache(t)
     memcache.set("mycache", "xyz", {1, 2, 3})
@@ -40,3 +41,48 @@ function test_globalcache(t)
     t:are_equal(globalcache.get("mycache", "xyz"), nil)
     t:are_equal(globalcache.get2("mycache", "foo", "bar"), nil)
 end
+
+function test_fingerprintcache(t)
+    local tmpdir = path.join(os.tmpdir(), "test_fingerprintcache")
+    local programfile = path.join(tmpdir, "bin", "foo")
+    os.tryrm(tmpdir)
+    os.mkdir(path.directory(programfile))
+    io.writefile(programfile, "1.0")
+
+    -- the results of the different programs are isolated
+    fingerprintcache.clear()
+    fingerprintcache.set(programfile, "version", "1.0")
+    t:are_equal(fingerprintcache.get(programfile, "version"), "1.0")
+    t:are_equal(fingerprintcache.get(path.join(tmpdir, "bin", "bar"), "version"), nil)
+    t:require(fingerprintcache.fingerprint(programfile))
+
+    -- the results are discarded after the program file is changed (size)
+    -- @note we reset the loaded infos to simulate a new process
+    fingerprintcache._INFOS = nil
+    io.writefile(programfile, "1.0.1")
+    t:are_equal(fingerprintcache.get(programfile, "version"), nil)
+    fingerprintcache.set(programfile, "version", "1.0.1")
+
+    -- the results are discarded after the program file is changed (mtime)
+    fingerprintcache._INFOS = nil
+    os.touch(programfile, {mtime = os.time() + 10})
+    t:are_equal(fingerprintcache.get(programfile, "version"), nil)
+    fingerprintcache.set(programfile, "version", "1.0.1")
+
+    -- the program is found from PATH, and the symlinks are resolved
+    if not is_host("windows") then
+        os.vrunv("chmod", {"+x", programfile})
+        os.mkdir(path.join(tmpdir, "link"))
+        os.ln(programfile, path.join(tmpdir, "link", "foo-link"))
+        local oldenv = os.getenv("PATH")
+        os.addenv("PATH", path.join(tmpdir, "link"))
+        t:are_equal(fingerprintcache.get("foo-link", "version"), "1.0.1")
+        t:are_equal(fingerprintcache.fingerprint("foo-link"), fingerprintcache.fingerprint(programfile))
+        os.setenv("PATH", oldenv)
+    end
+
+    -- clear all results
+    fingerprintcache.clear()
+    t:are_equal(fingerprintcache.get(programfile, "version"), nil)
+    os.tryrm(tmpdir)
+end
@@ -12,3 +12,36 @@ function test_lz4(t)
     t:are_equal(io.readfile(srcfile), io.readfile(dstfile2))
 end
 
+
+function test_lz4_batch(t)
+    local blocks = {"hello world", string.rep("xmake", 1024), "123"}
+    local results = lz4.block_decompress_batch(lz4.block_compress_batch(blocks), {11, 5120, 3}, {threads = 2})
+    t:are_equal(results, blocks)
+end
+
+function test_xmz(t)
+    import("utils.archive.archive_xmz")
+    import("utils.archive.extract_xmz")
+    local tmpdir = os.tmpfile() .. ".dir"
+    local srcdir = path.join(tmpdir, "src")
+    io.writefile(path.join(srcdir, "a.txt"), "hello world")
+    io.writefile(path.join(srcdir, "sub", "b.txt"), string.rep("xmake", 100000))
+    io.writefile(path.join(srcdir, "empty.txt"), "")
+    local archivefile = path.join(tmpdir, "test.xmz")
+    archive_xmz(archivefile, {srcdir}, {recurse = true, curdir = srcdir, blocksize = 65536})
+
+    local files = extract_xmz.list(archivefile)
+    t:are_equal(#files, 3)
+
+    local outputdir = path.join(tmpdir, "out")
+    extract_xmz(archivefile, outputdir)
+    t:are_equal(io.readfile(path.join(outputdir, "a.txt")), "hello world")
+    t:are_equal(io.readfile(path.join(outputdir, "sub", "b.txt")), string.rep("xmake", 100000))
+    t:are_equal(io.readfile(path.join(outputdir, "empty.txt")), "")
+
+    local outputdir2 = path.join(tmpdir, "out2")
+    extract_xmz(archivefile, outputdir2, {files = "sub/b.txt"})
+    t:require(os.isfile(path.join(outputdir2, "sub", "b.txt")))
+    t:require_not(os.isfile(path.join(outputdir2, "a.txt")))
+    os.tryrm(tmpdir)
+end
@@ -25,3 +25,40 @@ function test_rand128(t)
     end
 end
 
+
+function test_files(t)
+    local tmpdir = os.tmpfile() .. ".dir"
+    local files = {}
+    for i = 1, 16 do
+        local filepath = path.join(tmpdir, "file" .. i .. ".txt")
+        io.writefile(filepath, string.rep("xmake" .. i, i * 1024))
+        table.insert(files, filepath)
+    end
+    local missing = path.join(tmpdir, "missing.txt")
+    table.insert(files, missing)
+    local digests = hash.files(files)
+    for i = 1, 16 do
+        t:are_equal(digests[files[i]], hash.xxhash128(files[i]))
+    end
+    t:are_equal(digests[missing], false)
+    digests = hash.files(files, {algo = "sha256", threads = 4})
+    for i = 1, 16 do
+        t:are_equal(digests[files[i]], hash.sha256(files[i]))
+    end
+    os.tryrm(tmpdir)
+end
+
+function test_xxhash128_prefixmap(t)
+    local tmpdir = os.tmpfile() .. ".dir"
+    local file1 = path.join(tmpdir, "foo1.i")
+    local file2 = path.join(tmpdir, "foo2.i")
+    io.writefile(file1, '# 1 "/ws/job1/src/foo.c"\n# 1 "/ws/job1/src/foo.h" 1\nint foo = 1; /* /ws/job1 */\n')
+    io.writefile(file2, '# 1 "/ws/job2/src/foo.c"\n# 1 "/ws/job2/src/foo.h" 1\nint foo = 1; /* /ws/job1 */\n')
+    t:require(hash.xxhash128(file1) ~= hash.xxhash128(file2))
+    t:are_equal(hash.xxhash128(file1, {prefixmap = {"/ws/job1", "."}}),
+                hash.xxhash128(file2, {prefixmap = {"/ws/job2", "."}}))
+    -- only the line markers are mapped
+    io.writefile(file2, '# 1 "/ws/job2/src/foo.c"\n# 1 "/ws/job2/src/foo.h" 1\nint foo = 1; /* /ws/job2 */\n')
+    t:require(hash.xxhash128(file1, {prefixmap = {"/ws/job1", "."}}) ~= hash.xxhash128(file2, {prefixmap = {"/ws/job2", "."}}))
+    os.tryrm(tmpdir)
+end
@@ -86,6 +86,33 @@ function test_cp_symlink(t)
     t:require(not os.exists("dir"))
 end
 
+function test_cp_strategy(t)
+    io.writefile("test1", "hello xmake")
+    for _, strategy in ipairs({"auto", "copy", "hardlink", "symlink"}) do
+        local dstfile = "test_" .. strategy
+        os.cp("test1", dstfile, {strategy = strategy})
+        t:require(os.isfile(dstfile))
+        t:are_equal(io.readfile(dstfile), "hello xmake")
+        -- copy it again to overwrite the existing file or link
+        os.cp("test1", dstfile, {strategy = strategy})
+        t:are_equal(io.readfile(dstfile), "hello xmake")
+        if strategy == "symlink" and not is_host("windows") then
+            t:require(os.islink(dstfile))
+        elseif strategy ~= "symlink" then
+            t:require(not os.islink(dstfile))
+        end
+        -- copy the other file to the linked file, it must not overwrite the source file
+        io.writefile("test2", "hello world")
+        os.cp("test2", dstfile)
+        t:are_equal(io.readfile(dstfile), "hello world")
+        t:are_equal(io.readfile("test1"), "hello xmake")
+        os.tryrm(dstfile)
+    end
+    os.tryrm("test1")
+    os.tryrm("test2")
+    t:require(not os.exists("test1"))
+end
+
 function test_setenv(t)
     -- get mclock
     local tm = os.mclock()
@@ -208,3 +235,89 @@ function test_isexec(t)
 
     os.tryrm(tempdir)
 end
+
+function test_stats(t)
+    local tempdir = "temp/stats"
+    os.tryrm(tempdir)
+    os.mkdir(tempdir)
+    local filepath = path.join(tempdir, "file")
+    local dirpath = path.join(tempdir, "dir")
+    local missing = path.join(tempdir, "missing")
+    io.writefile(filepath, "12345")
+    os.mkdir(dirpath)
+    local paths = {filepath, dirpath, missing}
+
+    -- get all fields
+    local stats = os.stats(paths)
+    t:are_equal(stats.mtime[1], os.mtime(filepath))
+    t:are_equal(stats.mtime[3], 0)
+    t:are_equal(stats.size, {5, 0, 0})
+    t:are_equal(stats.type, {"file", "directory", false})
+
+    -- only get the given fields
+    stats = os.stats(paths, {fields = {"mtime"}})
+    t:are_equal(stats.mtime[1], os.mtime(filepath))
+    t:are_equal(stats.mtime[2], os.mtime(dirpath))
+    t:are_equal(stats.mtime[3], 0)
+    t:are_equal(stats.size, nil)
+    t:are_equal(stats.type, nil)
+
+    -- stat them in the worker threads
+    stats = os.stats(paths, {fields = {"size", "type"}, threads = 4})
+    t:are_equal(stats.size, {5, 0, 0})
+    t:are_equal(stats.type, {"file", "directory", false})
+    t:are_equal(os.stats({}).mtime, {})
+
+    os.tryrm(tempdir)
+end
+
+-- run the given script in a child xmake process and get its output and error data
+function _iorunv_script(script)
+    local scriptfile = os.tmpfile() .. ".lua"
+    io.writefile(scriptfile, "function main()\n" .. script .. "\nend\n")
+    local outdata, errdata = os.iorunv(os.programfile(), {"l", scriptfile})
+    os.tryrm(scriptfile)
+    return outdata, errdata
+end
+
+-- get the same data as reading the given binary data from file in text mode
+function _readfile_text(data)
+    local filepath = os.tmpfile()
+    local file = io.open(filepath, "wb")
+    file:write(data)
+    file:close()
+    data = io.readfile(filepath)
+    os.tryrm(filepath)
+    return data
+end
+
+function test_iorunv_stderr(t)
+    local outdata, errdata = _iorunv_script([[io.write("out") io.stderr:write("err")]])
+    t:are_equal(outdata, "out")
+    t:are_equal(errdata, "err")
+end
+
+function test_iorunv_largedata(t)
+    -- the output larger than 4mb will be written to the temporary file
+    local outdata, errdata = _iorunv_script([[io.write(string.rep("0123456789abcdef", 5 * 65536))]])
+    t:are_equal(#outdata, 5 * 1024 * 1024)
+    t:require(outdata:startswith("0123456789abcdef") and outdata:endswith("0123456789abcdef"))
+    t:are_equal(errdata, "")
+end
+
+function test_iorunv_crlf(t)
+    if is_host("windows") then
+        return
+    end
+    local outdata = _iorunv_script([[io.write("foo\r\nbar\r\n")]])
+    t:are_equal(outdata, _readfile_text("foo\r\nbar\r\n"))
+    t:are_equal(outdata, "foo\nbar\n")
+end
+
+function test_iorunv_textmode(t)
+    -- the data with bom or nul characters will be read from the temporary file in text mode
+    local outdata = _iorunv_script([[io.write("\239\187\191foo")]])
+    t:are_equal(outdata, _readfile_text("\239\187\191foo"))
+    outdata = _iorunv_script([[io.write("f\0o\0o\0")]])
+    t:are_equal(outdata, _readfile_text("f\0o\0o\0"))
+end
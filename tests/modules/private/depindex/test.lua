@@ -0,0 +1,90 @@
+import("core.base.hashset")
+import("private.action.build.depindex")
+
+function _new_target(name, kind, deps, pcheaderfile)
+    local target = {}
+    deps = deps or {}
+    function target:name() return name end
+    function target:fullname() return name end
+    function target:get(key) return key == "deps" and table.imap(deps, function (_, dep) return dep:name() end) or nil end
+    function target:dep(depname)
+        for _, dep in ipairs(deps) do
+            if dep:name() == depname then
+                return dep
+            end
+        end
+    end
+    function target:orderdeps()
+        local orderdeps = {}
+        for _, dep in ipairs(deps) do
+            table.join2(orderdeps, dep:orderdeps())
+            table.insert(orderdeps, dep)
+        end
+        return table.unique(orderdeps)
+    end
+    function target:is_enabled() return true end
+    function target:is_object() return kind == "object" end
+    function target:is_binary() return kind == "binary" end
+    function target:is_static() return kind == "static" end
+    function target:is_shared() return kind == "shared" end
+    function target:sourcebatches()
+        return {["c.build"] = {rulename = "c.build",
+            sourcefiles = {"src/" .. name .. ".c"},
+            objectfiles = {"build/.objs/" .. name .. "/src/" .. name .. ".c.o"}}}
+    end
+    function target:pcheaderfile(langkind) return langkind == "cxx" and pcheaderfile or nil end
+    function target:pcoutputfile(langkind) return "build/.objs/" .. name .. "/cxx/" .. path.filename(pcheaderfile) .. ".gch" end
+    function target:dependfile(objectfile) return objectfile .. ".d" end
+    return target
+end
+
+function _link_targets(targets, dirty_targets)
+    local names = table.keys(depindex.link_targets(targets, hashset.from(dirty_targets)))
+    table.sort(names)
+    return names
+end
+
+function test_link_targets(t)
+    local foo = _new_target("foo", "static")
+    local bar = _new_target("bar", "shared")
+    local app = _new_target("app", "binary", {foo, bar})
+    local targets = {foo, bar, app}
+    t:are_equal(_link_targets(targets, {"foo"}), {"app", "foo"})
+    t:are_equal(_link_targets(targets, {"app"}), {"app"})
+end
+
+function test_link_targets_objectdeps(t)
+    local obj1 = _new_target("obj1", "object")
+    local obj2 = _new_target("obj2", "object", {obj1})
+    local foo = _new_target("foo", "static", {obj2})
+    local app = _new_target("app", "binary", {foo})
+    local targets = {obj1, obj2, foo, app}
+    t:are_equal(_link_targets(targets, {"obj2"}), {"app", "foo"})
+    t:are_equal(_link_targets(targets, {"obj1"}), {"app", "foo"})
+    t:are_equal(_link_targets(targets, {"app"}), {"app"})
+end
+
+function test_link_targets_headeronly(t)
+    local inc = _new_target("inc", "headeronly")
+    local app = _new_target("app", "binary", {inc})
+    t:are_equal(_link_targets({inc, app}, {"inc"}), {})
+end
+
+function test_dirty_objects(t)
+    local foo = _new_target("foo", "static")
+    local index = depindex.new({foo})
+    t:require(depindex.has_file(index, "src/foo.c"))
+    t:require_not(depindex.has_file(index, "src/bar.c"))
+    local objects = depindex.dirty_objects(index, {"src/foo.c", "src/bar.c"})
+    t:are_equal(#objects, 1)
+    t:are_equal(objects[1].objectfile, "build/.objs/foo/src/foo.c.o")
+end
+
+function test_dirty_objects_pcheader(t)
+    local foo = _new_target("foo", "static", nil, "src/foo_pch.h")
+    local index = depindex.new({foo})
+    t:require(depindex.has_file(index, "src/foo_pch.h"))
+    local objects = depindex.dirty_objects(index, {"src/foo_pch.h"})
+    t:are_equal(#objects, 1)
+    t:require(objects[1].pcheader)
+end
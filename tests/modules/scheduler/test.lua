@@ -31,6 +31,22 @@ function test_sleep(t)
     end
 end
 
+function test_sleep_order(t)
+
+    local wakeups = {}
+    local task = function (ms)
+        scheduler.co_sleep(ms)
+        table.insert(wakeups, ms)
+    end
+    scheduler.co_group_begin("test", function ()
+        for _, ms in ipairs({300, 10, 700, 1, 100, 50}) do
+            scheduler.co_start(task, ms)
+        end
+    end)
+    scheduler.co_group_wait("test")
+    t:are_equal(table.concat(wakeups, ","), "1,10,50,100,300,700")
+end
+
 function test_yield(t)
 
     local count = 0
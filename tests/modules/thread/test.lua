@@ -0,0 +1,44 @@
+import("core.base.thread")
+
+function _callback()
+end
+
+-- wait for the prewarmed engines in the background thread
+function _wait_prewarmed(count)
+    local stats
+    for i = 1, 100 do
+        stats = thread.pool_stats()
+        if stats.prewarmed >= count then
+            break
+        end
+        os.sleep(100)
+    end
+    return stats
+end
+
+function test_pool_stats(t)
+    local stats = thread.pool_stats()
+    for _, name in ipairs({"hits", "misses", "drops", "prewarmed", "idle"}) do
+        t:require(type(stats[name]) == "number" and stats[name] >= 0)
+    end
+end
+
+function test_prewarm(t)
+    local prewarmed = thread.prewarm(2, {modules = {"base/json"}})
+
+    -- we can only prewarm it once
+    t:require_not(thread.prewarm(2))
+    if not prewarmed then
+        return
+    end
+
+    local stats = _wait_prewarmed(2)
+    t:are_equal(stats.prewarmed, 2)
+    t:require(stats.idle >= 1)
+
+    -- the new thread will reuse the prewarmed engine
+    local th = thread.start(_callback)
+    th:wait(-1)
+    local stats2 = thread.pool_stats()
+    t:require(stats2.hits > stats.hits)
+end
@@ -0,0 +1,8 @@
+#include <iostream>
+
+int add(int a, int b);
+
+int main(int argc, char** argv) {
+    std::cout << "add(1, 2) = " << add(1, 2) << std::endl;
+    return 0;
+}
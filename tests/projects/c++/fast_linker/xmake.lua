@@ -0,0 +1,12 @@
+add_rules("mode.debug", "mode.release")
+
+set_policy("build.linker.fast", true)
+
+target("foo")
+    set_kind("shared")
+    add_files("src/foo.cpp")
+
+target("test")
+    set_kind("binary")
+    add_deps("foo")
+    add_files("src/main.cpp")
@@ -0,0 +1,6 @@
+#include <vector>
+
+int foo(int n) {
+    std::vector<int> v(n, 2);
+    return v.empty() ? 0 : v[0] * n;
+}
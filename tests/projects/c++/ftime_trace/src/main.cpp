@@ -0,0 +1,5 @@
+int foo(int n);
+
+int main(int argc, char** argv) {
+    return foo(argc) > 0 ? 0 : 1;
+}
@@ -0,0 +1,10 @@
+import("lib.detect.find_tool")
+
+function main(t)
+    local clang = find_tool("clang")
+    if clang and not is_subhost("windows") then
+        os.exec("xmake f --toolchain=clang -c --yes")
+        os.exec("xmake -r")
+        os.exec("xmake check build.time")
+    end
+end
@@ -0,0 +1,7 @@
+add_rules("mode.debug", "mode.release")
+
+set_policy("build.profile.ftime_trace", true)
+
+target("test")
+    set_kind("binary")
+    add_files("src/*.cpp")
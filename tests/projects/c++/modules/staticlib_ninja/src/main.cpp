@@ -0,0 +1,7 @@
+#include <stdio.h>
+import mod;
+
+int main() {
+    printf("%d\n", mod::foo());
+    return 0;
+}
@@ -0,0 +1,7 @@
+module mod;
+
+namespace mod {
+int foo() {
+    return 2;
+}
+} // namespace mod
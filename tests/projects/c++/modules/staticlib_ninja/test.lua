@@ -0,0 +1 @@
+inherit(".test_ninja")
@@ -0,0 +1,40 @@
+import("lib.detect.find_tool")
+import("core.base.semver")
+import("core.tool.toolchain")
+import("utils.ci.is_running", {alias = "ci_is_running"})
+
+function _build(name)
+    local ninja = assert(find_tool("ninja"))
+    local argv = {}
+    if ci_is_running() then
+        table.insert(argv, "-v")
+    end
+    os.rm(".xmake", "build", "build.ninja")
+    os.vrunv("xmake", {"f", "--toolchain=" .. name, "-c"})
+    os.vrunv("xmake", {"project", "-k", "ninja"})
+    os.vrunv(ninja.program, argv)
+
+    -- nothing to do if we build it again
+    local outdata = os.iorunv(ninja.program, {"-n"})
+    assert(outdata:find("no work to do", 1, true), "ninja should have no work to do after building!")
+end
+
+function _build_with(name, minver)
+    local tool = find_tool(name, {version = true})
+    if tool and tool.version and semver.compare(tool.version, minver) >= 0 then
+        local _toolchain = toolchain.load(name, {plat = os.host(), arch = os.arch()})
+        if _toolchain and _toolchain:check() then
+            _build(name)
+        end
+    end
+end
+
+function main(t)
+    local ninja = find_tool("ninja", {version = true})
+    if ninja and ninja.version and semver.compare(ninja.version, "1.10") >= 0 then
+        if is_subhost("linux") then
+            _build_with("gcc", "14")
+            _build_with("clang", "19")
+        end
+    end
+end
@@ -0,0 +1,11 @@
+#include <string>
+#include <vector>
+#include <map>
+#include "foo.h"
+
+int bar() {
+    std::vector<std::string> items = {"bar"};
+    std::map<std::string, int> counts;
+    counts[items[0]] = 1;
+    return counts["bar"];
+}
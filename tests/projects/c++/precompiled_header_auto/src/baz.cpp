@@ -0,0 +1,11 @@
+#include <string>
+#include <vector>
+#include <map>
+#include "foo.h"
+
+int baz() {
+    std::vector<std::string> items = {"baz"};
+    std::map<std::string, int> counts;
+    counts[items[0]] = 1;
+    return counts["baz"];
+}
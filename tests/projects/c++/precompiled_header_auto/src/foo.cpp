@@ -0,0 +1,11 @@
+#include <string>
+#include <vector>
+#include <map>
+#include "foo.h"
+
+int foo(int n) {
+    std::vector<std::string> items = {"foo"};
+    std::map<std::string, int> counts;
+    counts[items[0]] = n;
+    return counts["foo"];
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+int foo(int n);
+int bar();
+int baz();
@@ -0,0 +1,13 @@
+#include <string>
+#include <vector>
+#include <map>
+#include "foo.h"
+
+int main(int argc, char** argv) {
+    std::vector<std::string> args(argv, argv + argc);
+    std::map<std::string, int> counts;
+    for (auto const& arg : args) {
+        counts[arg]++;
+    }
+    return foo(static_cast<int>(counts.size())) + bar() + baz() > 0 ? 0 : 1;
+}
@@ -0,0 +1,9 @@
+#include <vector>
+#include <string>
+#include <map>
+#include "foo.h"
+
+int quux() {
+    std::vector<std::string> names = {"quux"};
+    return static_cast<int>(names.size());
+}
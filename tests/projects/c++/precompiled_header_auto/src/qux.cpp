@@ -0,0 +1,6 @@
+#include <string>
+
+int qux() {
+    std::string name = "qux";
+    return static_cast<int>(name.size());
+}
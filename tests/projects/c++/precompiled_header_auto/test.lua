@@ -0,0 +1,27 @@
+function main(t)
+    -- the project headers modified recently are unstable, they will not be selected
+    os.touch("src/foo.h", {mtime = os.time() - 7 * 86400})
+    os.tryrm("build")
+    t:build()
+
+    -- the precompiled header will be generated from the include statistics of the first build
+    local outdata = os.iorun("xmake -r -v")
+    t:require(#os.files("build/.gens/main/**/auto_pch.hpp") > 0)
+    t:require(#os.files("build/.objs/main/**/auto_pch.hpp.*") > 0)
+
+    -- it's only used by the sourcefiles which include all selected headers at the beginning in the same order
+    local used = {}
+    for _, line in ipairs(outdata:split("\n")) do
+        if line:find("auto_pch", 1, true) then
+            for _, name in ipairs({"foo.cpp", "bar.cpp", "qux.cpp", "quux.cpp"}) do
+                if line:find(name, 1, true) then
+                    used[name] = true
+                end
+            end
+        end
+    end
+    t:require(used["foo.cpp"])
+    t:require(used["bar.cpp"])
+    t:require_not(used["qux.cpp"])
+    t:require_not(used["quux.cpp"])
+end
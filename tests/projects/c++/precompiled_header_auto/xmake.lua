@@ -0,0 +1,7 @@
+add_rules("mode.debug", "mode.release")
+
+target("main")
+    set_kind("binary")
+    set_languages("cxx11")
+    set_policy("build.pcheader.auto", true)
+    add_files("src/*.cpp")
@@ -0,0 +1,3 @@
+int foo(int n) {
+    return n * 2;
+}
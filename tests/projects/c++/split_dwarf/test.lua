@@ -0,0 +1,6 @@
+function main(t)
+    if not is_host("linux") then
+        return t:skip("wrong host platform")
+    end
+    t:build()
+end
@@ -0,0 +1,13 @@
+add_rules("mode.debug", "mode.release")
+
+set_policy("build.debug.split_dwarf", true)
+set_policy("build.debug.split_dwarf.dwp", true)
+
+target("foo")
+    set_kind("shared")
+    add_files("src/foo.cpp")
+
+target("test")
+    set_kind("binary")
+    add_deps("foo")
+    add_files("src/main.cpp")
@@ -1,3 +1,39 @@
+-- get the auto batches from the generated unity files, e.g. {"main.cpp,test7.cpp,test8.cpp"}
+function _get_auto_batches()
+    local batches = {}
+    for _, unityfile in ipairs(os.files("build/.gens/test_auto/**/unity_auto_*.cpp")) do
+        local sourcefiles = {}
+        for _, line in ipairs(io.readfile(unityfile):split("\n")) do
+            local sourcefile = line:match("#include \"(.+)\"")
+            if sourcefile then
+                table.insert(sourcefiles, path.filename(sourcefile))
+            end
+        end
+        table.sort(sourcefiles)
+        table.insert(batches, table.concat(sourcefiles, ","))
+    end
+    table.sort(batches)
+    return batches
+end
+
 function main(t)
+    os.tryrm(".xmake")
+    os.tryrm("build")
     t:build()
+
+    -- all files are merged into one unity file if we have no build history, they are less than the minimal budget (1ms)
+    t:are_equal(_get_auto_batches(), {"main.cpp,test7.cpp,test8.cpp"})
+
+    -- the previous batch is kept after the costs are updated from the build history
+    os.exec("xmake -r -j1 test_auto")
+    t:are_equal(_get_auto_batches(), {"main.cpp,test7.cpp,test8.cpp"})
+
+    -- the frequently-edited file is built as a standalone object file
+    for i = 1, 3 do
+        os.touch("src/test7.cpp", {mtime = os.time() + i * 10})
+        os.exec("xmake -j1 test_auto")
+    end
+    os.tryrm("build/.gens/test_auto")
+    os.exec("xmake -r -j1 test_auto")
+    t:are_equal(_get_auto_batches(), {"main.cpp,test8.cpp"})
 end
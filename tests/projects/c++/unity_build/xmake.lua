@@ -7,3 +7,11 @@ target("test")
     add_files("src/bar/*.cpp", {unity_group = "bar"})
 
 
+
+target("test_auto")
+    set_kind("binary")
+    add_includedirs("src")
+    add_rules("c++.unity_build", {batchsize = "auto", uniqueid = "MY_UNITY_ID"})
+    add_files("src/*.c", "src/*.cpp")
+    add_files("src/foo/*.cpp", {unity_group = "foo"})
+    add_files("src/bar/*.cpp", {unity_group = "bar"})
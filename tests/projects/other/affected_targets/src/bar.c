@@ -0,0 +1,3 @@
+int bar(void) {
+    return 2;
+}
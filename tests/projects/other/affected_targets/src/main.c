@@ -0,0 +1,7 @@
+#include <stdio.h>
+#include "foo.h"
+
+int main(int argc, char** argv) {
+    printf("%d\n", foo());
+    return 0;
+}
@@ -0,0 +1,29 @@
+function _get_affected(t, files)
+    local targets = {}
+    local outdata = os.iorun("xmake build --changed-files=%s --show-affected", files)
+    for _, line in ipairs(outdata:split("\n")) do
+        line = line:trim()
+        if line == "foo" or line == "bar" or line == "app" then
+            table.insert(targets, line)
+        end
+    end
+    table.sort(targets)
+    return targets
+end
+
+function main(t)
+    os.exec("xmake f -c -y")
+
+    -- the mapped source files and header files
+    t:are_equal(_get_affected(t, "src/bar.c"), {"bar"})
+    t:are_equal(_get_affected(t, "inc/bar.h"), {"bar"})
+    t:are_equal(_get_affected(t, "src/foo.c"), {"app", "foo"})
+
+    -- the included headers are unknown before building, so all targets without dependinfo are affected
+    t:are_equal(_get_affected(t, "inc/foo.h"), {"app", "bar", "foo"})
+
+    -- the included headers are mapped by the dependfiles after building
+    os.exec("xmake -r")
+    t:are_equal(_get_affected(t, "inc/foo.h"), {"app", "foo"})
+    t:are_equal(_get_affected(t, "src/main.c"), {"app"})
+end
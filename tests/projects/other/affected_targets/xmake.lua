@@ -0,0 +1,17 @@
+add_rules("mode.debug", "mode.release")
+
+target("foo")
+    set_kind("static")
+    add_files("src/foo.c")
+    add_includedirs("inc")
+
+target("bar")
+    set_kind("static")
+    add_files("src/bar.c")
+    add_headerfiles("inc/bar.h")
+
+target("app")
+    set_kind("binary")
+    add_deps("foo")
+    add_files("src/main.c")
+    add_includedirs("inc")
@@ -22,8 +22,10 @@
 import("core.base.option")
 import("core.base.global")
 import("core.base.task")
+import("core.base.profiler")
 import("core.tool.toolchain")
 import("core.cache.detectcache")
+import("core.cache.fingerprintcache")
 import("core.project.rule")
 import("core.project.config")
 import("core.project.project")
@@ -35,9 +37,11 @@ import("build_files")
 import("cleaner")
 import("check", {alias = "check_targets"})
 import("private.cache.build_cache")
+import("private.cache.build_stats")
 import("private.service.remote_build.action", {alias = "remote_build_action"})
 import("private.utils.statistics")
 import("private.action.utils", {alias = "action_utils"})
+import("private.action.build.affected")
 import("private.detect.check_targetnames")
 
 -- try building it
@@ -114,6 +118,25 @@ function _do_build(targetname, opt)
     end
 end
 
+-- get the affected targets of the changed files in the selected targets and their dependencies
+function _get_affected_targets(targetnames, group_pattern)
+    local selected = {}
+    for _, target in ipairs(action_utils.get_targets(targetnames, {group_pattern = group_pattern})) do
+        selected[target] = true
+        for _, dep in ipairs(target:orderdeps()) do
+            selected[dep] = true
+        end
+    end
+    local targets = {}
+    local changed_files = affected.changed_files(option.get("changed-files"))
+    for _, target in ipairs(affected.targets(changed_files)) do
+        if selected[target] then
+            table.insert(targets, target)
+        end
+    end
+    return targets
+end
+
 -- build targets
 function build_targets(targetnames, opt)
     opt = opt or {}
@@ -135,6 +158,10 @@ function build_targets(targetnames, opt)
 
             -- save detect cache
             detectcache:save()
+            fingerprintcache.save()
+
+            -- save build stats
+            build_stats.save()
 
             -- dump cache stats
             if option.get("diagnosis") then
@@ -156,6 +183,10 @@ function build_targets(targetnames, opt)
 
                 -- save detect cache
                 detectcache:save()
+                fingerprintcache.save()
+
+                -- save build stats
+                build_stats.save()
 
                 -- raise
                 if errors then
@@ -197,13 +228,35 @@ function main(opt)
 
     -- config it first
     local targetnames, group_pattern = action_utils.get_targets_and_group()
+    profiler.mem_enter("config")
     task.run("config", {}, {disable_dump = true})
+    profiler.mem_leave("config")
 
     -- check target names
     if targetnames then
         assert(check_targetnames(targetnames))
     end
 
+    -- only build the affected targets of the changed files?
+    if option.get("changed-files") then
+        local targets = _get_affected_targets(targetnames, group_pattern)
+        if option.get("show-affected") or #targets == 0 then
+            for _, target in ipairs(targets) do
+                print(target:fullname())
+            end
+            if #targets == 0 then
+                cprint("${color.warning}no affected targets found!")
+            end
+            project.unlock()
+            return
+        end
+        targetnames = {}
+        for _, target in ipairs(targets) do
+            table.insert(targetnames, target:fullname())
+        end
+        group_pattern = nil
+    end
+
     -- enter project directory
     local oldir = os.cd(project.directory())
 
@@ -49,6 +49,13 @@ task("build")
                                            "    - xmake --files='src/*.c' [target]",
                                            "    - xmake --files='src/**.c|excluded_file.c'",
                                            "    - xmake --files='src/main.c" .. path.envsep() .. "src/test.c'"},
+            {nil, "changed-files", "kv", nil, "Only build the targets affected by the given changed files, and all their dependents.",
+                                           "It supports the source files, the included headers and xmake.lua.",
+                                           "e.g. ",
+                                           "    - xmake --changed-files=src/foo.c" .. path.envsep() .. "src/foo.h",
+                                           "    - xmake --changed-files=@changed_files.txt",
+                                           "    - xmake --changed-files=origin/master"},
+            {nil, "show-affected", "k", nil, "Only show the affected targets of the changed files, it needs --changed-files."},
             {},
             {nil, "targets",  "vs", nil,   "The target names. It will build all default targets if this parameter is not specified.",
                                            "e.g.",
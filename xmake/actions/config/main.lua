@@ -29,6 +29,7 @@ import("core.platform.platform")
 import("private.detect.find_platform")
 import("core.cache.localcache")
 import("core.cache.detectcache")
+import("core.cache.fingerprintcache")
 import("scangen")
 import("menuconf", {alias = "menuconf_show"})
 import("configfiles", {alias = "generate_configfiles"})
@@ -419,6 +420,7 @@ force to build in current directory via run `xmake -P .`]], os.projectdir())
 
         -- save detect cache
         detectcache:save()
+        fingerprintcache.save()
     end
 
     -- unlock the whole project
@@ -23,6 +23,7 @@ import("core.base.option")
 import("core.base.global")
 import("core.theme.theme")
 import("core.cache.global_detectcache")
+import("core.cache.fingerprintcache")
 import("menuconf", {alias = "menuconf_show"})
 
 -- main
@@ -73,6 +74,8 @@ function main()
     if option.get("clean") or option.get("check") then
         global_detectcache:clear()
         global_detectcache:save()
+        fingerprintcache.clear()
+        fingerprintcache.save()
     end
 
     -- dump it
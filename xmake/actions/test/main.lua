@@ -32,6 +32,7 @@ import("private.service.remote_build.action", {alias = "remote_build_action"})
 import("actions.build.main", {rootdir = os.programdir(), alias = "build_action"})
 import("utils.progress")
 import("private.utils.target", {alias = "target_utils"})
+import("private.action.build.affected")
 
 -- Load expected outputs from files for pass_output_files/fail_output_files.
 -- Resolve relative paths from the target scriptdir.
@@ -501,6 +502,21 @@ function _try_build_target(targetname)
     return passed, errors
 end
 
+-- get the tests of the targets affected by the changed files
+function _get_affected_tests(tests, changed_files)
+    local affected_targets = {}
+    for _, target in ipairs(affected.targets(affected.changed_files(changed_files))) do
+        affected_targets[target] = true
+    end
+    local tests_new = {}
+    for name, testinfo in pairs(tests) do
+        if affected_targets[testinfo.target] then
+            tests_new[name] = testinfo
+        end
+    end
+    return tests_new
+end
+
 -- get tests, export this for the `project` plugin
 function get_tests()
     local tests = {}
@@ -596,6 +612,12 @@ function main()
         tests = tests_new
     end
 
+    -- only run the tests of the affected targets?
+    local changed_files = option.get("changed-files")
+    if changed_files then
+        tests = _get_affected_tests(tests, changed_files)
+    end
+
     -- enter project directory
     local oldir = os.cd(project.directory())
 
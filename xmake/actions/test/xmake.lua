@@ -37,6 +37,11 @@ task("test")
             {'j', "jobs",    "kv", tostring(os.default_njob()),
                                           "Set the number of parallel compilation jobs."},
             {'r', "rebuild", "k",  nil,   "Rebuild the target."},
+            {nil, "changed-files", "kv", nil, "Only run the tests of the targets affected by the given changed files.",
+                                          "e.g.",
+                                          "    xmake test --changed-files=src/foo.c" .. path.envsep() .. "src/foo.h",
+                                          "    xmake test --changed-files=@changed_files.txt",
+                                          "    xmake test --changed-files=origin/master"},
             {},
             {nil, "tests",   "vs", nil,   "The test names. It supports pattern matching.",
                                           "e.g.",
@@ -34,6 +34,7 @@ binutils._deplibs = binutils._deplibs or binutils.deplibs
 binutils._rpath_list = binutils._rpath_list or binutils.rpath_list
 binutils._rpath_clean = binutils._rpath_clean or binutils.rpath_clean
 binutils._extractlib = binutils._extractlib or binutils.extractlib
+binutils._armembers = binutils._armembers or binutils.armembers
 binutils._format = binutils._format or binutils.format
 
 -- generate c/c++ header with binary data from the binary file
@@ -190,5 +191,22 @@ function binutils.extractlib(libraryfile, outputdir, opt)
     end
 end
 
+-- get all members of the static library
+-- Supports AR format (.a), thin AR format and MSVC lib format (.lib)
+-- @param libraryfile the static library file path (.a or .lib)
+-- @return             the members list, e.g. {{name = "foo.o", size = 1024}, ...}, or nil and error info
+function binutils.armembers(libraryfile)
+    if binutils._armembers then
+        local members, errors = binutils._armembers(libraryfile)
+        if members then
+            return members
+        else
+            return nil, errors or "unknown error"
+        end
+    else
+        return nil, "C implementation not available"
+    end
+end
+
 -- return module
 return binutils
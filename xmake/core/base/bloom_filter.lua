@@ -37,6 +37,12 @@ bloom_filter._data_set = bloom_filter._data_set or bloom_filter.data_set
 bloom_filter._clear    = bloom_filter._clear or bloom_filter.clear
 bloom_filter._set      = bloom_filter._set or bloom_filter.set
 bloom_filter._get      = bloom_filter._get or bloom_filter.get
+bloom_filter._delta    = bloom_filter._delta or bloom_filter.delta
+bloom_filter._merge    = bloom_filter._merge or bloom_filter.merge
+
+-- the bloom filter data version
+bloom_filter.VERSION_LEGACY          = 1  -- the tbox bloom filter
+bloom_filter.VERSION_BLOCKED         = 2  -- the cache-line blocked bloom filter with the versioned header
 
 -- the bloom filter probability
 bloom_filter.PROBABILITY_0_1         = 3  -- 1 / 2^3 = 0.125 ~= 0.1
@@ -105,6 +111,61 @@ function _instance:data_set(data)
     return bloom_filter._data_set(self:cdata(), dataaddr, datasize)
 end
 
+-- get the delta data of the changed blocks since the last delta
+--
+-- @return      the data bytes, or nil and error info
+--
+function _instance:delta()
+    -- ensure opened
+    local ok, errors = self:_ensure_opened()
+    if not ok then
+        return nil, errors
+    end
+
+    -- the old core does not support it
+    if not bloom_filter._delta then
+        return nil, "delta is not supported!"
+    end
+
+    -- get the delta data
+    local data, size = bloom_filter._delta(self:cdata())
+    if not data or not size then
+        return nil, "no delta data!"
+    end
+
+    -- mount this data
+    return bytes(size, data)
+end
+
+-- merge the full or delta data of the other bloom filter with the same options
+--
+-- @param data  the data bytes
+-- @return      true on success, or false and error info
+--
+function _instance:merge(data)
+    -- ensure opened
+    local ok, errors = self:_ensure_opened()
+    if not ok then
+        return false, errors
+    end
+
+    -- the old core does not support it
+    if not bloom_filter._merge then
+        return false, "merge is not supported!"
+    end
+
+    -- do merge
+    local datasize = data:size()
+    local dataaddr = data:caddr()
+    if not dataaddr or datasize == 0 then
+        return false, "empty data!"
+    end
+    if not bloom_filter._merge(self:cdata(), dataaddr, datasize) then
+        return false, "merge data failed, the data version or size is mismatched!"
+    end
+    return true
+end
+
 -- clear all data in the bloom filter
 --
 -- @return      true on success, or false and error info
@@ -194,6 +255,8 @@ end
 --              - probability:  false positive rate (default: 0.001), supports 0.1 ~ 0.000001
 --              - hash_count:   the hash function count (default: 3)
 --              - item_maxn:    the maximum item count (default: 1000000)
+--              - version:      the data version (default: bloom_filter.VERSION_BLOCKED),
+--                              we can use bloom_filter.VERSION_LEGACY to serialize data for the old xmake
 -- @return      the bloom filter instance, or nil and error info
 --
 function bloom_filter.new(opt)
@@ -210,7 +273,8 @@ function bloom_filter.new(opt)
     probability = assert(maps[probability], "invalid probability(%f)", probability)
     local hash_count = opt.hash_count or 3
     local item_maxn = opt.item_maxn or 1000000
-    local handle, errors = bloom_filter._open(probability, hash_count, item_maxn)
+    local version = opt.version or bloom_filter.VERSION_BLOCKED
+    local handle, errors = bloom_filter._open(probability, hash_count, item_maxn, version)
     if handle then
         return _instance.new(handle)
     else
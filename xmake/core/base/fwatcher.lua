@@ -33,6 +33,7 @@ fwatcher._open       = fwatcher._open or fwatcher.open
 fwatcher._add        = fwatcher._add or fwatcher.add
 fwatcher._remove     = fwatcher._remove or fwatcher.remove
 fwatcher._wait       = fwatcher._wait or fwatcher.wait
+fwatcher._wait_events = fwatcher._wait_events or fwatcher.wait_events
 fwatcher._close      = fwatcher._close or fwatcher.close
 
 -- the fwatcher event type, @see tbox/platform/fwatcher.h
@@ -119,6 +120,97 @@ function _instance:wait(timeout)
     return result, event_or_errors
 end
 
+-- coalesce the new event to the last event of the same path, @see core/src/xmake/fwatcher/wait_events.c
+--
+-- - create + modify => create
+-- - create + delete => none, e.g. the temporary files of editors
+-- - delete + create => modify, e.g. save file by renaming the temporary file
+-- - others          => the new event
+--
+function fwatcher._coalesce_event(events, eventmap, event)
+    local last = eventmap[event.path]
+    if last then
+        local lasttype = last.type
+        local newtype = event.type
+        if lasttype == nil then
+            last.type = newtype
+        elseif lasttype == fwatcher.ET_CREATE and newtype == fwatcher.ET_MODIFY then
+            last.type = fwatcher.ET_CREATE
+        elseif lasttype == fwatcher.ET_CREATE and newtype == fwatcher.ET_DELETE then
+            last.type = nil
+        elseif lasttype == fwatcher.ET_DELETE and newtype == fwatcher.ET_CREATE then
+            last.type = fwatcher.ET_MODIFY
+        else
+            last.type = newtype
+        end
+    else
+        last = {type = event.type, path = event.path}
+        eventmap[last.path] = last
+        table.insert(events, last)
+    end
+end
+
+-- wait and coalesce events
+--
+-- we wait the first event, and collect the following events until there is no any new event in the debounce time,
+-- the events of the same path are coalesced, e.g. delete + create => modify, create + delete => none.
+--
+-- @param timeout   the timeout
+-- @param opt       the options, e.g. {debounce = 100}
+--
+-- @return          count, events, e.g 1, {{type = fwatcher.ET_MODIFY, path = "/tmp/a.c"}}
+--
+function _instance:wait_events(timeout, opt)
+    opt = opt or {}
+
+    -- ensure opened
+    local ok, errors = self:_ensure_opened()
+    if not ok then
+        return -1, errors
+    end
+
+    -- the native implementation will block the current thread,
+    -- so we only use it if we are not in the coroutine scheduler
+    local debounce = opt.debounce or 100
+    if fwatcher._wait_events and not scheduler:co_running() then
+        local result, events_or_errors = fwatcher._wait_events(self:cdata(), timeout or -1, debounce)
+        if result < 0 and events_or_errors then
+            events_or_errors = string.format("<fwatcher>: wait events failed, %s", events_or_errors)
+        end
+        return result, events_or_errors
+    end
+
+    -- wait the first event, it will not block the other coroutines if we are in the scheduler
+    local result, event_or_errors = self:wait(timeout)
+    if result <= 0 then
+        return result, event_or_errors
+    end
+
+    -- collect and coalesce the following events in the debounce time,
+    -- but we need to limit the total time to avoid waiting forever if the events are not stopped
+    local events = {}
+    local eventmap = {}
+    local maxtime = math.max(debounce * 4, 1000)
+    local starttime = os.mclock()
+    while result > 0 do
+        fwatcher._coalesce_event(events, eventmap, event_or_errors)
+        local elapsed = os.mclock() - starttime
+        if elapsed >= maxtime then
+            break
+        end
+        result, event_or_errors = self:wait(math.min(debounce, maxtime - elapsed))
+    end
+
+    -- we ignore the transient files which have been created and deleted
+    local results = {}
+    for _, event in ipairs(events) do
+        if event.type then
+            table.insert(results, event)
+        end
+    end
+    return #results, results
+end
+
 -- close instance
 function _instance:close()
 
@@ -181,6 +273,16 @@ function fwatcher.wait(timeout)
     return _instance:wait(timeout)
 end
 
+-- wait and coalesce file system events
+--
+-- @param timeout   the timeout in milliseconds, -1 for infinite
+-- @param opt       the options, e.g. {debounce = 100}
+-- @return          count, events
+--
+function fwatcher.wait_events(timeout, opt)
+    return _instance:wait_events(timeout, opt)
+end
+
 -- watch directories
 --
 -- @param watchdirs     the watch directories, pattern path string or path list
@@ -31,6 +31,8 @@ local libc  = require("base/libc")
 hash._md5 = hash._md5 or hash.md5
 hash._sha = hash._sha or hash.sha
 hash._xxhash = hash._xxhash or hash.xxhash
+hash._xxhash_cppfile = hash._xxhash_cppfile or hash.xxhash_cppfile
+hash._files = hash._files or hash.files
 hash._rand32 = hash._rand32 or hash.rand32
 hash._rand64 = hash._rand64 or hash.rand64
 hash._rand128 = hash._rand128 or hash.rand128
@@ -131,12 +133,20 @@ end
 
 -- generate xxhash128 from the given file or data
 --
+-- we can map the path prefixes of the line markers in the preprocessed file,
+-- so the same code in the different directories has the same hash value, e.g.
+--
+-- hash.xxhash128("/tmp/foo.i", {prefixmap = {"/home/runner/work/foo", "."}})
+--
 -- @param file_or_data  the file path, data string, or bytes object
+-- @param opt           the options, e.g. {prefixmap = {from1, to1, from2, to2, ..}}
 -- @return              the hash hex string, or nil and error info
 --
-function hash.xxhash128(file_or_data)
+function hash.xxhash128(file_or_data, opt)
     local hashstr, errors
-    if bytes.instance_of(file_or_data) then
+    if opt and opt.prefixmap and type(file_or_data) == "string" then
+        hashstr, errors = hash._xxhash_cppfile_prefixmap(128, file_or_data, opt.prefixmap)
+    elseif bytes.instance_of(file_or_data) then
         local datasize = file_or_data:size()
         local dataaddr = file_or_data:caddr()
         hashstr, errors = hash._xxhash(128, dataaddr, datasize)
@@ -146,6 +156,76 @@ function hash.xxhash128(file_or_data)
     return hashstr, errors
 end
 
+-- generate xxhash from the preprocessed file and map the path prefixes of the line markers
+function hash._xxhash_cppfile_prefixmap(mode, filepath, prefixmap)
+    if hash._xxhash_cppfile then
+        return hash._xxhash_cppfile(mode, filepath, prefixmap)
+    end
+
+    -- we need to be compatible with the old binary core
+    local data, errors = io.readfile(filepath, {encoding = "binary"})
+    if not data then
+        return nil, errors
+    end
+    local lines = {}
+    for linedata in (data .. "\n"):gmatch("(.-\n)") do
+        local line = linedata
+        if line:startswith("#") then
+            local quote = line:find("\"", 1, true)
+            if quote then
+                for i = 1, #prefixmap, 2 do
+                    local from = prefixmap[i]
+                    local to = prefixmap[i + 1]
+                    local ch = line:sub(quote + 1 + #from, quote + 1 + #from)
+                    if line:sub(quote + 1, quote + #from) == from and (ch == "" or ch == "/" or ch == "\\" or ch == "\"") then
+                        line = line:sub(1, quote) .. to .. line:sub(quote + 1 + #from)
+                        break
+                    end
+                end
+            end
+        end
+        table.insert(lines, line)
+    end
+    data = table.concat(lines):sub(1, -2)
+    return hash._xxhash(mode, libc.ptraddr(libc.dataptr(data)), #data)
+end
+
+-- generate hashes of the given files in parallel
+--
+-- e.g.
+--
+-- local digests = hash.files({"/tmp/a", "/tmp/b"}, {algo = "sha256"})
+-- print(digests["/tmp/a"])
+--
+-- @param files     the file paths
+-- @param opt       the options, e.g. {algo = "xxh128|xxh64|xxh32|sha256|sha1|md5", threads = 8}
+-- @return          the digests table, the digest of the unreadable file is false,
+--                  or nil and error info
+--
+function hash.files(files, opt)
+    opt = opt or {}
+    local algo = opt.algo or "xxh128"
+    if hash._files then
+        return hash._files(files, algo, opt.threads or 0)
+    end
+
+    -- we need to be compatible with the old binary core
+    local hashers = {
+        xxh32 = hash.xxhash32, xxhash32 = hash.xxhash32,
+        xxh64 = hash.xxhash64, xxhash64 = hash.xxhash64,
+        xxh128 = hash.xxhash128, xxhash128 = hash.xxhash128,
+        sha1 = hash.sha1, sha256 = hash.sha256, md5 = hash.md5}
+    local hasher = hashers[algo]
+    if not hasher then
+        return nil, string.format("unknown hash algorithm(%s)!", algo)
+    end
+    local digests = {}
+    for _, filepath in ipairs(files) do
+        digests[filepath] = hasher(filepath) or false
+    end
+    return digests
+end
+
 -- generate hash32 from string, e.g. "91e8ecf1"
 --
 -- @param str   the input string
@@ -47,6 +47,10 @@ os._cpuinfo  = os._cpuinfo or os.cpuinfo
 os._meminfo  = os._meminfo or os.meminfo
 os._readlink = os._readlink or os.readlink
 os._access   = os._access or os.access
+os._stats    = os._stats or os.stats
+
+-- the max buffer size of os.iorunv, the larger output will be written to the temporary file
+os._IORUNV_MAXBUFF = 4 * 1024 * 1024
 
 -- syserror code
 os.SYSERR_UNKNOWN     = -1
@@ -84,6 +88,7 @@ function os._cp(src, dst, rootdir, opt)
     local symlink = opt.symlink
     local writeable = opt.writeable
     local copy_if_different = opt.copy_if_different
+    local strategy = opt.strategy
     if os.isfile(src) or (symlink and os.islink(src)) then
 
         -- the destination is directory? append the filename
@@ -99,7 +104,7 @@ function os._cp(src, dst, rootdir, opt)
         if opt.force and os.isfile(dst) then
             os.rmfile(dst)
         end
-        if not os.cpfile(src, dst, symlink, writeable, copy_if_different) then
+        if not os.cpfile(src, dst, symlink, writeable, copy_if_different, strategy) then
             local errors = os.strerror()
             if symlink and os.islink(src) then
                 local reallink = os.readlink(src)
@@ -546,9 +551,18 @@ end
 --
 -- @param srcpath   the source file path
 -- @param dstpath   the destination file path
--- @param opt       the copy option. e.g. {rootdir, symlink, writeable, force, copy_if_different}
+-- @param opt       the copy option. e.g. {rootdir, symlink, writeable, force, copy_if_different, strategy}
+--
+-- the copy strategy of files:
+--  - auto: try reflink (FICLONE), copy_file_range and read/write loop in order (default)
+--  - copy: always copy file data through the userspace
+--  - hardlink: create hardlink to the source file, it will fallback to auto if it fails
+--  - symlink: create symlink to the source file, it will fallback to auto if it fails
+--
+-- @note hardlink/symlink are only suitable for readonly files, e.g. the build cache artifacts
 --
 -- e.g. os.cp("src/**.h", "/tmp/", {rootdir = "src", symlink = true})
+-- e.g. os.cp(cachefile, objectfile, {strategy = "hardlink"})
 function os.cp(srcpath, dstpath, opt)
 
     -- check arguments
@@ -1055,13 +1069,24 @@ function os.execv(program, argv, opt)
         end
     end
 
+    -- we need not pass the current directory to process
+    --
+    -- the process is created by tb_process_init() of tbox, which uses posix_spawnp (vfork semantics) if no curdir,
+    -- and falls back to fork/exec with curdir unless posix_spawn_file_actions_addchdir_np (glibc >= 2.29, macos)
+    -- is available in tbox. fork/exec is very slow if the xmake process has a large heap, so we only pass
+    -- the curdir if it is really changed.
+    local curdir = opt.curdir
+    if curdir and path.absolute(tostring(curdir)) == os.curdir() then
+        curdir = nil
+    end
+
     -- init open options
     local openopt = {
         envs = envs,
         stdin = opt.stdin,
         stdout = opt.stdout,
         stderr = opt.stderr,
-        curdir = opt.curdir,
+        curdir = curdir,
         detach = opt.detach,
         exclusive = opt.exclusive}
 
@@ -1150,14 +1175,8 @@ function os.iorun(cmd)
     return os.iorunv(argv[1], table.slice(argv, 2))
 end
 
--- run command with arguments and return output and error data
---
--- @param program   the program path or name
--- @param argv      the arguments list
--- @param opt       the options, e.g. {envs = {}, curdir = "", stdin = ""}
--- @return          the stdout data, the stderr data
---
-function os.iorunv(program, argv, opt)
+-- run command with arguments and capture the output and error data to the temporary files
+function os._iorunv_file(program, argv, opt)
 
     -- make temporary output and error file
     opt = opt or {}
@@ -1184,6 +1203,151 @@ function os.iorunv(program, argv, opt)
     return ok == 0, outdata, errdata, errors
 end
 
+-- read all data from the given pipe to the output buffer
+--
+-- the data will be written to a temporary file if it's too large,
+-- and we stop reading if the process has exited and the pipe is still not closed,
+-- e.g. the pipe handle is inherited by a daemon process.
+--
+function os._iorunv_readpipe(rpipe, output)
+    local pipe = require("base/pipe")
+    local bytes = require("base/bytes")
+    local buff = bytes(8192)
+    while true do
+        local real, data = rpipe:read(buff)
+        if real > 0 then
+            data = data:str()
+            if output.file then
+                output.file:write(data)
+            else
+                table.insert(output.data, data)
+                output.size = output.size + real
+                if output.size > os._IORUNV_MAXBUFF and not output.filepath then
+                    output.filepath = os.tmpfile()
+                    output.file = io.open(output.filepath, "wb")
+                    if output.file then
+                        output.file:write(table.concat(output.data))
+                        output.data = {}
+                    end
+                end
+            end
+        elseif real == 0 then
+            if output.stop then
+                break
+            end
+            if rpipe:wait(pipe.EV_READ, 100) < 0 then
+                break
+            end
+        else
+            break
+        end
+    end
+    rpipe:close()
+end
+
+-- get the output data of the given output buffer
+--
+-- we need to get the same data as io.readfile() in text mode, e.g. convert crlf and utf16 data,
+-- so we still use the temporary file if the data has the bom or utf16 characters.
+--
+function os._iorunv_output(output)
+    local data
+    if not output.file then
+        data = table.concat(output.data)
+        if data:find("\0", 1, true) or data:startswith("\239\187\191") then
+            output.filepath = os.tmpfile()
+            output.file = io.open(output.filepath, "wb")
+            if output.file then
+                output.file:write(data)
+            end
+        elseif data:find("\r", 1, true) then
+            data = data:gsub("\r\n", "\n")
+        end
+    end
+    if output.file then
+        output.file:close()
+        data = io.readfile(output.filepath)
+        os.tryrm(output.filepath)
+    end
+    return data
+end
+
+-- run command with arguments and read the output and error data from the pipes
+--
+-- it's faster than the temporary files, but we need to read pipes in the other coroutines
+-- when the process is running, so it's only used in the coroutine with scheduler.
+--
+function os._iorunv_pipe(program, argv, opt)
+
+    -- open pipes, the child process need the blocking write pipes
+    local pipe = require("base/pipe")
+    local scheduler = require("base/scheduler")
+    local out_rpipe, out_wpipe = pipe.openpair("AB")
+    if not out_rpipe then
+        return
+    end
+    local err_rpipe, err_wpipe = pipe.openpair("AB")
+    if not err_rpipe then
+        out_rpipe:close()
+        out_wpipe:close()
+        return
+    end
+
+    -- read pipes
+    local outbuff = {data = {}, size = 0}
+    local errbuff = {data = {}, size = 0}
+    os._IORUNV_GROUPID = (os._IORUNV_GROUPID or 0) + 1
+    local group_name = "os.iorunv/" .. os._IORUNV_GROUPID
+    scheduler:co_group_begin(group_name, function (co_group)
+        scheduler:co_start(os._iorunv_readpipe, out_rpipe, outbuff)
+        scheduler:co_start(os._iorunv_readpipe, err_rpipe, errbuff)
+    end)
+
+    -- run command
+    local ok, errors = os.execv(program, argv, table.join(opt, {stdout = out_wpipe, stderr = err_wpipe}))
+    if ok == nil then
+        local cmd = program
+        if argv then
+            cmd = cmd .. " " .. os.args(argv)
+        end
+        errors = string.format("cannot runv(%s), %s", cmd, errors or "unknown reason")
+    end
+    out_wpipe:close()
+    err_wpipe:close()
+
+    -- wait for reading the rest data
+    outbuff.stop = true
+    errbuff.stop = true
+    scheduler:co_group_wait(group_name)
+
+    -- get output and error data
+    local outdata = os._iorunv_output(outbuff)
+    local errdata = os._iorunv_output(errbuff)
+    return ok == 0, outdata, errdata, errors
+end
+
+-- run command with arguments and return output and error data
+--
+-- we read the output and error data from pipes in coroutine to avoid creating the temporary files,
+-- otherwise we fallback to the temporary files.
+--
+-- @param program   the program path or name
+-- @param argv      the arguments list
+-- @param opt       the options, e.g. {envs = {}, curdir = "", stdin = ""}
+-- @return          the stdout data, the stderr data
+--
+function os.iorunv(program, argv, opt)
+    opt = opt or {}
+    local scheduler = require("base/scheduler")
+    if scheduler:co_running() then
+        local ok, outdata, errdata, errors = os._iorunv_pipe(program, argv, opt)
+        if ok ~= nil then
+            return ok, outdata, errdata, errors
+        end
+    end
+    return os._iorunv_file(program, argv, opt)
+end
+
 -- raise an exception and abort the current script
 --
 -- the parent function will capture it if we uses pcall or xpcall
@@ -1676,6 +1840,46 @@ function os.meminfo(name)
     return require("base/memory").info(name)
 end
 
+-- get the stats of the given paths in one call
+--
+-- it's faster than calling os.mtime()/os.filesize()/os.isfile() for each path.
+--
+-- it's serial by default, because stat is very fast on the local filesystem,
+-- but we can pass `threads` to stat them in the native threads on the slow network filesystems, e.g. nfs
+--
+-- @param paths     the path list
+-- @param opt       the options, e.g. {fields = {"mtime", "size", "type"}, threads = 4}
+--
+-- @return          the parallel arrays, e.g. {mtime = {1712345678, 0}, size = {1024, 0}, type = {"file", false}},
+--                  the mtime and size of the non-existent path are 0, and its type is false
+--
+function os.stats(paths, opt)
+    opt = opt or {}
+    local fields = opt.fields or {"mtime", "size", "type"}
+    local threads = opt.threads or 1
+    if os._stats then
+        return os._stats(paths, fields, threads)
+    end
+
+    -- we need to be compatible with the old binary core
+    local stats = {}
+    for _, field in ipairs(fields) do
+        stats[field] = {}
+    end
+    for idx, filepath in ipairs(paths) do
+        if stats.mtime then
+            stats.mtime[idx] = os.mtime(filepath)
+        end
+        if stats.size then
+            stats.size[idx] = os.filesize(filepath)
+        end
+        if stats.type then
+            stats.type[idx] = (os.isdir(filepath) and "directory") or (os.isfile(filepath) and "file") or false
+        end
+    end
+    return stats
+end
+
 -- get the default parallel jobs number
 function os.default_njob()
     local njob
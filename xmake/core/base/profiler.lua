@@ -28,6 +28,10 @@ local heap      = require("base/heap")
 local table     = require("base/table")
 local utils     = require("base/utils")
 local string    = require("base/string")
+local xmake     = require("base/xmake")
+
+-- the load time of profiler, it's loaded at the engine startup
+profiler._LOADTIME = os.mclock()
 
 -- get the function key
 function profiler:_func_key(funcinfo)
@@ -153,6 +157,98 @@ function profiler._tracing_handler(hooktype)
     end
 end
 
+-- get the memory snapshot of the current lua state
+function profiler:_mem_snapshot()
+    local stats = os.memstats and os.memstats()
+    if stats then
+        return stats.live, stats.allocs or 0
+    end
+    return math.floor(collectgarbage("count") * 1024), 0
+end
+
+-- get the memory report of the given phase
+function profiler:_mem_report(phase)
+    self._REPORTS_BY_KEY = self._REPORTS_BY_KEY or {}
+    local report = self._REPORTS_BY_KEY[phase]
+    if not report then
+        report = {
+            name        = phase,
+            callcount   = 0,
+            growth      = 0,
+            allocs      = 0,
+            totaltime   = 0
+        }
+        self._REPORTS_BY_KEY[phase] = report
+        self._REPORTS = self._REPORTS or {}
+        table.insert(self._REPORTS, report)
+    end
+    return report
+end
+
+-- get the size string
+function profiler:_mem_sizestr(size)
+    local sign = size < 0 and "-" or ""
+    size = math.abs(size)
+    if size >= 1024 * 1024 then
+        return string.format("%s%.2fM", sign, size / (1024 * 1024))
+    elseif size >= 1024 then
+        return string.format("%s%.2fK", sign, size / 1024)
+    end
+    return string.format("%s%d", sign, size)
+end
+
+-- show and save the memory reports
+function profiler:_mem_stop()
+    local stats = os.memstats and os.memstats() or {allocator = "builtin", live = self:_mem_snapshot()}
+    local report_lines = {}
+    table.insert(report_lines, string.format("%-10s, %7s, %10s, %10s, %8s", "phase", "count", "growth", "allocs", "time"))
+    for _, report in ipairs(self._REPORTS or {}) do
+        table.insert(report_lines, string.format("%-10s, %7d, %10s, %10d, %7.3fs", report.name, report.callcount,
+            self:_mem_sizestr(report.growth), report.allocs, report.totaltime / 1000.0))
+    end
+    table.insert(report_lines, "")
+    table.insert(report_lines, string.format("allocator: %s, live: %s, peak: %s, allocs: %d, frees: %d, large: %d, arena: %s",
+        stats.allocator, self:_mem_sizestr(stats.live), self:_mem_sizestr(stats.peak or stats.live),
+        stats.allocs or 0, stats.frees or 0, stats.large or 0, self:_mem_sizestr(stats.arena or 0)))
+    if stats.classes then
+        local classes = {}
+        for size, count in pairs(stats.classes) do
+            table.insert(classes, {size = size, count = count})
+        end
+        table.sort(classes, function (a, b) return a.size < b.size end)
+        local items = {}
+        for _, class in ipairs(classes) do
+            table.insert(items, string.format("%d: %d", class.size, class.count))
+        end
+        table.insert(report_lines, "size classes: " .. table.concat(items, ", "))
+    end
+    local outfile = path.join(os.tmpdir(), "perf-mem-" .. os.date("%d-%m-%y-%S-%M-%H") .. ".log")
+    local content = table.concat(report_lines, "\n")
+    utils.print(content)
+    utils.print("full log written to %s", outfile)
+    io.writefile(outfile, content .. "\n")
+end
+
+-- show and save the scheduler reports, e.g. XMAKE_PROFILE=perf:sched
+function profiler:_sched_stop()
+    local scheduler = require("base/scheduler")
+    local stats = scheduler:stats()
+    local runtime = stats.runtime / 1000.0
+    local report_lines = {}
+    table.insert(report_lines, string.format("%-14s, %10s, %12s", "counter", "count", "rate"))
+    for _, name in ipairs({"resumes", "wakeups", "events", "group_wakeups", "timer_fires"}) do
+        local count = stats[name]
+        table.insert(report_lines, string.format("%-14s, %10d, %10.1f/s", name, count, runtime > 0 and count / runtime or 0))
+    end
+    table.insert(report_lines, "")
+    table.insert(report_lines, string.format("runloop: %.3fs, pending timer tasks: %d", runtime, stats.timer_tasks))
+    local outfile = path.join(os.tmpdir(), "perf-sched-" .. os.date("%d-%m-%y-%S-%M-%H") .. ".log")
+    local content = table.concat(report_lines, "\n")
+    utils.print(content)
+    utils.print("full log written to %s", outfile)
+    io.writefile(outfile, content .. "\n")
+end
+
 -- start profiling
 function profiler:start()
     if self:is_trace() then
@@ -228,6 +324,16 @@ function profiler:stop()
         end
         utils.print("full log written to %s", outfile)
         io.writefile(outfile, report_lines)
+    elseif self:is_perf("sched") then
+        -- we only report the scheduler of the main engine
+        if xmake.in_main_thread() then
+            self:_sched_stop()
+        end
+    elseif self:is_mem() then
+        -- we only report the heap growth of the main engine
+        if xmake.in_main_thread() then
+            self:_mem_stop()
+        end
    end
 end
 
@@ -272,9 +378,47 @@ function profiler:leave(name, ...)
     end
 end
 
+-- enter the given memory phase, it only works if XMAKE_PROFILE=mem
+--
+-- the phases may be entered in multiple coroutines at the same time, e.g. compile,
+-- so the heap growth of the concurrent phases is only approximate.
+--
+-- @param phase the phase name, e.g. load, config, jobgraph, compile, link
+--
+function profiler:mem_enter(phase)
+    if self:is_mem() then
+        local live, allocs = self:_mem_snapshot()
+        self._MEM_ENTERS = self._MEM_ENTERS or {}
+        self._MEM_ENTERS[phase .. tostring(coroutine.running())] = {live = live, allocs = allocs, time = os.mclock()}
+    end
+end
+
+-- leave the given memory phase, it only works if XMAKE_PROFILE=mem
+--
+-- we measure the heap growth from the engine startup if this phase has not been entered, e.g. load
+--
+-- @param phase the phase name
+--
+function profiler:mem_leave(phase)
+    if self:is_mem() then
+        local live, allocs = self:_mem_snapshot()
+        local key = phase .. tostring(coroutine.running())
+        local enters = self._MEM_ENTERS
+        local entered = enters and enters[key] or {live = 0, allocs = 0, time = self._LOADTIME}
+        if enters then
+            enters[key] = nil
+        end
+        local report = self:_mem_report(phase)
+        report.callcount = report.callcount + 1
+        report.growth = report.growth + (live - entered.live)
+        report.allocs = report.allocs + (allocs - entered.allocs)
+        report.totaltime = report.totaltime + (os.mclock() - entered.time)
+    end
+end
+
 -- get profiler mode
 --
--- @return      the mode string, e.g. "perf:call", "perf:tag", "perf:process", "trace"
+-- @return      the mode string, e.g. "perf:call", "perf:tag", "perf:process", "perf:sched", "trace", "mem"
 --
 function profiler:mode()
     local mode = self._MODE
@@ -296,7 +440,7 @@ end
 
 -- is perf mode?
 --
--- @param name  the specific perf type (optional), e.g. "call", "tag", "process"
+-- @param name  the specific perf type (optional), e.g. "call", "tag", "process", "sched"
 -- @return      true if perf mode
 --
 function profiler:is_perf(name)
@@ -306,12 +450,25 @@ function profiler:is_perf(name)
     end
 end
 
+-- is memory mode?
+--
+-- @return      true if memory mode
+--
+function profiler:is_mem()
+    local is_mem = self._IS_MEM
+    if is_mem == nil then
+        is_mem = self:mode() == "mem"
+        self._IS_MEM = is_mem
+    end
+    return is_mem
+end
+
 -- is the profiler enabled?
 --
 -- @return      true if enabled via --profile option
 --
 function profiler:enabled()
-    return self:is_perf("call") or self:is_perf("tag") or self:is_trace()
+    return self:is_perf("call") or self:is_perf("tag") or self:is_perf("sched") or self:is_trace() or self:is_mem()
 end
 
 -- return module
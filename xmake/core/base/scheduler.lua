@@ -225,6 +225,21 @@ function _coroutine:isolate(isolate)
     self._ISOLATED = isolate
 end
 
+-- get the group names of this coroutine
+function _coroutine:_groups()
+    return self._GROUPS
+end
+
+-- add the group name of this coroutine
+function _coroutine:_group_add(name)
+    local groups = self._GROUPS
+    if not groups then
+        groups = {}
+        self._GROUPS = groups
+    end
+    groups[name] = true
+end
+
 -- get the current timer task
 function _coroutine:_timer_task()
     return self._TIMER_TASK
@@ -430,18 +445,39 @@ function scheduler:_co_curenvs_update(envs)
     co_curenvs[running] = {envs_hash, envs}
 end
 
+-- mark the groups of the given dead coroutine as dirty
+function scheduler:_co_groups_dirty(co)
+    local groups = co:_groups()
+    if groups then
+        local co_groups_dirty = self._CO_GROUPS_DIRTY
+        if not co_groups_dirty then
+            co_groups_dirty = {}
+            self._CO_GROUPS_DIRTY = co_groups_dirty
+        end
+        for name, _ in pairs(groups) do
+            co_groups_dirty[name] = true
+        end
+    end
+end
+
 -- resume it's waiting coroutine if all coroutines are dead in group
+--
+-- we only check the waiting groups which have new dead coroutines since the last loop
+--
 function scheduler:_co_groups_resume()
 
     local resumed_count = 0
     local co_groups = self._CO_GROUPS
-    if co_groups then
+    local co_groups_dirty = self._CO_GROUPS_DIRTY
+    if co_groups and co_groups_dirty and next(co_groups_dirty) then
+        self._CO_GROUPS_DIRTY = nil
         local co_groups_waiting = self._CO_GROUPS_WAITING
         local co_resumed_list = {}
-        for name, co_group in pairs(co_groups) do
+        for name, _ in pairs(co_groups_dirty) do
 
             -- get coroutine and limit in waiting group
-            local item = co_groups_waiting and co_groups_waiting[name] or nil
+            local co_group = co_groups[name]
+            local item = co_group and co_groups_waiting and co_groups_waiting[name] or nil
             if item then
                 local co_waiting = item[1]
                 local limit = item[2]
@@ -461,12 +497,14 @@ function scheduler:_co_groups_resume()
                 -- resume the waiting coroutine of this group if some coroutines are dead in this group
                 if count >= limit and co_waiting and co_waiting:is_suspended() then
                     resumed_count = resumed_count + 1
-                    self._CO_GROUPS_WAITING[name] = nil
+                    co_groups_waiting[name] = nil
                     table.insert(co_resumed_list, co_waiting)
                 end
             end
         end
         if #co_resumed_list > 0 then
+            local stats = self:_stats()
+            stats.group_wakeups = stats.group_wakeups + #co_resumed_list
             for _, co_waiting in ipairs(co_resumed_list) do
                 local ok, errors = self:co_resume(co_waiting)
                 if not ok then
@@ -478,6 +516,16 @@ function scheduler:_co_groups_resume()
     return resumed_count
 end
 
+-- get the scheduler stats
+function scheduler:_stats()
+    local stats = self._STATS
+    if not stats then
+        stats = {resumes = 0, wakeups = 0, events = 0, group_wakeups = 0, runtime = 0}
+        self._STATS = stats
+    end
+    return stats
+end
+
 -- get profiler
 function scheduler:_profiler()
     local profiler = self._PROFILE
@@ -541,12 +589,25 @@ function scheduler:co_start_withopt(opt, cotask, ...)
         if self:co_count() > 0 then
             self._CO_COUNT = self:co_count() - 1
         end
+        self:_co_groups_dirty(co)
     end))
     if opt.isolate then
         co:isolate(true)
     end
     self:co_tasks()[co:thread()] = co
     self._CO_COUNT = self:co_count() + 1
+
+    -- add this coroutine to the pending groups,
+    -- we need to add it before resuming it, because it may be dead after the first resume
+    local co_groups_pending = self._CO_GROUPS_PENDING
+    if co_groups_pending then
+        for name, co_group_pending in pairs(co_groups_pending) do
+            table.insert(co_group_pending, co)
+            co:_group_add(name)
+        end
+    end
+
+    -- resume it
     if self._STARTED then
         local ok, errors = self:co_resume(co, ...)
         if not ok then
@@ -556,14 +617,6 @@ function scheduler:co_start_withopt(opt, cotask, ...)
         self._CO_READY_TASKS = self._CO_READY_TASKS or {}
         table.insert(self._CO_READY_TASKS, {co, table.pack(...)})
     end
-
-    -- add this coroutine to the pending groups
-    local co_groups_pending = self._CO_GROUPS_PENDING
-    if co_groups_pending then
-        for _, co_group_pending in pairs(co_groups_pending) do
-            table.insert(co_group_pending, co)
-        end
-    end
     return co
 end
 
@@ -576,7 +629,13 @@ end
 function scheduler:co_resume(co, ...)
 
     -- do resume
+    local stats = self:_stats()
+    stats.resumes = stats.resumes + 1
     local ok, errors = coroutine.resume(co:thread(), ...)
+    if not ok then
+        -- it's dead now, we need to notify its waiting groups
+        self:_co_groups_dirty(co)
+    end
 
     local running = self:co_running()
     if running then
@@ -1167,6 +1226,18 @@ function scheduler:poller_cancel(obj)
     return true
 end
 
+-- get the scheduler stats
+--
+-- @return       the stats, e.g. {resumes = 100, wakeups = 10, events = 20, group_wakeups = 1, timer_fires = 5, timer_tasks = 2, runtime = 1000}
+--
+function scheduler:stats()
+    local stats = table.copy(self:_stats())
+    local t = self._TIMER
+    stats.timer_fires = t and t:fires() or 0
+    stats.timer_tasks = t and t:count() or 0
+    return stats
+end
+
 -- enable or disable to scheduler
 function scheduler:enable(enabled)
     self._ENABLED = enabled
@@ -1221,6 +1292,8 @@ function scheduler:runloop()
     local ok = true
     local errors = nil
     local timeout = -1
+    local stats = self:_stats()
+    local starttime = os.mclock()
     while self._STARTED and self:co_count() > 0 do
 
         -- resume it's waiting coroutine if some coroutines are dead in group
@@ -1241,6 +1314,8 @@ function scheduler:runloop()
                 errors = events
                 break
             end
+            stats.wakeups = stats.wakeups + 1
+            stats.events = stats.events + count
 
             -- resume all suspended tasks with events
             for _, e in ipairs(events) do
@@ -1278,6 +1353,7 @@ function scheduler:runloop()
 
     -- mark the loop as stopped first
     self._STARTED = false
+    stats.runtime = stats.runtime + os.mclock() - starttime
 
     -- cancel all timeout tasks and trigger them
     self:_timer():kill()
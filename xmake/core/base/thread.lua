@@ -1048,6 +1048,29 @@ function thread.sharedata(name)
     end
 end
 
+-- prewarm the thread engines in background
+--
+-- the new threads will reuse the prewarmed engines which have loaded all core modules,
+-- so the short-lived threads need not bootstrap xmake again.
+--
+-- @param count     the engine count
+-- @param opt       the options, e.g. {modules = {"sandbox/sandbox", "base/json"}}
+--
+-- @return          true or false, it will return false if the engines have been prewarmed
+--
+function thread.prewarm(count, opt)
+    opt = opt or {}
+    return thread.engine_pool_prewarm(count, opt.modules)
+end
+
+-- get the stats of the thread engine pool
+--
+-- @return      the stats, e.g. {hits = 10, misses = 2, drops = 0, prewarmed = 2, idle = 2}
+--
+function thread.pool_stats()
+    return thread.engine_pool_stats()
+end
+
 -- return module
 return thread
 
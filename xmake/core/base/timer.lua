@@ -19,20 +19,129 @@
 --
 
 -- load modules
-local heap   = require("base/heap")
+local table  = require("base/table")
 local object = require("base/object")
 
 -- define module: timer
 local timer  = timer or object()
 
+-- the slot count of the hierarchical timing wheels, the first wheel has 256 slots of 1ms,
+-- and the other wheels have 64 slots, so all wheels can cover 2^32ms (~49 days)
+--
+-- @see http://www.cs.columbia.edu/~nahum/w6998/papers/sosp87-timing-wheels.pdf
+--
+timer._WHEEL_SIZES = {256, 64, 64, 64, 64}
+
 -- tostring(timer)
 function timer:__tostring()
     return string.format("<timer: %s>", self:name())
 end
 
--- get all timer tasks
-function timer:_tasks()
-    return self._TASKS
+-- get the tick of the given time, we never fire tasks before they are expired
+function timer:_tick(when)
+    return math.ceil(when)
+end
+
+-- get the expired tasks which will be run in the next loop
+function timer:_expired()
+    return self._EXPIRED
+end
+
+-- add task to the timing wheels
+function timer:_add(task)
+    local current = self._CURRENT
+    local tick = self:_tick(task.when)
+    if tick < current then
+        table.insert(self._EXPIRED, task)
+        return
+    end
+
+    -- find the wheel which can cover this delay, the overflowed task will be re-added when it's cascaded
+    local delay = tick - current
+    local wheels = self._WHEELS
+    local wheelcount = #wheels
+    local level = 1
+    while level < wheelcount and delay >= wheels[level + 1].span do
+        level = level + 1
+    end
+    local wheel = wheels[level]
+    if delay >= wheel.span * wheel.size then
+        tick = current + wheel.span * wheel.size - 1
+    end
+
+    -- add it to the slot
+    local index = math.floor(tick / wheel.span)
+    local slot_index = index % wheel.size
+    local slot = wheel.slots[slot_index]
+    if slot == nil then
+        slot = {}
+        wheel.slots[slot_index] = slot
+    end
+    table.insert(slot, task)
+    wheel.count = wheel.count + 1
+    self._COUNT = self._COUNT + 1
+
+    -- update the cached next tick
+    local next_tick = self._NEXT_TICK
+    local slot_tick = index * wheel.span
+    if next_tick and slot_tick < next_tick then
+        self._NEXT_TICK = slot_tick
+    end
+end
+
+-- get the next tick which we need to process, it may be only the cascading tick of the upper wheel
+function timer:_next_tick()
+    local next_tick = self._NEXT_TICK
+    if next_tick == nil and self._COUNT > 0 then
+        local current = self._CURRENT
+        for _, wheel in ipairs(self._WHEELS) do
+            if wheel.count > 0 then
+                local span = wheel.span
+                local size = wheel.size
+                local slots = wheel.slots
+                local index = math.floor(current / span)
+                for i = index, index + size do
+                    local slot_tick = i * span
+                    if slots[i % size] and slot_tick >= current then
+                        if next_tick == nil or slot_tick < next_tick then
+                            next_tick = slot_tick
+                        end
+                        break
+                    end
+                end
+            end
+        end
+        self._NEXT_TICK = next_tick
+    end
+    return next_tick
+end
+
+-- process the given tick, cascade the upper wheels and move the expired tasks of the first wheel
+function timer:_process(tick)
+    self._CURRENT = tick
+    self._NEXT_TICK = nil
+    local wheels = self._WHEELS
+    for level = #wheels, 1, -1 do
+        local wheel = wheels[level]
+        if wheel.count > 0 and tick % wheel.span == 0 then
+            local slots = wheel.slots
+            local slot_index = math.floor(tick / wheel.span) % wheel.size
+            local slot = slots[slot_index]
+            if slot then
+                slots[slot_index] = nil
+                wheel.count = wheel.count - #slot
+                self._COUNT = self._COUNT - #slot
+                if level == 1 then
+                    table.join2(self._EXPIRED, slot)
+                else
+                    for _, task in ipairs(slot) do
+                        self:_add(task)
+                    end
+                end
+            end
+        end
+    end
+    self._CURRENT = tick + 1
 end
 
 -- post a timer task after delay (auto-removed after expiration)
@@ -53,7 +162,7 @@ end
 function timer:post_at(func, when, period, opt)
     opt = opt or {}
     local task = {when = when, func = func, period = period, continuous = opt.continuous, cancel = false}
-    self:_tasks():push(task)
+    self:_add(task)
     return task
 end
 
@@ -71,78 +180,117 @@ end
 
 -- get the delay until the next task fires
 --
--- @return      the delay in milliseconds, or -1 if no tasks
+-- @return      the delay in milliseconds, or nil if no tasks
 --
 function timer:delay()
-    local delay = nil
-    local tasks = self:_tasks()
-    if tasks:length() > 0 then
-        local task = tasks:peek()
-        if task then
-            local now = os.mclock()
-            delay = task.when > now and task.when - now or 0
-        end
+    if self._EXPIRED_HEAD <= #self._EXPIRED then
+        return 0
+    end
+    local next_tick = self:_next_tick()
+    if next_tick then
+        local now = os.mclock()
+        return next_tick > now and next_tick - now or 0
     end
-    return delay
 end
 
 -- run the next timer loop, executing expired tasks
 function timer:next()
-    local tasks = self:_tasks()
-    while tasks:length() > 0 do
-        local triggered = false
-        local task = tasks:peek()
-        if task then
-            -- timeout or canceled?
-            if task.cancel or task.when <= os.mclock() then
-                tasks:pop()
-                if task.continuous and not task.cancel then
-                    task.when = os.mclock() + task.period
-                    tasks:push(task)
-                end
-                -- run timer task
-                if task.func then
-                    local ok, errors = task.func(task.cancel)
-                    if not ok then
-                        return false, errors
-                    end
-                    triggered = true
-                end
-            end
-        end
-        if not triggered then
+
+    -- process all ticks until now, we skip the empty ticks directly
+    local now = math.floor(os.mclock())
+    while true do
+        local next_tick = self:_next_tick()
+        if next_tick == nil or next_tick > now then
             break
         end
+        self:_process(next_tick)
+    end
+    if self._CURRENT <= now then
+        self._CURRENT = now + 1
+        self._NEXT_TICK = nil
     end
+
+    -- run all expired tasks, the new expired tasks may be added when running them
+    local expired = self._EXPIRED
+    while self._EXPIRED_HEAD <= #expired do
+        local head = self._EXPIRED_HEAD
+        local task = expired[head]
+        expired[head] = false
+        self._EXPIRED_HEAD = head + 1
+        if task.continuous and not task.cancel then
+            task.when = os.mclock() + task.period
+            self:_add(task)
+        end
+        if task.func then
+            self._FIRES = self._FIRES + 1
+            local ok, errors = task.func(task.cancel)
+            if not ok then
+                return false, errors
+            end
+        end
+    end
+    self._EXPIRED = {}
+    self._EXPIRED_HEAD = 1
     return true
 end
 
 -- kill all pending timer tasks
 function timer:kill()
-    local tasks = self:_tasks()
-    while tasks:length() > 0 do
-        local task = tasks:peek()
-        if task then
-            tasks:pop()
-            if task.func then
-                -- cancel it
-                task.func(true)
-            end
+    local tasks = {}
+    local expired = self._EXPIRED
+    for i = self._EXPIRED_HEAD, #expired do
+        table.insert(tasks, expired[i])
+    end
+    for _, wheel in ipairs(self._WHEELS) do
+        for _, slot in pairs(wheel.slots) do
+            table.join2(tasks, slot)
+        end
+    end
+    self:_clear()
+    for _, task in ipairs(tasks) do
+        if task.func then
+            -- cancel it
+            task.func(true)
         end
     end
 end
 
+-- get the pending task count
+function timer:count()
+    return self._COUNT + #self._EXPIRED - self._EXPIRED_HEAD + 1
+end
+
+-- get the fired task count
+function timer:fires()
+    return self._FIRES
+end
+
 -- get timer name
 function timer:name()
     return self._NAME
 end
 
+-- clear all timing wheels
+function timer:_clear()
+    local wheels = {}
+    local span = 1
+    for _, size in ipairs(timer._WHEEL_SIZES) do
+        table.insert(wheels, {span = span, size = size, slots = {}, count = 0})
+        span = span * size
+    end
+    self._WHEELS       = wheels
+    self._COUNT        = 0
+    self._EXPIRED      = {}
+    self._EXPIRED_HEAD = 1
+    self._NEXT_TICK    = nil
+end
+
 -- init timer
 function timer:init(name)
-    self._NAME  = name or "none"
-    self._TASKS = heap.valueheap {cmp = function(a, b)
-        return a.when < b.when
-    end}
+    self._NAME    = name or "none"
+    self._FIRES   = 0
+    self._CURRENT = math.floor(os.mclock())
+    self:_clear()
 end
 
 -- create a new timer
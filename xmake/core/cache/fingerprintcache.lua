@@ -0,0 +1,205 @@
+--!A cross-platform build utility based on Lua
+--
+-- Licensed under the Apache License, Version 2.0 (the "License");
+-- you may not use this file except in compliance with the License.
+-- You may obtain a copy of the License at
+--
+--     http://www.apache.org/licenses/LICENSE-2.0
+--
+-- Unless required by applicable law or agreed to in writing, software
+-- distributed under the License is distributed on an "AS IS" BASIS,
+-- WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+-- See the License for the specific language governing permissions and
+-- limitations under the License.
+--
+-- Copyright (C) 2015-present, Xmake Open Source Community.
+--
+-- @author      ruki
+-- @file        fingerprintcache.lua
+--
+
+-- define module: fingerprintcache
+--
+-- it caches the detection results of the tool programs in the global cache directory,
+-- so all projects can share them, e.g. the program version and the supported flags.
+--
+-- the results of each program are stored by the real program file,
+-- and they will be discarded if the program file has been changed (size/mtime), e.g. compiler upgrade.
+--
+-- @note we do not store the target triple of the program, so the callers need to add it to the result key
+-- if the result depends on it, e.g. has_flags uses plat/arch and the system flags (--target=, -m64, ..).
+--
+local fingerprintcache = fingerprintcache or {}
+
+-- load modules
+local os          = require("base/os")
+local path        = require("base/path")
+local hash        = require("base/hash")
+local table       = require("base/table")
+local option      = require("base/option")
+local globalcache = require("cache/globalcache")
+
+-- the cache name
+fingerprintcache._NAME = "fingerprint"
+
+-- get the real program file, it will search it from PATH and resolve all symlinks
+function fingerprintcache._programfile(program)
+    local programfile
+    if path.is_absolute(program) then
+        programfile = program
+    elseif program:find("[/\\]") then
+        programfile = path.absolute(program)
+    else
+        for _, dir in ipairs(path.splitenv(os.getenv("PATH"))) do
+            local filepath = path.join(dir, program)
+            if os.isexec(filepath) then
+                programfile = filepath
+                break
+            end
+            if os.host() == "windows" and os.isexec(filepath .. ".exe") then
+                programfile = filepath .. ".exe"
+                break
+            end
+        end
+    end
+    if programfile and os.isfile(programfile) then
+        -- e.g. /usr/bin/gcc -> gcc-13 -> x86_64-linux-gnu-gcc-13
+        local count = 0
+        while os.islink(programfile) and count < 32 do
+            local linkpath = os.readlink(programfile)
+            if not linkpath then
+                break
+            end
+            if not path.is_absolute(linkpath) then
+                linkpath = path.join(path.directory(programfile), linkpath)
+            end
+            programfile = path.normalize(linkpath)
+            count = count + 1
+        end
+        return programfile
+    end
+end
+
+-- get the program info, it will be reset if the program file has been changed
+function fingerprintcache._info(program)
+    local infos = fingerprintcache._INFOS
+    if infos == nil then
+        infos = {}
+        fingerprintcache._INFOS = infos
+    end
+    local info = infos[program]
+    if info == nil then
+        info = false
+        local programfile = fingerprintcache._programfile(program)
+        if programfile then
+            local fingerprint = string.format("%d_%d", os.filesize(programfile), os.mtime(programfile))
+            local cache = globalcache.cache(fingerprintcache._NAME)
+            info = cache:get(programfile)
+            if not info or info.fingerprint ~= fingerprint then
+                info = {fingerprint = fingerprint, results = {}}
+                cache:set(programfile, info)
+                fingerprintcache._DIRTY = true
+            end
+        end
+        infos[program] = info
+    end
+    return info or nil
+end
+
+-- get the fingerprint (size_mtime) of the given program file, e.g. "1034328_1707305428"
+--
+-- @param program   the program name or path
+--
+-- @return          the fingerprint, it will return nil if the program file is not found
+--
+function fingerprintcache.fingerprint(program)
+    local info = fingerprintcache._info(program)
+    if info then
+        return info.fingerprint
+    end
+end
+
+-- get the version output of the given program, it's only cached in memory
+--
+-- the program may be only a shim which runs the real compiler, e.g. /usr/bin/clang (xcrun) on macosx,
+-- its file is not changed after upgrading the real compiler, so we cannot store it to the global cache.
+--
+function fingerprintcache._version(program)
+    local versions = fingerprintcache._VERSIONS
+    if versions == nil then
+        versions = {}
+        fingerprintcache._VERSIONS = versions
+    end
+    local version = versions[program]
+    if version == nil then
+        local _, outdata, errdata = os.iorunv(program, {"--version"})
+        version = (outdata or "") .. (errdata or "")
+        versions[program] = version
+    end
+    return version
+end
+
+-- get the content digest of the given program
+--
+-- it's the same for the same program file on the different machines,
+-- so we can use it as the compiler identity of the shared build cache.
+--
+-- we also add the version output to it, because the program file may be only a shim of the real compiler.
+--
+function fingerprintcache.digest(program)
+    local info = fingerprintcache._info(program)
+    if info then
+        local digest = info.digest
+        if digest == nil then
+            digest = hash.xxhash128(fingerprintcache._programfile(program))
+            info.digest = digest
+            fingerprintcache._DIRTY = true
+        end
+        return hash.strhash128(digest .. fingerprintcache._version(program))
+    end
+end
+
+-- get the cached result of the given program
+--
+-- @param program   the program name or path
+-- @param key       the result key, e.g. "find_programver"
+--
+-- @return          the cached result, it's always nil if we force to check all again, e.g. `xmake f -c` or `xmake f --check`
+--
+function fingerprintcache.get(program, key)
+    if option.get("clean") or option.get("check") then
+        return
+    end
+    local info = fingerprintcache._info(program)
+    if info then
+        return info.results[key]
+    end
+end
+
+-- set the cached result of the given program, it will be ignored if the program file is not found
+function fingerprintcache.set(program, key, value)
+    local info = fingerprintcache._info(program)
+    if info and info.results[key] ~= value then
+        info.results[key] = value
+        fingerprintcache._DIRTY = true
+    end
+end
+
+-- save all changed results to the global cache directory
+function fingerprintcache.save()
+    if fingerprintcache._DIRTY then
+        globalcache.save(fingerprintcache._NAME)
+        fingerprintcache._DIRTY = false
+    end
+end
+
+-- clear all cached results
+function fingerprintcache.clear()
+    globalcache.clear(fingerprintcache._NAME)
+    fingerprintcache._INFOS = nil
+    fingerprintcache._VERSIONS = nil
+    fingerprintcache._DIRTY = true
+end
+
+-- return module: fingerprintcache
+return fingerprintcache
@@ -34,6 +34,8 @@ lz4._compress                = lz4._compress or lz4.compress
 lz4._decompress              = lz4._decompress or lz4.decompress
 lz4._block_compress          = lz4._block_compress or lz4.block_compress
 lz4._block_decompress        = lz4._block_decompress or lz4.block_decompress
+lz4._block_compress_batch    = lz4._block_compress_batch or lz4.block_compress_batch
+lz4._block_decompress_batch  = lz4._block_decompress_batch or lz4.block_decompress_batch
 lz4._compress_file           = lz4._compress_file or lz4.compress_file
 lz4._decompress_file         = lz4._decompress_file or lz4.decompress_file
 lz4._compress_stream_open    = lz4._compress_stream_open or lz4.compress_stream_open
@@ -383,5 +385,67 @@ function lz4.block_decompress(data, realsize, opt)
     return bytes(result)
 end
 
+-- compress the given blocks in parallel, each block is compressed independently
+--
+-- @param blocks        the block data list (strings)
+-- @param opt           the options, e.g. {threads = 8}
+--
+-- @return              the compressed block data list (strings)
+--
+function lz4.block_compress_batch(blocks, opt)
+    opt = opt or {}
+    local results, errors
+    if lz4._block_compress_batch then
+        results, errors = lz4._block_compress_batch(blocks, opt.threads or 0)
+    else
+        -- we need to be compatible with the old binary core
+        results = {}
+        for _, block in ipairs(blocks) do
+            local result
+            result, errors = lz4.block_compress(block)
+            if not result then
+                results = nil
+                break
+            end
+            table.insert(results, result:str())
+        end
+    end
+    if not results then
+        return nil, string.format("compress blocks failed, %s", errors or "unknown")
+    end
+    return results
+end
+
+-- decompress the given blocks in parallel
+--
+-- @param blocks        the compressed block data list (strings)
+-- @param realsizes     the decompressed real sizes
+-- @param opt           the options, e.g. {threads = 8}
+--
+-- @return              the decompressed block data list (strings)
+--
+function lz4.block_decompress_batch(blocks, realsizes, opt)
+    opt = opt or {}
+    local results, errors
+    if lz4._block_decompress_batch then
+        results, errors = lz4._block_decompress_batch(blocks, realsizes, opt.threads or 0)
+    else
+        results = {}
+        for idx, block in ipairs(blocks) do
+            local result
+            result, errors = lz4.block_decompress(bytes(block), realsizes[idx])
+            if not result then
+                results = nil
+                break
+            end
+            table.insert(results, result:str())
+        end
+    end
+    if not results then
+        return nil, string.format("decompress blocks failed, %s", errors or "unknown")
+    end
+    return results
+end
+
 -- return module: lz4
 return lz4
@@ -325,6 +325,12 @@ function main.entry()
             end
         end
 
+        -- prewarm the thread engines in background, e.g. XMAKE_THREAD_PREWARM=8
+        local prewarm = tonumber(os.getenv("XMAKE_THREAD_PREWARM"))
+        if prewarm and prewarm > 0 then
+            thread.prewarm(prewarm, {modules = {"sandbox/sandbox"}})
+        end
+
         -- show help?
         if main._show_help() then
             return main._exit(true)
@@ -343,6 +349,9 @@ function main.entry()
         end
     end
 
+    -- the heap growth of loading, e.g. XMAKE_PROFILE=mem
+    profiler:mem_leave("load")
+
     -- enable scheduler
     scheduler:enable(true)
 
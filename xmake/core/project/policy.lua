@@ -51,16 +51,35 @@ function policy.policies()
             ["build.across_targets_in_parallel"]  = {description = "Enable compile the source files for each target in parallel.", default = true, type = "boolean"},
             -- Merge archive intead of linking for all dependent targets
             ["build.merge_archive"]               = {description = "Enable merge archive intead of linking for all dependent targets.", default = false, type = "boolean"},
+            -- Only replace the changed object files in the existing static library instead of re-archiving all object files
+            ["build.archive.incremental"]         = {description = "Enable incremental archiving for static library.", default = false, type = "boolean"},
+            -- Generate thin static library, it only stores the paths of object files, e.g. ar -crT, llvm-ar --thin
+            ["build.archive.thin"]                = {description = "Enable thin archive for static library.", default = false, type = "boolean"},
+            -- Synthesize the precompiled header from the widely-included headers of the previous build
+            ["build.pcheader.auto"]               = {description = "Enable automatic precompiled header.", default = false, type = "boolean"},
             -- C/C++ build cache
             ["build.ccache"]                      = {description = "Enable C/C++ build cache.", type = "boolean"},
             -- Use global storage if build.ccache is enabled
             ["build.ccache.global_storage"]       = {description = "Use global storge if build.ccache is enabled.", type = "boolean"},
+            -- Set the copy strategy of the cached object files, e.g. auto (reflink/copy_file_range), copy, hardlink, symlink
+            ["build.ccache.copy_strategy"]        = {description = "Set the copy strategy of the cached object files.", type = "string", values = {"auto", "copy", "hardlink", "symlink"}},
+            -- Make the cache key independent of the project directory, and map the project directory in the object files,
+            -- so the different checkout directories (e.g. ci workspaces) can share the build cache
+            ["build.ccache.path_independent"]     = {description = "Make the build cache independent of the project directory.", type = "boolean"},
             -- Always update configfiles when building
             ["build.always_update_configfiles"]   = {description = "Always update configfiles when building.", type = "boolean"},
             -- Enable build warning output, it's enabled by default.
             ["build.warning"]                     = {description = "Enable build warning output.", default = true, type = "boolean"},
             -- Enable LTO linker-time optimization for c/c++ building.
             ["build.optimization.lto"]            = {description = "Enable LTO linker-time optimization for c/c++ building.", type = "boolean"},
+            -- Write the debug info to the .dwo files for gcc/clang, it will reduce the link time
+            ["build.debug.split_dwarf"]           = {description = "Enable split dwarf debug info for c/c++ building.", type = "boolean"},
+            -- Package all .dwo files to the .dwp file after linking
+            ["build.debug.split_dwarf.dwp"]       = {description = "Package the split dwarf debug info to the .dwp file after linking.", default = false, type = "boolean"},
+            -- Use the fastest available linker (mold/lld) with threaded linking for c/c++ building
+            ["build.linker.fast"]                 = {description = "Select the fastest available linker (mold/lld) for c/c++ building.", type = "boolean"},
+            -- Generate the clang time trace file (.json) next to each object file, we can analyze them by `xmake check build.time`
+            ["build.profile.ftime_trace"]         = {description = "Enable -ftime-trace for clang to profile the c/c++ build time.", type = "boolean"},
             -- Enable address sanitizer for c/c++ building.
             ["build.sanitizer.address"]           = {description = "Enable address sanitizer for c/c++ building.", type = "boolean"},
             -- Enable thread sanitizer for c/c++ building.
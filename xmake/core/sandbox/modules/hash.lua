@@ -97,6 +97,15 @@ function sandbox_hash.xxhash128(file_or_data)
     return result
 end
 
+-- generate hashes of the given files in parallel
+function sandbox_hash.files(files, opt)
+    local result, errors = hash.files(files, opt)
+    if not result then
+        raise("cannot generate hashes of files, %s", errors or "unknown errors")
+    end
+    return result
+end
+
 -- generate hash32 from string
 function sandbox_hash.strhash32(str)
     local result, errors = hash.strhash32(str)
@@ -98,5 +98,15 @@ function sandbox_core_base_binutils.extractlib(libraryfile, outputdir, opt)
     end
 end
 
+-- get all members of the static library
+function sandbox_core_base_binutils.armembers(libraryfile)
+    local members, errors = binutils.armembers(libraryfile)
+    if members then
+        return members
+    else
+        raise("armembers: %s", errors or "unknown errors")
+    end
+end
+
 -- return module
 return sandbox_core_base_binutils
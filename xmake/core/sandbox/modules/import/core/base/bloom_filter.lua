@@ -28,6 +28,10 @@ local raise        = require("sandbox/modules/raise")
 local sandbox_core_base_bloom_filter            = sandbox_core_base_bloom_filter or {}
 local sandbox_core_base_bloom_filter_instance   = sandbox_core_base_bloom_filter_instance or {}
 
+-- export the data versions
+sandbox_core_base_bloom_filter.VERSION_LEGACY  = bloom_filter.VERSION_LEGACY
+sandbox_core_base_bloom_filter.VERSION_BLOCKED = bloom_filter.VERSION_BLOCKED
+
 -- wrap bloom_filter
 function _bloom_filter_wrap(filter)
 
@@ -62,6 +66,23 @@ function sandbox_core_base_bloom_filter_instance.data_set(filter, data)
     end
 end
 
+-- get the delta data of bloom filter
+function sandbox_core_base_bloom_filter_instance.delta(filter)
+    local data, errors = filter:_delta()
+    if not data and errors then
+        raise(errors)
+    end
+    return data
+end
+
+-- merge the data of the other bloom filter
+function sandbox_core_base_bloom_filter_instance.merge(filter, data)
+    local ok, errors = filter:_merge(data)
+    if not ok and errors then
+        raise(errors)
+    end
+end
+
 -- set bloom filter item
 function sandbox_core_base_bloom_filter_instance.set(filter, item)
     local ok, result_or_errors = filter:_set(item)
@@ -55,6 +55,15 @@ function sandbox_core_base_fwatcher.wait(timeout)
     return ok, event_or_errors
 end
 
+-- wait and coalesce events
+function sandbox_core_base_fwatcher.wait_events(timeout, opt)
+    local count, events_or_errors = fwatcher.wait_events(timeout, opt)
+    if count < 0 and events_or_errors then
+        raise(events_or_errors)
+    end
+    return count, events_or_errors
+end
+
 -- watch watchdirs
 function sandbox_core_base_fwatcher.watchdirs(watchdirs, callback, opt)
     local ok, errors = fwatcher.watchdirs(watchdirs, callback, opt)
@@ -35,6 +35,16 @@ function sandbox_core_base_profiler.leave(name, ...)
     profiler:leave(name, ...)
 end
 
+-- enter memory phase
+function sandbox_core_base_profiler.mem_enter(phase)
+    profiler:mem_enter(phase)
+end
+
+-- leave memory phase
+function sandbox_core_base_profiler.mem_leave(phase)
+    profiler:mem_leave(phase)
+end
+
 -- return module
 return sandbox_core_base_profiler
 
@@ -284,6 +284,16 @@ function sandbox_core_base_thread.running()
     return instance
 end
 
+-- prewarm the thread engines in background
+function sandbox_core_base_thread.prewarm(count, opt)
+    return thread.prewarm(count, opt)
+end
+
+-- get the stats of the thread engine pool
+function sandbox_core_base_thread.pool_stats()
+    return thread.pool_stats()
+end
+
 -- open a mutex
 function sandbox_core_base_thread.mutex(name)
     local mutex, errors = thread.mutex(name)
@@ -145,6 +145,24 @@ function sandbox_core_compress_lz4.block_decompress(data, realsize, opt)
     return result
 end
 
+-- compress blocks in parallel
+function sandbox_core_compress_lz4.block_compress_batch(blocks, opt)
+    local result, errors = lz4.block_compress_batch(blocks, opt)
+    if not result and errors then
+        raise(errors)
+    end
+    return result
+end
+
+-- decompress blocks in parallel
+function sandbox_core_compress_lz4.block_decompress_batch(blocks, realsizes, opt)
+    local result, errors = lz4.block_decompress_batch(blocks, realsizes, opt)
+    if not result and errors then
+        raise(errors)
+    end
+    return result
+end
+
 -- new compress stream
 function sandbox_core_compress_lz4.compress_stream(opt)
     local result, errors = lz4.compress_stream(opt)
@@ -31,6 +31,7 @@ local semver      = require("base/semver")
 local profiler    = require("base/profiler")
 local project     = require("project/project")
 local detectcache = require("cache/detectcache")
+local fingerprintcache = require("cache/fingerprintcache")
 local sandbox     = require("sandbox/sandbox")
 local raise       = require("sandbox/modules/raise")
 local scheduler   = require("sandbox/modules/import/core/base/scheduler")
@@ -73,11 +74,30 @@ function sandbox_lib_detect_find_programver.main(program, opt)
         return result and result or nil
     end
 
+    -- attempt to get result from the global fingerprint cache, it's shared by all projects
+    --
+    -- we cannot cache the result of the custom command/parse scripts,
+    -- because we do not know whether they are changed.
+    --
+    local command = opt.command
+    local fingerprintkey
+    if type(command) ~= "function" and type(opt.parse) ~= "function" then
+        fingerprintkey = cachekey .. "_" .. (type(command) == "table" and table.concat(command, " ") or (command or "--version"))
+                      .. "_" .. (opt.parse or "")
+        if not opt.force then
+            result = fingerprintcache.get(program, fingerprintkey)
+            if result ~= nil then
+                detectcache:set2(cachekey, program, result)
+                scheduler.co_unlock(lockname)
+                return result and result or nil
+            end
+        end
+    end
+
     -- attempt to get version output info
     profiler:enter("find_programver", program)
     local ok = false
     local outdata = nil
-    local command = opt.command
     if type(command) == "function" then
         ok, outdata = sandbox.call(command)
         if not ok and outdata and option.get("diagnosis") then
@@ -109,6 +129,9 @@ function sandbox_lib_detect_find_programver.main(program, opt)
 
     -- save result
     detectcache:set2(cachekey, program, result and result or false)
+    if fingerprintkey then
+        fingerprintcache.set(program, fingerprintkey, result and result or false)
+    end
     scheduler.co_unlock(lockname)
     return result
 end
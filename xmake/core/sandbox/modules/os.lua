@@ -53,6 +53,7 @@ sandbox_os.args         = os.args
 sandbox_os.args         = os.args
 sandbox_os.argv         = os.argv
 sandbox_os.mtime        = os.mtime
+sandbox_os.stats        = os.stats
 sandbox_os.raise        = os.raise
 sandbox_os.fscase       = os.fscase
 sandbox_os.isroot       = os.isroot
@@ -71,6 +72,7 @@ sandbox_os.pbpaste      = os.pbpaste
 sandbox_os.pbcopy       = os.pbcopy
 sandbox_os.cpuinfo      = os.cpuinfo
 sandbox_os.meminfo      = os.meminfo
+sandbox_os.memstats     = os.memstats
 sandbox_os.default_njob = os.default_njob
 sandbox_os.emptydir     = os.emptydir
 sandbox_os.filesize     = os.filesize
@@ -227,7 +227,11 @@ function builder:_add_flags_from_targetpkgs(flags, target)
 end
 
 -- add flags from the target
-function builder:_add_flags_from_target(flags, target)
+--
+-- @param opt   the options, e.g. {pcheader = false} to omit the precompiled header flags
+--
+function builder:_add_flags_from_target(flags, target, opt)
+    opt = opt or {}
 
     -- no target?
     if not target then
@@ -246,12 +250,15 @@ function builder:_add_flags_from_target(flags, target)
 
     -- get flags from cache first
     local key = target:cachekey()
+    if opt.pcheader == false then
+        key = key .. "/nopcheader"
+    end
     local targetflags = cache[key]
     if not targetflags then
 
         -- add flags from language
         targetflags = {}
-        self:_add_flags_from_language(targetflags, {target = target})
+        self:_add_flags_from_language(targetflags, {target = target, pcheader = opt.pcheader})
 
         -- add flags for the target
         if target_type == "target" then
@@ -441,8 +448,12 @@ function builder:_add_flags_from_language(flags, opt)
             end
         end
 
-        -- map named flags to real flags
+        -- map named flags to real flags, we need to omit the precompiled header flags if pcheader is false
         local mapper = self:_tool()["nf_" .. apiname]
+        if mapper and opt.pcheader == false and (flagname == "pcheader" or flagname == "pcxxheader"
+                or flagname == "pmheader" or flagname == "pmxxheader") then
+            mapper = nil
+        end
         if mapper then
             local opt_ = {target = target, check = checkstate, multival = multival, mapper = mapper}
             if opt.getters then
@@ -297,7 +297,9 @@ function compiler:compile(sourcefiles, objectfile, opt)
     opt = table.copy(opt)
     opt.target = self:target()
     profiler:enter(self:name(), "compile", sourcefiles)
+    profiler:mem_enter("compile")
     local ok, errors = sandbox.call(self:_tool().compile, self:_tool(), sourcefiles, objectfile, opt.dependinfo, compflags, opt)
+    profiler:mem_leave("compile")
     profiler:leave(self:name(), "compile", sourcefiles)
     return ok, errors
 end
@@ -329,6 +331,9 @@ end
 --              e.g.
 --              {target = ..., targetkind = "static", configs = {defines = "", cxflags = "", includedirs = ""}}
 --
+--              we can pass `pcheader = false` to omit the precompiled header flags,
+--              it's also omitted if the given sourcefile does not use the automatic precompiled header.
+--
 -- @return      flags list
 --
 function compiler:compflags(opt)
@@ -341,6 +346,16 @@ function compiler:compflags(opt)
         targetkind = target:kind()
     end
 
+    -- use the precompiled header?
+    -- @see private.action.build.pcheader
+    local pcheader = opt.pcheader
+    if pcheader == nil and opt.sourcefile and target and target:type() == "target" then
+        local excluded = target:data("pcheader.auto.excluded")
+        if excluded and excluded[opt.sourcefile] then
+            pcheader = false
+        end
+    end
+
     -- add flags from compiler/toolchains
     --
     -- we need to add toolchain flags at the beginning to allow users to override them.
@@ -353,7 +368,7 @@ function compiler:compflags(opt)
     self:_add_flags_from_toolchains(flags, targetkind, target)
 
     -- add flags from target
-    self:_add_flags_from_target(flags, target)
+    self:_add_flags_from_target(flags, target, {pcheader = pcheader})
 
     -- add flags from source file configuration
     if opt.sourcefile and target and target.fileconfig then
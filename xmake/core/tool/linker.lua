@@ -242,9 +242,11 @@ function linker:link(objectfiles, targetfile, opt)
     opt = opt or {}
     local linkflags = opt.linkflags or self:linkflags(opt)
     profiler:enter(self:name(), "link", targetfile)
+    profiler:mem_enter("link")
     local ok, errors = sandbox.call(self:_tool().link, self:_tool(),
         table.wrap(objectfiles), self:_targetkind(), targetfile, linkflags,
         table.join(opt, {target = self:target()}))
+    profiler:mem_leave("link")
     profiler:leave(self:name(), "link", targetfile)
     return ok, errors
 end
@@ -440,6 +440,7 @@ function _consume_jobs_loop(state, run_in_remote)
                 co_running:data_set("runjobs.running", true)
                 local job_index = state.finished_count + 1
                 state.running_jobs_indices[job_index] = job_index
+                state.running_count = state.running_count + 1
                 if job_func then
                     if curdir then
                         os.cd(curdir)
@@ -458,13 +459,14 @@ function _consume_jobs_loop(state, run_in_remote)
                         end
                     end
 
-                    -- run job
-                    job_func(job_index, total, {progress = state.progress_wrapper})
+                    -- run job, the free job slots (including the current job) can be used by the job itself, e.g. the linker threads
+                    job_func(job_index, total, {progress = state.progress_wrapper, freejobs = state.comax - state.running_count + 1})
 
                     -- update progress
                     state.progress_finished_count = state.progress_finished_count + 1
                 end
                 state.running_jobs_indices[job_index] = nil
+                state.running_count = state.running_count - 1
                 co_running:data_set("runjobs.running", false)
             end,
             catch
@@ -525,7 +527,7 @@ end
 --
 -- local jobs = jobpool.new()
 -- local root = jobs:addjob("job/root", function (index, total, opt)
---   print(index, total, opt.progress)
+--   print(index, total, opt.progress, opt.freejobs)
 -- end)
 -- for i = 1, 3 do
 --     local job = jobs:addjob("job/" .. i, function (index, total, opt)
@@ -549,6 +551,7 @@ function main(name, jobs, opt)
     state.jobs_cb = type(jobs) == "function" and jobs or nil
     state.stop = false
     state.running_jobs_indices = {}
+    state.running_count = 0
     assert(state.timeout < 60000, "runjobs: invalid timeout!")
 
     -- build jobs queue
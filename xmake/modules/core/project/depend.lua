@@ -87,6 +87,45 @@ function _is_show_diagnosis_info()
     return show
 end
 
+-- get the cached mtimes of the given files for timecache
+--
+-- we stat all uncached files in one call to warm up the time cache,
+-- the stat results will be reused by the other objects depending on the same headers.
+--
+-- @param files         the file list
+--
+-- @return              the cached file mtimes, e.g. {["src/foo.c"] = 1712345678}
+--
+function _get_files_mtime(files)
+    local files_mtime = _g.files_mtime
+    if files_mtime == nil then
+        files_mtime = {}
+        _g.files_mtime = files_mtime
+    end
+    local uncached_files
+    for _, file in ipairs(files) do
+        if files_mtime[file] == nil then
+            uncached_files = uncached_files or {}
+            table.insert(uncached_files, file)
+        end
+    end
+    if uncached_files then
+        local mtimes = os.stats(uncached_files, {fields = {"mtime"}}).mtime
+        for idx, file in ipairs(uncached_files) do
+            files_mtime[file] = mtimes[idx]
+        end
+    end
+    return files_mtime
+end
+
+-- clear the cached file mtimes of timecache
+--
+-- we need to clear it if we build files again in the same process, e.g. `xmake watch`
+--
+function clear_timecache()
+    _g.files_mtime = nil
+end
+
 -- save dependent info to file
 --
 -- @param dependinfo    the depend info table {files = {}, values = {}}
@@ -122,25 +161,18 @@ function is_changed(dependinfo, opt)
     end
 
     -- check whether the dependent files are changed
-    local timecache = opt.timecache
     local lastmtime = opt.lastmtime or 0
-    _g.files_mtime = _g.files_mtime or {}
-    local files_mtime = _g.files_mtime
+    local files_mtime = opt.timecache and _get_files_mtime(files) or nil
     for _, file in ipairs(files) do
 
-        -- get and cache the file mtime
+        -- source and header files have been changed or not exists?
+        -- we need not stat the remaining files if no time cache, because we will return at the first changed file.
         local mtime
-        if timecache then
+        if files_mtime then
             mtime = files_mtime[file]
-            if mtime == nil then
-                mtime = os.mtime(file)
-                files_mtime[file] = mtime
-            end
         else
             mtime = os.mtime(file)
         end
-
-        -- source and header files have been changed or not exists?
         if mtime == 0 or mtime > lastmtime then
             if _is_show_diagnosis_info() then
                 cprint("${color.warning}[check_build_deps]: file %s is changed, mtime: %s, lastmtime: %s", file, mtime, lastmtime)
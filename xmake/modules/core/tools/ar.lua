@@ -37,9 +37,45 @@ function strip(self, level)
     return maps[level]
 end
 
+-- get the flags of thin archive, e.g. -cr -> -crT
+function _get_thinflags(flags)
+    local result = {}
+    local found = false
+    for _, flag in ipairs(flags) do
+        if not found and flag:find("^%-?%a*r%a*$") then
+            if not flag:find("T", 1, true) then
+                flag = flag .. "T"
+            end
+            found = true
+        end
+        table.insert(result, flag)
+    end
+    return result
+end
+
+-- has the thin archive flag?
+--
+-- only gnu ar and llvm-ar support the `T` modifier, e.g. the bsd ar on macos does not support it,
+-- so we check it by the version info, and we cache the result for each program.
+--
+function _has_thinflags(self)
+    local program = self:program()
+    _g.thinflags = _g.thinflags or {}
+    local result = _g.thinflags[program]
+    if result == nil then
+        local versioninfo = try {function () return os.iorunv(program, {"--version"}, {envs = self:runenvs()}) end}
+        result = versioninfo and (versioninfo:find("GNU ar", 1, true) or versioninfo:find("LLVM", 1, true)) and true or false
+        _g.thinflags[program] = result
+    end
+    return result
+end
+
 -- make the link arguments list
 function linkargv(self, objectfiles, targetkind, targetfile, flags, opt)
     opt = opt or {}
+    if opt.thin and _has_thinflags(self) then
+        flags = _get_thinflags(flags)
+    end
     local argv = table.join(flags, targetfile, objectfiles)
     if is_host("windows") and not opt.rawargs then
         argv = winos.cmdargv(argv, {escape = true})
@@ -52,8 +88,11 @@ function link(self, objectfiles, targetkind, targetfile, flags, opt)
     opt = opt or {}
     os.mkdir(path.directory(targetfile))
 
-    -- @note remove the previous archived file first to force recreating a new file
-    os.tryrm(targetfile)
+    -- @note remove the previous archived file first to force recreating a new file,
+    -- but we only replace the changed members of the existing archive in incremental mode
+    if not opt.incremental then
+        os.tryrm(targetfile)
+    end
 
     -- link it
     local program, argv = linkargv(self, objectfiles, targetkind, targetfile, flags, opt)
@@ -22,6 +22,7 @@
 inherit("gcc")
 import("core.language.language")
 import("private.utils.toolchain", {alias = "toolchain_utils"})
+import("utils.checker")
 
 -- init it
 function init(self)
@@ -369,3 +370,37 @@ function nf_pmxxheader(self, pcheaderfile, opt)
         return {"-include", pcheaderfile, "-include-pch", pcoutputfile}
     end
 end
+
+-- get the time trace flags
+--
+-- clang will generate the time trace file next to the object file, e.g. foo.cpp.o -> foo.cpp.json
+-- @see https://clang.llvm.org/docs/ClangCommandLineReference.html#cmdoption-clang-ftime-trace
+--
+function _get_timetrace_flags(self, target)
+    local kind = self:kind()
+    if (kind == "cc" or kind == "cxx" or kind == "mm" or kind == "mxx") and target and target:type() == "target"
+        and target:policy("build.profile.ftime_trace") and not checker.is_running("syntax") then
+        local timetrace_flags = _g._TIMETRACE_FLAGS
+        if timetrace_flags == nil then
+            timetrace_flags = self:has_flags("-ftime-trace", "cxflags") and {"-ftime-trace"} or false
+            _g._TIMETRACE_FLAGS = timetrace_flags
+        end
+        return timetrace_flags or nil
+    end
+end
+
+-- compile the source file
+--
+-- we only add the time trace flags when compiling it locally, so they will not be added to compargv,
+-- e.g. compile_commands.json and build.ninja.
+--
+-- the policy state is added to the depend values of the object file, @see private.action.build.object
+--
+function compile(self, sourcefile, objectfile, dependinfo, flags, opt)
+    opt = opt or {}
+    local timetrace_flags = _get_timetrace_flags(self, opt.target)
+    if timetrace_flags then
+        flags = table.join(flags, timetrace_flags)
+    end
+    return _super.compile(self, sourcefile, objectfile, dependinfo, flags, opt)
+end
@@ -137,6 +137,30 @@ function _has_gnu_line_marker_flag(self)
     return gnu_line_marker
 end
 
+-- get the flag to map the project directory in the object files, e.g. -ffile-prefix-map=/home/runner/work/foo=.
+function _get_prefixmap_flag(self)
+    local prefixmap_flags = _g._PREFIXMAP_FLAGS
+    if prefixmap_flags == nil then
+        prefixmap_flags = {}
+        _g._PREFIXMAP_FLAGS = prefixmap_flags
+    end
+    local program = self:program()
+    local prefixmap_flag = prefixmap_flags[program]
+    if prefixmap_flag == nil then
+        local projectdir = os.projectdir()
+        for _, name in ipairs({"-ffile-prefix-map", "-fdebug-prefix-map"}) do
+            local flag = name .. "=" .. projectdir .. "=."
+            if self:has_flags(flag, "cxflags") then
+                prefixmap_flag = flag
+                break
+            end
+        end
+        prefixmap_flag = prefixmap_flag or false
+        prefixmap_flags[program] = prefixmap_flag
+    end
+    return prefixmap_flag or nil
+end
+
 -- get preprocess file path
 function _get_cppfile(sourcefile, objectfile)
     return path.join(path.directory(objectfile), "__cpp_" .. path.basename(objectfile) .. path.extension(sourcefile))
@@ -318,6 +342,17 @@ end
 function _compile(self, sourcefile, objectfile, compflags, opt)
     opt = opt or {}
     local program, argv = compargv(self, sourcefile, objectfile, compflags, opt)
+    local build_cache_enabled = build_cache.is_enabled(opt.target) and build_cache.is_supported(self:kind())
+    local path_independent = false
+    if build_cache_enabled and build_cache.is_path_independent() then
+        -- map the project directory, so the cached object files can be shared by the different directories
+        local prefixmap_flag = _get_prefixmap_flag(self)
+        if prefixmap_flag then
+            argv = table.copy(argv)
+            table.insert(argv, #argv - 2, prefixmap_flag)
+            path_independent = true
+        end
+    end
     local function _compile_fallback()
         local runargv = argv
         if is_host("windows") then
@@ -325,15 +360,26 @@ function _compile(self, sourcefile, objectfile, compflags, opt)
         end
         return os.iorunv(program, runargv, {envs = self:runenvs(), shell = opt.shell})
     end
+    -- the split dwarf file (.dwo) is generated next to the object file,
+    -- we cannot get it back from the remote machine, so we only compile it locally.
+    local dwofile
+    if table.contains(argv, "-gsplit-dwarf") then
+        dwofile = path.join(path.directory(objectfile), path.basename(objectfile) .. ".dwo")
+    end
+    -- the time trace file (.json) of clang needs the real header files and it cannot be cached,
+    -- so we always compile the original source file locally.
+    local timetrace = table.contains(argv, "-ftime-trace")
     local cppinfo
-    if distcc_build_client.is_distccjob() and distcc_build_client.singleton():has_freejobs() then
+    if timetrace then
+        cppinfo = nil
+    elseif not dwofile and distcc_build_client.is_distccjob() and distcc_build_client.singleton():has_freejobs() then
         cppinfo = distcc_build_client.singleton():compile(program, argv, {envs = self:runenvs(),
             preprocess = _preprocess, compile = _compile_preprocessed_file, compile_fallback = _compile_fallback,
             tool = self, remote = true, shell = opt.shell})
-    elseif build_cache.is_enabled(opt.target) and build_cache.is_supported(self:kind()) then
+    elseif build_cache_enabled then
         cppinfo = build_cache.build(program, argv, {envs = self:runenvs(),
             preprocess = _preprocess, compile = _compile_preprocessed_file, compile_fallback = _compile_fallback,
-            tool = self, shell = opt.shell})
+            tool = self, shell = opt.shell, dwofile = dwofile, path_independent = path_independent})
     end
     if cppinfo then
         return cppinfo.outdata, cppinfo.errdata
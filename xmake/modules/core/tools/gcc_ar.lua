@@ -61,8 +61,11 @@ function link(self, objectfiles, targetkind, targetfile, flags, opt)
     opt = opt or {}
     os.mkdir(path.directory(targetfile))
 
-    -- @note remove the previous archived file first to force recreating a new file
-    os.tryrm(targetfile)
+    -- @note remove the previous archived file first to force recreating a new file,
+    -- but we only replace the changed members of the existing archive in incremental mode
+    if not opt.incremental then
+        os.tryrm(targetfile)
+    end
 
     -- generate link arguments
     local program, argv = linkargv(self, objectfiles, targetkind, targetfile, flags, opt)
@@ -136,6 +136,10 @@ end
 -- make the link arguments list
 function linkargv(self, objectfiles, targetkind, targetfile, flags, opt)
     opt = opt or {}
+    -- we pass the existing library as input to replace the changed members in incremental mode
+    if targetkind == "static" and opt.incremental and os.isfile(targetfile) then
+        objectfiles = table.join(targetfile, objectfiles)
+    end
     local argv = table.join(flags, "-out:" .. targetfile, objectfiles)
     if not opt.rawargs then
         argv = winos.cmdargv(argv)
@@ -39,6 +39,9 @@ end
 function linkargv(self, objectfiles, targetkind, targetfile, flags, opt)
     assert(targetkind == "static")
     opt = opt or {}
+    if opt.thin then
+        flags = table.join(flags, "--thin")
+    end
     local argv = table.join(flags, targetfile, objectfiles)
     if is_host("windows") and not opt.rawargs then
         argv = winos.cmdargv(argv, {escape = true})
@@ -47,11 +50,15 @@ function linkargv(self, objectfiles, targetkind, targetfile, flags, opt)
 end
 
 -- link the library file
-function link(self, objectfiles, targetkind, targetfile, flags)
+function link(self, objectfiles, targetkind, targetfile, flags, opt)
+    opt = opt or {}
     assert(targetkind == "static", "the target kind: %s is not support for ar", targetkind)
     os.mkdir(path.directory(targetfile))
-    -- @note remove the previous archived file first to force recreating a new file
-    os.tryrm(targetfile)
-    os.runv(linkargv(self, objectfiles, targetkind, targetfile, flags))
+    -- @note remove the previous archived file first to force recreating a new file,
+    -- but we only replace the changed members of the existing archive in incremental mode
+    if not opt.incremental then
+        os.tryrm(targetfile)
+    end
+    os.runv(linkargv(self, objectfiles, targetkind, targetfile, flags, opt))
 end
 
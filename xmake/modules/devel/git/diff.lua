@@ -0,0 +1,73 @@
+--!A cross-platform build utility based on Lua
+--
+-- Licensed under the Apache License, Version 2.0 (the "License");
+-- you may not use this file except in compliance with the License.
+-- You may obtain a copy of the License at
+--
+--     http://www.apache.org/licenses/LICENSE-2.0
+--
+-- Unless required by applicable law or agreed to in writing, software
+-- distributed under the License is distributed on an "AS IS" BASIS,
+-- WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+-- See the License for the specific language governing permissions and
+-- limitations under the License.
+--
+-- Copyright (C) 2015-present, Xmake Open Source Community.
+--
+-- @author      ruki
+-- @file        diff.lua
+--
+
+-- imports
+import("core.base.option")
+import("lib.detect.find_tool")
+
+-- get the changed files between the given ref and the working tree
+--
+-- @param ref       the git ref, e.g. origin/master, HEAD~1
+-- @param opt       the options, e.g. {repodir = ..}
+--
+-- @return          the absolute paths of the changed files, or nil and errors
+--
+-- @code
+--
+-- import("devel.git")
+--
+-- local files = git.diff("origin/master", {repodir = ..})
+--
+-- @endcode
+--
+function main(ref, opt)
+    opt = opt or {}
+
+    -- find git
+    local git = assert(find_tool("git"), "git not found!")
+
+    -- the git ref is valid?
+    local ok = try {function ()
+        os.iorunv(git.program, {"rev-parse", "--verify", "--quiet", ref .. "^{commit}"}, {curdir = opt.repodir})
+        return true
+    end}
+    if not ok then
+        return nil, string.format("invalid git ref(%s)!", ref)
+    end
+
+    -- get the root directory of repository, the paths of git diff are relative to it
+    local rootdir = os.iorunv(git.program, {"rev-parse", "--show-toplevel"}, {curdir = opt.repodir})
+    rootdir = rootdir:trim()
+
+    -- get the changed files, it also contains the deleted files
+    local argv = {"-c", "core.quotepath=false", "diff", "--name-only", "--no-renames", ref}
+    if option.get("verbose") then
+        print("%s %s", git.program, os.args(argv))
+    end
+    local files = {}
+    local result = os.iorunv(git.program, argv, {curdir = opt.repodir})
+    for _, line in ipairs(result:split("\n")) do
+        line = line:trim()
+        if #line > 0 then
+            table.insert(files, path.join(rootdir, line))
+        end
+    end
+    return files
+end
@@ -21,6 +21,7 @@
 -- imports
 import("lib.detect.find_tool")
 import("core.base.scheduler")
+import("core.cache.fingerprintcache")
 
 -- get all features of the current tool
 --
@@ -74,6 +75,19 @@ function main(name, opt)
         return result
     end
 
+    -- get result from the global fingerprint cache, it's shared by all projects
+    --
+    -- the checked features may be changed in the new xmake version, so we need to add the xmake version to key.
+    --
+    local fingerprintkey = "lib.detect.features_" .. tool.name .. "_" .. xmake.version():shortstr()
+                        .. "_" .. table.concat(table.wrap(opt.flags), ",")
+    result = fingerprintcache.get(tool.program, fingerprintkey)
+    if result ~= nil then
+        results[key] = result
+        scheduler.co_unlock(key)
+        return result
+    end
+
     -- core.tools.xxx.features(opt)?
     local features = import("core.tools." .. tool.name .. ".features", {try = true})
     if features then
@@ -82,6 +96,7 @@ function main(name, opt)
 
     result = result or {}
     results[key] = result
+    fingerprintcache.set(tool.program, fingerprintkey, result)
     scheduler.co_unlock(key)
     return result
 end
@@ -24,8 +24,30 @@ import("core.base.scheduler")
 import("core.base.profiler")
 import("core.project.config")
 import("core.cache.detectcache")
+import("core.cache.fingerprintcache")
 import("lib.detect.find_tool")
 
+-- get the key of the global fingerprint cache
+--
+-- the results of the same program are shared by all projects, so we need not the program path,
+-- but the run environments may change the results, e.g. the sysroot of msvc.
+--
+function _get_fingerprintkey(key, opt)
+    if opt.on_check or opt.snippet then
+        return
+    end
+    local envs = opt.envs
+    if envs and not table.empty(envs) then
+        local items = {}
+        for name, value in pairs(envs) do
+            table.insert(items, name .. "=" .. table.concat(table.wrap(value), path.envsep()))
+        end
+        table.sort(items)
+        key = key .. "_" .. hash.strhash32(table.concat(items, "\n"))
+    end
+    return "lib.detect.has_flags_" .. key
+end
+
 -- has the given flags for the current tool?
 --
 -- @param name      the tool name
@@ -100,6 +122,18 @@ function main(name, flags, opt)
         return result
     end
 
+    -- attempt to get result from the global fingerprint cache, it's shared by all projects
+    local fingerprintkey = _get_fingerprintkey(plat .. "_" .. arch .. "_" .. (opt.toolkind or "")
+        .. "_" .. (opt.flagkind or "") .. "_" .. table.concat(opt.sysflags, " ") .. "_" .. opt.flagskey, opt)
+    if fingerprintkey and not opt.force then
+        result = fingerprintcache.get(tool.program, fingerprintkey)
+        if result ~= nil then
+            cacheinfo[key] = result
+            scheduler.co_unlock(key)
+            return result
+        end
+    end
+
     -- generate all checked flags
     local checkflags = table.join(flags, opt.sysflags)
 
@@ -150,6 +184,9 @@ function main(name, flags, opt)
     -- save result to cache
     cacheinfo[key] = result
     detectcache:set("lib.detect.has_flags", cacheinfo)
+    if fingerprintkey then
+        fingerprintcache.set(tool.program, fingerprintkey, result)
+    end
     scheduler.co_unlock(key)
     return result
 end
@@ -0,0 +1,184 @@
+--!A cross-platform build utility based on Lua
+--
+-- Licensed under the Apache License, Version 2.0 (the "License");
+-- you may not use this file except in compliance with the License.
+-- You may obtain a copy of the License at
+--
+--     http://www.apache.org/licenses/LICENSE-2.0
+--
+-- Unless required by applicable law or agreed to in writing, software
+-- distributed under the License is distributed on an "AS IS" BASIS,
+-- WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+-- See the License for the specific language governing permissions and
+-- limitations under the License.
+--
+-- Copyright (C) 2015-present, Xmake Open Source Community.
+--
+-- @author      ruki
+-- @file        affected.lua
+--
+
+-- imports
+import("core.base.hashset")
+import("core.project.project")
+import("devel.git")
+import("private.action.build.depindex")
+
+-- get the key of file path
+function _get_filekey(filepath)
+    filepath = path.absolute(filepath, project.directory())
+    if is_host("windows") then
+        filepath = filepath:lower()
+    end
+    return filepath
+end
+
+-- add the affected target
+function _add_target(affected, target, reason)
+    if not affected[target] then
+        affected[target] = reason
+        vprint("%s: affected by %s", target:fullname(), reason)
+    end
+end
+
+-- get the changed files from the given value
+--
+-- @param value     the file list, a list file (@files.txt) or a git ref, e.g.
+--                  - "src/foo.c" .. path.envsep() .. "src/foo.h"
+--                  - "@changed_files.txt"
+--                  - "origin/master"
+--
+-- @return          the absolute paths of the changed files
+--
+function changed_files(value)
+    if value:startswith("@") then
+        local listfile = value:sub(2)
+        assert(os.isfile(listfile), "%s not found!", listfile)
+        local files = {}
+        for _, line in ipairs(io.readfile(listfile):split("\n")) do
+            line = line:trim()
+            if #line > 0 then
+                table.insert(files, path.absolute(line))
+            end
+        end
+        return files
+    end
+
+    -- is it a git ref? the changed file may have been removed, so we only check the single item
+    local files = path.splitenv(value)
+    if #files == 1 and not os.exists(value) then
+        local gitfiles = git.diff(value, {repodir = project.directory()})
+        if gitfiles then
+            return gitfiles
+        end
+    end
+    for idx, file in ipairs(files) do
+        files[idx] = path.absolute(file)
+    end
+    return files
+end
+
+-- get the affected targets of the given changed files
+--
+-- we map the source files, the headers recorded in the dependfiles and
+-- the xmake.lua scopes to targets, and all their dependents are also affected.
+--
+-- the unmapped files may be included by the targets without the dependfiles (not built yet),
+-- so these targets are also affected.
+--
+-- @param files     the changed files
+-- @param opt       the options, e.g. {targets = {target, ..}}
+--
+-- @return          the affected targets in dependency order
+--
+function targets(files, opt)
+    opt = opt or {}
+    local targets_all = opt.targets or project.ordertargets()
+
+    -- get the changed files
+    local changed = hashset.new()
+    for _, file in ipairs(files) do
+        changed:insert(_get_filekey(file))
+    end
+
+    -- the project files are changed? e.g. xmake.lua, the included lua files
+    --
+    -- the targets are affected if their own xmake.lua is changed, and all targets are affected
+    -- if the root xmake.lua or other included files (e.g. rules, options) are changed.
+    local affected = {}
+    local mapped = hashset.new()
+    local rootfile = _get_filekey(project.rootfile())
+    for _, projectfile in ipairs(project.allfiles()) do
+        local filekey = _get_filekey(projectfile)
+        if changed:has(filekey) then
+            mapped:insert(filekey)
+            local scope_targets = {}
+            if filekey ~= rootfile and path.filename(projectfile) == "xmake.lua" then
+                local scriptdir = path.directory(filekey)
+                for _, target in ipairs(targets_all) do
+                    if target:scriptdir() and _get_filekey(target:scriptdir()) == scriptdir then
+                        table.insert(scope_targets, target)
+                    end
+                end
+            end
+            if #scope_targets == 0 then
+                scope_targets = targets_all
+            end
+            for _, target in ipairs(scope_targets) do
+                _add_target(affected, target, path.relative(projectfile, project.directory()))
+            end
+        end
+    end
+
+    -- the source files and the header files are changed?
+    for _, target in ipairs(targets_all) do
+        for _, file in ipairs(table.join(target:sourcefiles(), (target:headerfiles()))) do
+            local filekey = _get_filekey(file)
+            if changed:has(filekey) then
+                mapped:insert(filekey)
+                _add_target(affected, target, file)
+            end
+        end
+    end
+
+    -- the dependent files of the built objects are changed? e.g. the included headers
+    local index = depindex.new(targets_all)
+    for _, object in ipairs(depindex.dirty_objects(index, files)) do
+        _add_target(affected, object.target, object.sourcefile)
+    end
+
+    -- the other changed files are not mapped? e.g. the headers included by the targets which have not been built,
+    -- we cannot know whether these targets include them without the dependfiles, so they are also affected.
+    local unmapped
+    for _, file in ipairs(files) do
+        local filekey = _get_filekey(file)
+        if not mapped:has(filekey) and not depindex.has_file(index, filekey) then
+            unmapped = file
+            break
+        end
+    end
+    if unmapped then
+        for _, target in ipairs(targets_all) do
+            if not depindex.has_dependinfo(index, target) then
+                _add_target(affected, target, path.relative(unmapped, project.directory()) .. " (no dependinfo)")
+            end
+        end
+    end
+
+    -- all dependents are also affected, the dependencies are always in front of the dependents
+    local result = {}
+    for _, target in ipairs(targets_all) do
+        if not affected[target] then
+            for _, dep in pairs(target:deps()) do
+                if affected[dep] then
+                    _add_target(affected, target, dep:fullname())
+                    break
+                end
+            end
+        end
+        if affected[target] then
+            table.insert(result, target)
+        end
+    end
+    return result
+end
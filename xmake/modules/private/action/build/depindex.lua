@@ -0,0 +1,229 @@
+--!A cross-platform build utility based on Lua
+--
+-- Licensed under the Apache License, Version 2.0 (the "License");
+-- you may not use this file except in compliance with the License.
+-- You may obtain a copy of the License at
+--
+--     http://www.apache.org/licenses/LICENSE-2.0
+--
+-- Unless required by applicable law or agreed to in writing, software
+-- distributed under the License is distributed on an "AS IS" BASIS,
+-- WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+-- See the License for the specific language governing permissions and
+-- limitations under the License.
+--
+-- Copyright (C) 2015-present, Xmake Open Source Community.
+--
+-- @author      ruki
+-- @file        depindex.lua
+--
+
+-- imports
+import("core.base.hashset")
+import("core.project.depend")
+import("core.project.project")
+
+-- get the key of file path
+function _get_filekey(filepath)
+    filepath = path.absolute(filepath, project.directory())
+    if is_host("windows") then
+        filepath = filepath:lower()
+    end
+    return filepath
+end
+
+-- add the given object to the index
+function _add_object(index, object)
+    local files = {object.sourcefile}
+    if object.dependfile then
+        local dependinfo = depend.load(object.dependfile, {target = object.target})
+        if dependinfo and dependinfo.files then
+            files = table.join(files, dependinfo.files)
+            object.has_dependinfo = true
+        end
+    end
+    if not object.has_dependinfo then
+        local targetname = object.target:fullname()
+        index.nodeps[targetname] = (index.nodeps[targetname] or 0) + 1
+    end
+    local filekeys = {}
+    for _, file in ipairs(files) do
+        local filekey = _get_filekey(file)
+        local objects = index.files[filekey]
+        if objects == nil then
+            objects = {}
+            index.files[filekey] = objects
+        end
+        if not objects[object.objectfile] then
+            objects[object.objectfile] = object
+            table.insert(filekeys, filekey)
+        end
+    end
+    object.filekeys = filekeys
+    index.objects[object.objectfile] = object
+end
+
+-- remove the given object from the index
+function _remove_object(index, object)
+    for _, filekey in ipairs(object.filekeys) do
+        local objects = index.files[filekey]
+        if objects then
+            objects[object.objectfile] = nil
+        end
+    end
+    if not object.has_dependinfo then
+        local targetname = object.target:fullname()
+        index.nodeps[targetname] = index.nodeps[targetname] - 1
+    end
+    object.has_dependinfo = nil
+    index.objects[object.objectfile] = nil
+end
+
+-- build the reverse dependency index of the given targets
+--
+-- it maps the source files and headers (from the recorded dependfiles) to the object files,
+-- so we can find the dirty objects and targets of the changed files without checking all dependencies.
+--
+-- @param targets   the target list
+--
+-- @return          the index, e.g. {files = {["/project/src/foo.h"] = {["build/.objs/foo/src/foo.c.o"] = object}}, ...}
+--
+function new(targets)
+    local index = {files = {}, objects = {}, nodeps = {}, sourcefiles = hashset.new(), extensions = hashset.new()}
+    for _, target in ipairs(targets) do
+        for _, sourcebatch in pairs(target:sourcebatches()) do
+            local objectfiles = sourcebatch.objectfiles
+            local dependfiles = sourcebatch.dependfiles
+            for idx, sourcefile in ipairs(sourcebatch.sourcefiles) do
+                local objectfile = objectfiles and objectfiles[idx]
+                if objectfile then
+                    _add_object(index, {
+                        target = target,
+                        rulename = sourcebatch.rulename,
+                        sourcefile = sourcefile,
+                        objectfile = objectfile,
+                        dependfile = dependfiles and dependfiles[idx]})
+                end
+                index.sourcefiles:insert(_get_filekey(sourcefile))
+                index.extensions:insert(path.extension(sourcefile):lower())
+            end
+        end
+
+        -- the precompiled headers are not in the source batches, but the headers in them are also dependencies
+        for _, langkind in ipairs({"c", "cxx", "m", "mxx"}) do
+            local pcheaderfile = target:pcheaderfile(langkind)
+            if pcheaderfile then
+                local pcoutputfile = target:pcoutputfile(langkind)
+                _add_object(index, {
+                    target = target,
+                    sourcefile = pcheaderfile,
+                    objectfile = pcoutputfile,
+                    dependfile = target:dependfile(pcoutputfile),
+                    pcheader = true})
+            end
+        end
+    end
+    return index
+end
+
+-- update the dependencies of the given objects, e.g. after rebuilding them
+--
+-- @param index     the index
+-- @param objects   the object list
+--
+function update(index, objects)
+    for _, object in ipairs(objects) do
+        _remove_object(index, object)
+        _add_object(index, object)
+    end
+end
+
+-- is the given file a source file of the indexed targets?
+function is_sourcefile(index, filepath)
+    return index.sourcefiles:has(_get_filekey(filepath))
+end
+
+-- is the given file a possible source file of the indexed targets? e.g. a new created source file
+function is_sourcekind(index, filepath)
+    return index.extensions:has(path.extension(filepath):lower())
+end
+
+-- has the given file been indexed? e.g. a source file or an included header of the indexed objects
+function has_file(index, filepath)
+    return index.files[_get_filekey(filepath)] ~= nil
+end
+
+-- has the given target the recorded dependencies of all objects? it has been built
+function has_dependinfo(index, target)
+    local count = index.nodeps[target:fullname()]
+    return count == nil or count == 0
+end
+
+-- get the dirty objects of the given changed files
+--
+-- @param index     the index
+-- @param files     the changed files
+--
+-- @return          the dirty objects, e.g. {{target = target, sourcefile = "src/foo.c", objectfile = "build/.objs/foo/src/foo.c.o"}},
+--                  the object of the precompiled header is marked with `pcheader = true`
+--
+function dirty_objects(index, files)
+    local objects = {}
+    local objectset = hashset.new()
+    for _, file in ipairs(files) do
+        local fileobjects = index.files[_get_filekey(file)]
+        if fileobjects then
+            for objectfile, object in pairs(fileobjects) do
+                if objectset:insert(objectfile) then
+                    table.insert(objects, object)
+                end
+            end
+        end
+    end
+    return objects
+end
+
+-- get the targets which need to be relinked after rebuilding the objects of the given dirty targets
+--
+-- the object targets are not linked, but their objects are linked into the targets which depend on them,
+-- so we need to follow them through to their dependents.
+--
+-- @param targets       the target list in dependency order
+-- @param dirty_targets the hashset of the target names which have the rebuilt objects
+--
+-- @return              the link targets, e.g. {["foo"] = target}
+--
+function link_targets(targets, dirty_targets)
+    local results = {}
+    local dirty_objects = hashset.new()
+    for _, target in ipairs(targets) do
+        local targetname = target:fullname()
+        local dirty = dirty_targets:has(targetname)
+        if not dirty then
+            -- the objects of the plain object deps are linked into this target, @see target:objectfiles()
+            for _, depname in ipairs(table.wrap(target:get("deps"))) do
+                local dep = target:dep(depname)
+                if dep and dirty_objects:has(dep:fullname()) then
+                    dirty = true
+                    break
+                end
+            end
+        end
+        if not dirty then
+            for _, dep in ipairs(target:orderdeps()) do
+                if results[dep:fullname()] then
+                    dirty = true
+                    break
+                end
+            end
+        end
+        if dirty and target:is_enabled() then
+            if target:is_object() then
+                dirty_objects:insert(targetname)
+            elseif target:is_binary() or target:is_static() or target:is_shared() then
+                results[targetname] = target
+            end
+        end
+    end
+    return results
+end
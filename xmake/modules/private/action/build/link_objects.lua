@@ -20,13 +20,113 @@
 
 -- imports
 import("core.base.option")
+import("core.base.hashset")
+import("core.base.binutils")
 import("core.tool.linker")
 import("core.tool.compiler")
 import("core.project.depend")
+import("lib.detect.find_tool")
 import("utils.progress")
 import("build_object")
+import("private.cache.build_stats")
 import("private.action.build.target", {alias = "target_buildutils"})
 
+-- is incremental archiving supported for the given archiver?
+function _is_incremental_archiver(linkinst)
+    local archivers = _g.incremental_archivers
+    if archivers == nil then
+        archivers = hashset.of("ar", "gcc_ar", "llvm_ar", "emar", "link")
+        _g.incremental_archivers = archivers
+    end
+    return archivers:has(linkinst:name())
+end
+
+-- get the changed object files to be replaced in the existing archive
+--
+-- we only replace the changed members if the archive members are consistent with the last archived object files,
+-- otherwise we return nil to re-archive all object files, e.g. some object files have been removed.
+--
+function _get_archive_changed_objects(target, linkinst, objectfiles, targetfile, depvalues)
+    if not target:is_static() or not target:policy("build.archive.incremental") or
+        target:policy("build.merge_archive") or not _is_incremental_archiver(linkinst) then
+        return
+    end
+    if target:is_rebuilt() or option.get("linkonly") or not os.isfile(targetfile) then
+        return
+    end
+
+    -- the archiver or flags have been changed?
+    local dependinfo = depend.load(target:dependfile())
+    if not dependinfo or not dependinfo.objectfiles or depend.is_changed({values = dependinfo.values}, {values = depvalues}) then
+        return
+    end
+
+    -- some object files have been removed, or there are some object files with the same name?
+    -- ar will replace the member with the same file name, so we cannot update it incrementally.
+    local objectset = hashset.from(objectfiles)
+    for _, objectfile in ipairs(dependinfo.objectfiles) do
+        if not objectset:has(objectfile) then
+            return
+        end
+    end
+    local filenames = hashset.new()
+    for _, objectfile in ipairs(objectfiles) do
+        if not filenames:insert(path.filename(objectfile)) then
+            return
+        end
+    end
+
+    -- verify the archive members, the archive may be modified or broken outside
+    local members = try { function () return binutils.armembers(targetfile) end }
+    if not members or #members ~= #dependinfo.objectfiles then
+        return
+    end
+    local lastfiles = hashset.new()
+    for _, objectfile in ipairs(dependinfo.objectfiles) do
+        lastfiles:insert(path.filename(objectfile))
+    end
+    for _, member in ipairs(members) do
+        if not lastfiles:has(path.filename(member.name)) then
+            return
+        end
+    end
+
+    -- get the changed and new object files
+    local changed = {}
+    local lastmtime = os.mtime(targetfile)
+    local lastobjects = hashset.from(dependinfo.objectfiles)
+    local linked = #target_buildutils.get_linked_dependfiles(target) > 0
+    for _, objectfile in ipairs(objectfiles) do
+        local mtime = os.mtime(objectfile)
+        if linked then
+            -- the object file may be linked to the build cache, its mtime is not updated
+            mtime = math.max(mtime, os.mtime(target:dependfile(objectfile)))
+        end
+        if not lastobjects:has(objectfile) or mtime > lastmtime then
+            table.insert(changed, objectfile)
+        end
+    end
+    return changed
+end
+
+-- get the thread flags of the fast linker
+--
+-- we use the free job slots of the scheduler when starting to link,
+-- e.g. we use all jobs if only one target is being linked at the end of building.
+--
+function _get_linker_threadflags(target, opt)
+    local fastlinker = target:data("build.linker.fast")
+    if not fastlinker then
+        return
+    end
+    local nthreads = math.max(1, opt.freejobs or tonumber(option.get("jobs")) or os.default_njob())
+    if fastlinker == "mold" then
+        return {"-Wl,--thread-count=" .. nthreads}
+    elseif fastlinker == "lld" then
+        return {"-Wl,--threads=" .. nthreads}
+    end
+end
+
 -- do link target
 function _do_link_target(target, opt)
     local linkinst = linker.load(target:kind(), target:sourcekinds(), {target = target})
@@ -36,6 +136,10 @@ function _do_link_target(target, opt)
     local depfiles = target_buildutils.get_linkdepfiles(target)
     local dryrun = option.get("dry-run")
     local depvalues = {linkinst:program(), linkflags}
+    local thin = target:is_static() and target:policy("build.archive.thin")
+    if thin then
+        table.insert(depvalues, "thin")
+    end
     depend.on_changed(function ()
         local filename = target:filename()
         if target:is_static() then
@@ -46,21 +150,103 @@ function _do_link_target(target, opt)
 
         local targetfile = target:targetfile()
         local objectfiles = target:objectfiles()
+        local linkobjects = objectfiles
+        local linkopt = {linkflags = linkflags}
+        if target:is_static() then
+            linkopt.thin = thin
+
+            -- we only replace the changed members of the existing archive
+            local changed = not dryrun and _get_archive_changed_objects(target, linkinst, objectfiles, targetfile, depvalues)
+            if changed then
+                if #changed == 0 then
+                    -- only the dependent static libraries have been changed, we need not update members
+                    os.touch(targetfile)
+                    return {objectfiles = objectfiles}
+                end
+                linkobjects = changed
+                linkopt.incremental = true
+            end
+        end
+
+        -- the thread flags are not in depvalues, so changing jobs will not trigger relinking
+        local threadflags = not target:is_static() and _get_linker_threadflags(target, opt)
+        if threadflags then
+            linkopt.linkflags = table.join(linkflags, threadflags)
+        end
+
         local verbose = option.get("verbose")
         if verbose then
             -- show the full link command with raw arguments, it will expand @xxx.args for msvc/link on windows
-            print(linkinst:linkcmd(objectfiles, targetfile, {linkflags = linkflags, rawargs = true}))
+            print(linkinst:linkcmd(linkobjects, targetfile, table.join(linkopt, {rawargs = true})))
         end
 
+        local linktime
         if not dryrun then
-            assert(linkinst:link(objectfiles, targetfile, {linkflags = linkflags}))
+            local starttime = os.mclock()
+            local ok, errors = linkinst:link(linkobjects, targetfile, linkopt)
+            assert(ok, errors)
+            linktime = os.mclock() - starttime
+            build_stats.add(target:is_static() and "archive" or "link", target, targetfile, {duration = linktime})
         end
+
+        -- save the archived object files to update the archive incrementally next time,
+        -- and save the link time to show it in `xmake show -t target`
+        local results = {linktime = linktime, linker = target:data("build.linker.fast") or nil}
+        if target:is_static() then
+            results.objectfiles = objectfiles
+        end
+        return results
     end, {dependfile = target:dependfile(),
           lastmtime = os.mtime(target:targetfile()),
           changed = target:is_rebuilt() or option.get("linkonly"),
           values = depvalues, files = depfiles, dryrun = dryrun})
 end
 
+-- get the dwp program, we prefer llvm-dwp for the clang toolchain
+function _get_dwp(target)
+    local program, ld = target:tool(target:is_shared() and "sh" or "ld")
+    local dwps = _g.dwps
+    if dwps == nil then
+        dwps = {}
+        _g.dwps = dwps
+    end
+    local key = program or ""
+    local dwp = dwps[key]
+    if dwp == nil then
+        local names = {"dwp", "llvm-dwp"}
+        if ld and ld:startswith("clang") then
+            names = {"llvm-dwp", "dwp"}
+        end
+        for _, name in ipairs(names) do
+            dwp = find_tool(name)
+            if dwp then
+                break
+            end
+        end
+        dwps[key] = dwp or false
+    end
+    return dwp or nil
+end
+
+-- package all split dwarf files (.dwo) of the target file to the .dwp file
+function _do_package_dwp(target, opt)
+    local targetfile = target:targetfile()
+    local dwpfile = targetfile .. ".dwp"
+    if option.get("dry-run") or not os.isfile(targetfile) then
+        return
+    end
+    if os.isfile(dwpfile) and os.mtime(dwpfile) >= os.mtime(targetfile) and not target:is_rebuilt() then
+        return
+    end
+    local dwp = _get_dwp(target)
+    if not dwp then
+        wprint("dwp/llvm-dwp not found, skip to package %s", dwpfile)
+        return
+    end
+    progress.show(opt.progress, "${color.build.target}packaging.$(mode) %s", path.filename(dwpfile))
+    os.vrunv(dwp.program, {"-e", targetfile, "-o", dwpfile})
+end
+
 -- link object files to the target file
 --
 -- @param jobgraph  the job graph for dependency tracking
@@ -77,4 +263,15 @@ function main(jobgraph, target, opt)
             _do_link_target(target, opt)
         end
     end)
+
+    -- package the split dwarf files after linking
+    if not buildcmds and target:data("build.split_dwarf") and target:policy("build.debug.split_dwarf.dwp")
+        and (target:is_binary() or target:is_shared()) then
+        local dwpjob = target:fullname() .. "/package_dwp"
+        jobgraph:add(dwpjob, function (index, total, opt)
+            progress.set_target(opt.progress, target)
+            _do_package_dwp(target, opt)
+        end)
+        jobgraph:add_orders(linkjob, dwpjob)
+    end
 end
@@ -24,6 +24,7 @@ import("core.theme.theme")
 import("core.tool.compiler")
 import("core.project.depend")
 import("private.cache.build_cache")
+import("private.cache.build_stats")
 import("async.runjobs")
 import("utils.progress")
 import("private.service.distcc_build.client", {alias = "distcc_build_client"})
@@ -60,8 +61,21 @@ function _do_build_file(target, sourcefile, opt)
     -- we enable time cache to speed up is_changed, because there are a lot of header files in depfiles.
     -- but we cannot cache it in link stage, maybe some objectfiles will be updated.
     -- @see https://github.com/xmake-io/xmake/issues/6089
+    --
+    -- we also need to rebuild it if the split dwarf file (.dwo) of this object has been removed
+    --
+    -- the time trace and prefix map flags are only added when compiling it, so we need to add the policy states to the depend values.
     local depvalues = {compinst:program(), compflags}
+    if target:policy("build.profile.ftime_trace") then
+        table.insert(depvalues, "ftime_trace")
+    end
+    if build_cache.is_enabled(target) and build_cache.is_path_independent() then
+        table.insert(depvalues, "path_independent")
+    end
     local lastmtime = os.isfile(objectfile) and os.mtime(dependfile) or 0
+    if dependinfo.dwofile and not os.isfile(dependinfo.dwofile) then
+        lastmtime = 0
+    end
     if not dryrun and not depend.is_changed(dependinfo, {lastmtime = lastmtime, values = depvalues, timecache = true}) then
         return
     end
@@ -75,7 +89,8 @@ function _do_build_file(target, sourcefile, opt)
     if build_cache.is_enabled(target) and build_cache.is_supported(sourcekind) then
         prefix = "cache "
     end
-    if distcc_build_client.is_distccjob() and distcc_build_client.singleton():has_freejobs() then
+    local distcc = distcc_build_client.is_distccjob() and distcc_build_client.singleton():has_freejobs()
+    if distcc then
         prefix = prefix .. "distc "
     end
 
@@ -93,16 +108,56 @@ function _do_build_file(target, sourcefile, opt)
 
         -- do compile
         dependinfo.files = {}
+
+        -- the old object file may be linked to the build cache (hardlink/symlink),
+        -- we need to break it first, otherwise the compiler will overwrite the cached file.
+        if build_cache.is_linked_strategy() or os.islink(objectfile) then
+            os.tryrm(objectfile)
+        end
+        local compile_time = os.mclock()
         assert(compinst:compile(sourcefile, objectfile, {dependinfo = dependinfo, compflags = compflags}))
+        local duration = os.mclock() - compile_time
+
+        -- we also record the compile duration (ms), it can be used to estimate the build cost of sourcefile,
+        -- e.g. the automatic batching of unity build
+        --
+        -- but the duration of cache hit or remote compilation is not the real cost, so we keep the previous value.
+        local cacheinfo = build_cache.objectinfo(objectfile)
+        if not distcc and (not cacheinfo or cacheinfo.cache == "miss") then
+            dependinfo.duration = duration
+        elseif target:is_rebuilt() then
+            local dependinfo_old = depend.load(dependfile, {target = target})
+            dependinfo.duration = dependinfo_old and dependinfo_old.duration
+        end
+
+        -- record the build stats, we can see them in `xmake show -i buildstats`
+        build_stats.add("compile", target, sourcefile, {
+            duration = duration,
+            cache = cacheinfo and cacheinfo.cache,
+            ppsize = cacheinfo and cacheinfo.ppsize})
 
         -- update files and values to the depfiles
         dependinfo.values = depvalues
         table.insert(dependinfo.files, sourcefile)
 
+        -- track the split dwarf file as the extra output of this object
+        dependinfo.dwofile = nil
+        if target:data("build.split_dwarf") then
+            local dwofile = path.join(path.directory(objectfile), path.basename(objectfile) .. ".dwo")
+            if os.isfile(dwofile) then
+                dependinfo.dwofile = dwofile
+            end
+        end
+
         -- add precompiled header to the depfiles when building sourcefile
         local build_pch
         local pcxxoutputfile = target:pcoutputfile("cxx")
         local pcoutputfile = target:pcoutputfile("c")
+        local excluded = target:data("pcheader.auto.excluded")
+        if excluded and excluded[sourcefile] then
+            pcxxoutputfile = nil
+            pcoutputfile = nil
+        end
         if pcxxoutputfile or pcoutputfile then
             -- https://github.com/xmake-io/xmake/issues/3988
             local extension = path.extension(sourcefile)
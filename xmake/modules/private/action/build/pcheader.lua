@@ -19,11 +19,213 @@
 --
 
 -- imports
+import("core.base.hashset")
 import("core.language.language")
+import("core.project.depend")
+import("core.cache.localcache")
 import("object", {alias = "build_objects"})
 
+-- the minimal count of sourcefiles to enable the auto precompiled header
+local AUTO_MINFILES = 4
+
+-- the header is selected if it's included by this ratio of sourcefiles,
+-- and it will be kept if it's still included by the half ratio of sourcefiles
+local AUTO_RATIO = 0.5
+
+-- the max count of the selected headers
+local AUTO_MAXHEADERS = 64
+
+-- the project header is stable if it has not been modified in these days
+local AUTO_STABLEDAYS = 3
+
+-- get the leading #include directives of the given sourcefile
+--
+-- we only scan the include block at the beginning of sourcefile,
+-- because the headers after other directives or code may depend on the macros defined before them.
+--
+function _auto_leading_includes(sourcefile)
+    local includes = {}
+    local file = io.open(sourcefile, "r")
+    if not file then
+        return includes
+    end
+    local in_comment = false
+    for line in file:lines() do
+        line = line:trim()
+        if in_comment then
+            if line:find("*/", 1, true) then
+                in_comment = false
+            end
+        elseif line:startswith("/*") then
+            if not line:find("*/", 3, true) then
+                in_comment = true
+            end
+        elseif line ~= "" and not line:startswith("//") then
+            local include = line:match("^#%s*include%s*([<\"][^>\"]+[>\"])")
+            if include then
+                table.insert(includes, include)
+            elseif not line:match("^#%s*pragma%s+once") then
+                break
+            end
+        end
+    end
+    file:close()
+    return includes
+end
+
+-- resolve the included header from the dependent files of object
+function _auto_resolve_header(include, dependinfo)
+    local name = path.normalize(include:sub(2, -2))
+    for _, file in ipairs(dependinfo.files) do
+        file = path.normalize(file)
+        if file == name or file:endswith("/" .. name) or file:endswith("\\" .. name) then
+            return file
+        end
+    end
+end
+
+-- synthesize the precompiled header from the include statistics of the previous build
+--
+-- e.g.
+-- set_policy("build.pcheader.auto", true)
+--
+function _auto_pcheader(target, langkind)
+    local rulename = langkind == "cxx" and "c++.build" or "c.build"
+    local sourcebatch = target:sourcebatches()[rulename]
+    if not sourcebatch or #sourcebatch.sourcefiles < AUTO_MINFILES or target:policy("build.c++.modules") then
+        return
+    end
+
+    -- get the previous selection
+    --
+    -- we need to resolve the selected headers from cache, because some compilers (e.g. msvc)
+    -- do not report the headers in the precompiled header when using it
+    local cachekey = target:fullname() .. "/" .. langkind
+    local selected_old = {}
+    for _, item in ipairs(localcache.get("pcheader_auto", cachekey) or {}) do
+        selected_old[item.include] = item.headerfile
+    end
+
+    -- collect the resolved leading includes of the sourcefiles from their dependfiles
+    --
+    -- we stop at the first include which cannot be resolved,
+    -- because we can only select the same leading includes of the sourcefiles which use the precompiled header.
+    local total = 0
+    local headerfiles = {}
+    local source_includes = {}
+    local projectdir = path.absolute(os.projectdir())
+    for idx, sourcefile in ipairs(sourcebatch.sourcefiles) do
+        local dependinfo = depend.load(sourcebatch.dependfiles[idx], {target = target})
+        if dependinfo and dependinfo.files then
+            total = total + 1
+            local includes = {}
+            for _, include in ipairs(_auto_leading_includes(sourcefile)) do
+                local headerfile = _auto_resolve_header(include, dependinfo) or selected_old[include]
+                if not headerfile then
+                    break
+                end
+                headerfiles[include] = headerfiles[include] or path.absolute(headerfile)
+                table.insert(includes, include)
+            end
+            source_includes[sourcefile] = includes
+        end
+    end
+    if total < AUTO_MINFILES then
+        return
+    end
+
+    -- select the common leading includes of the sourcefiles, they are the stable and widely-included headers
+    --
+    -- the previous headers may define macros used by the next headers, so we only select a header
+    -- if all headers before it are also selected, and the sourcefiles need to include them in the same order.
+    local selected = {}
+    local matched = {}
+    for _, sourcefile in ipairs(sourcebatch.sourcefiles) do
+        if source_includes[sourcefile] then
+            table.insert(matched, sourcefile)
+        end
+    end
+    local now = os.time()
+    while #selected < AUTO_MAXHEADERS do
+        local idx = #selected + 1
+        local counts = {}
+        local include_best
+        for _, sourcefile in ipairs(matched) do
+            local include = source_includes[sourcefile][idx]
+            if include then
+                counts[include] = (counts[include] or 0) + 1
+                if not include_best or counts[include] > counts[include_best] then
+                    include_best = include
+                end
+            end
+        end
+        if not include_best then
+            break
+        end
+        local count = counts[include_best]
+        local ratio = selected_old[include_best] and AUTO_RATIO / 2 or AUTO_RATIO
+        if count < 2 or count < total * ratio then
+            break
+        end
+        local headerfile = headerfiles[include_best]
+        local is_project_header = path.is_absolute(headerfile) and headerfile:startswith(projectdir)
+        if is_project_header and now - os.mtime(headerfile) <= AUTO_STABLEDAYS * 86400 then
+            break
+        end
+        table.insert(selected, include_best)
+        local matched_next = {}
+        for _, sourcefile in ipairs(matched) do
+            if source_includes[sourcefile][idx] == include_best then
+                table.insert(matched_next, sourcefile)
+            end
+        end
+        matched = matched_next
+    end
+    localcache.set("pcheader_auto", cachekey, table.imap(selected, function (_, include)
+        return {include = include, headerfile = headerfiles[include]}
+    end))
+    localcache.save("pcheader_auto")
+    if #selected == 0 then
+        return
+    end
+
+    -- generate the precompiled header, we only update it if the selection is changed
+    local content = {"// generated by xmake from the include statistics, please do not edit it", "#pragma once"}
+    for _, include in ipairs(selected) do
+        if include:startswith("\"") then
+            table.insert(content, string.format("#include \"%s\"", (headerfiles[include]:gsub("\\", "/"))))
+        else
+            table.insert(content, "#include " .. include)
+        end
+    end
+    content = table.concat(content, "\n") .. "\n"
+    local headerfile = path.join(target:autogendir(), "rules", "pcheader", langkind == "cxx" and "auto_pch.hpp" or "auto_pch.h")
+    if not os.isfile(headerfile) or io.readfile(headerfile) ~= content then
+        vprint("generating.pcheader %s", headerfile)
+        io.writefile(headerfile, content)
+    end
+    target:pcheaderfile_set(langkind, headerfile)
+
+    -- we only force to include it in the sourcefiles which include all selected headers at the beginning in the same order,
+    -- the other sourcefiles (e.g. the new sourcefiles without dependfiles) will be compiled without it.
+    --
+    -- @see core.tool.compiler
+    local excluded = target:data("pcheader.auto.excluded") or {}
+    local matched_set = hashset.from(matched)
+    for _, sourcefile in ipairs(sourcebatch.sourcefiles) do
+        if not matched_set:has(sourcefile) then
+            excluded[sourcefile] = langkind
+        end
+    end
+    target:data_set("pcheader.auto.excluded", excluded)
+    return headerfile
+end
+
 function config(target, langkind, opt)
     local pcheaderfile = target:pcheaderfile(langkind)
+    if not pcheaderfile and target:policy("build.pcheader.auto") then
+        pcheaderfile = _auto_pcheader(target, langkind)
+    end
     if pcheaderfile then
         local sourcekind = language.langkinds()[langkind] or "cxx"
         if target:has_tool(sourcekind, "cl", "clang_cl", "gcc", "gxx") then
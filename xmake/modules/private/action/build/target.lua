@@ -21,12 +21,14 @@
 -- imports
 import("core.base.option")
 import("core.base.hashset")
+import("core.base.profiler")
 import("core.project.rule")
 import("core.project.config")
 import("core.project.project")
 import("async.runjobs", {alias = "async_runjobs"})
 import("async.jobgraph", {alias = "async_jobgraph"})
 import("private.utils.batchcmds")
+import("private.cache.build_cache")
 import("private.utils.rule", {alias = "rule_utils"})
 import("utils.progress", {alias = "progress_utils"})
 
@@ -730,6 +732,7 @@ end
 -- get link depfiles
 function get_linkdepfiles(target)
     local depfiles = table.clone(target:objectfiles())
+    table.join2(depfiles, get_linked_dependfiles(target))
     for _, dep in ipairs(target:orderdeps()) do
         if dep:kind() == "static" then
             table.insert(depfiles, dep:targetfile())
@@ -743,6 +746,25 @@ function get_linkdepfiles(target)
     return depfiles
 end
 
+-- get the dependfiles of the object files which may be linked to the build cache
+--
+-- the mtime of the linked object files are not updated when hitting cache,
+-- so we need to use the mtime of their dependfiles.
+--
+-- @see build_cache.is_linked_strategy()
+--
+function get_linked_dependfiles(target)
+    local dependfiles = {}
+    if build_cache.is_enabled(target) and build_cache.is_linked_strategy() then
+        for _, sourcebatch in pairs(target:sourcebatches()) do
+            if sourcebatch.objectfiles and sourcebatch.dependfiles and build_cache.is_supported(sourcebatch.sourcekind) then
+                table.join2(dependfiles, sourcebatch.dependfiles)
+            end
+        end
+    end
+    return dependfiles
+end
+
 -- get all root targets
 function get_root_targets(targetnames, opt)
     opt = opt or {}
@@ -796,7 +818,9 @@ end
 function run_targetjobs(targets_root, opt)
     opt = opt or {}
     local job_kind = opt.job_kind
+    profiler.mem_enter("jobgraph")
     local jobgraph = get_targetjobs(targets_root, opt)
+    profiler.mem_leave("jobgraph")
     if jobgraph and not jobgraph:empty() then
         local curdir = os.curdir()
         local runjobs_opt = {
@@ -817,7 +841,9 @@ end
 function run_filejobs(targets_root, opt)
     opt = opt or {}
     local job_kind = opt.job_kind
+    profiler.mem_enter("jobgraph")
     local jobgraph = get_filejobs(targets_root, opt)
+    profiler.mem_leave("jobgraph")
     if jobgraph and not jobgraph:empty() then
         local curdir = os.curdir()
         local runjobs_opt = {
@@ -25,6 +25,7 @@ import("core.base.scheduler")
 import("core.project.project")
 import("core.base.tty")
 import("async.runjobs")
+import("async.jobgraph")
 import("utils.waiting_indicator", {alias = "waiting_indicator"})
 import("net.fasturl")
 import("private.action.require.impl.package")
@@ -384,7 +385,7 @@ function _fetch_packages(packages_fetch, installdeps)
         packages_fetching[index] = nil
 
     end, {total = #packages_fetch,
-          comax = (option.get("verbose") or option.get("diagnosis")) and 1 or 4,
+          comax = _get_jobs_count(),
           isolate = true})
 end
 
@@ -407,157 +408,191 @@ function _should_install_package(instance)
     return result
 end
 
+-- get the max count of the running download/install jobs
+function _get_jobs_count()
+    if option.get("verbose") or option.get("diagnosis") then
+        return 1
+    end
+    return 4
+end
+
+-- can we download this package in advance before its dependencies have been installed?
+function _can_prefetch_package(instance)
+    -- the custom download script may use the tools of the dependent packages
+    return not instance:script("download")
+end
+
+-- install package from the multiple schemes
+function _install_package(instance, index, packages_download, packages_prefetched, packages_downloading, packages_installing)
+    for idx, scheme in ipairs(instance:schemes_orderlist()) do
+        instance:prepare_install_scheme(scheme)
+
+        -- download this package first, the first scheme may have been downloaded in advance
+        local downloaded = true
+        local prefetched = idx == 1 and packages_prefetched[tostring(instance)]
+        if prefetched ~= nil then
+            downloaded = prefetched
+        elseif packages_download[tostring(instance)] then
+            packages_downloading[index] = instance
+            packages_installing[index] = nil
+            action_check(instance)
+            downloaded = action_download(instance)
+            packages_downloading[index] = nil
+        end
+
+        packages_installing[index] = instance
+        if downloaded then
+            if action_install(instance) then
+                -- install ok
+                break
+            end
+        end
+    end
+end
+
 -- do install packages
+--
+-- we install them with a jobgraph, the download job (download, verify and extract sources) of each package
+-- does not depend on the other packages, so it can be run in advance while the dependent packages are being built.
+--
+-- e.g.
+--
+-- download/zlib -> install/zlib ------> install/libpng
+--                                          ^
+-- download/libpng -------------------------|
+--
 function _do_install_packages(packages_install, packages_download, installdeps)
 
     -- we need to hide wait characters if is not a tty
     local show_wait = io.isatty()
 
-    -- init installed packages
-    local packages_installed = {}
-    for _, instance in ipairs(packages_install) do
-        packages_installed[tostring(instance)] = false
-    end
-
     -- save terminal mode for stdout, @see https://github.com/xmake-io/xmake/issues/1924
     local term_mode_stdout = tty.term_mode("stdout")
 
-    -- do install
+    -- init jobs
+    local jobs = jobgraph.new("install_packages")
+    local jobs_count = _get_jobs_count()
     local waiting_indicator_helper = show_wait and waiting_indicator.new() or nil
     local packages_installing = {}
     local packages_downloading = {}
-    local packages_pending = table.copy(packages_install)
+    local packages_prefetched = {}
     local packages_in_group = {}
-    local working_count = 0
     local installing_count = 0
     local parallelize = true
-    runjobs("install_packages", function (index)
 
-        -- fetch a new package
-        local instance = nil
-        while instance == nil and #packages_pending > 0 do
-            for idx, pkg in ipairs(packages_pending) do
+    -- add download jobs, we only download the first package of the same group in advance
+    --
+    -- the download jobs are added to the limited lanes in the installation order,
+    -- so they will not occupy all running jobs and the nearest packages will be downloaded first.
+    --
+    local download_lanes = {}
+    local download_groups = {}
+    for _, instance in ipairs(packages_install) do
+        local key = tostring(instance)
+        local group = instance:group()
+        if packages_download[key] and _can_prefetch_package(instance) and (not group or not download_groups[group]) then
+            local jobname = "download/" .. key
+            jobs:add(jobname, function (index, total, opt)
+                packages_downloading[index] = instance
+                instance:prepare_install_scheme(instance:schemes_orderlist()[1])
+                packages_prefetched[key] = action_download(instance)
+                packages_downloading[index] = nil
+            end)
+            table.insert(download_lanes, jobname)
+            if group then
+                download_groups[group] = true
+            end
+        end
+    end
 
-                -- all dependencies has been installed? we install it now
-                local ready = true
-                local dep_not_found = nil
-                for _, dep in pairs(installdeps[tostring(pkg)]) do
-                    local installed = packages_installed[tostring(dep)]
-                    if installed == false or (installed == nil and _should_install_package(dep) and not dep:is_optional()) then
-                        ready = false
-                        dep_not_found = dep
-                        break
-                    end
-                end
-                local group = pkg:group()
-                if ready and group then
-                    -- this group has been installed? skip it
-                    local group_status = packages_in_group[group]
-                    if group_status == 1 then
-                        table.remove(packages_pending, idx)
-                        break
-                    -- this group is installing? wait it
-                    elseif group_status == 0 then
-                        ready = false
-                    end
-                end
+    -- add install jobs
+    for _, instance in ipairs(packages_install) do
+        jobs:add("install/" .. tostring(instance), function (index, total, opt)
 
-                -- get a package with the ready status
-                if ready then
-                    instance = pkg
-                    table.remove(packages_pending, idx)
-                    break
-                elseif working_count == 0 then
-                    if #packages_pending == 1 and dep_not_found then
-                        raise("package(%s): cannot be installed, there are dependencies(%s) that cannot be installed!", pkg:displayname(), dep_not_found:displayname())
-                    elseif #packages_pending == 1 then
-                        raise("package(%s): cannot be installed!", pkg:displayname())
-                    end
+            -- the dependencies which are not in the installation list need to be installed
+            for _, dep in pairs(installdeps[tostring(instance)]) do
+                if not jobs:has("install/" .. tostring(dep)) and _should_install_package(dep) and not dep:is_optional() then
+                    raise("package(%s): cannot be installed, there are dependencies(%s) that cannot be installed!", instance:displayname(), dep:displayname())
                 end
             end
-            if instance == nil and #packages_pending > 0 then
-                os.sleep(100)
-            end
-        end
-        if instance then
-
-            -- update working count
-            working_count = working_count + 1
 
             -- only install the first package in same group
             local group = instance:group()
-            if not group or not packages_in_group[group] then
+            if group and packages_in_group[group] then
+                return
+            end
 
-                -- disable parallelize?
-                if not instance:is_parallelize() then
-                    parallelize = false
-                end
-                if not parallelize then
-                    while installing_count > 0 do
-                        os.sleep(100)
-                    end
-                end
-                installing_count = installing_count + 1
+            -- disable parallelize?
+            if not instance:is_parallelize() then
+                parallelize = false
+            end
+            while installing_count >= jobs_count or (not parallelize and installing_count > 0) do
+                os.sleep(100)
+            end
+            installing_count = installing_count + 1
 
-                -- mark this group as 'installing'
-                if group then
-                    packages_in_group[group] = 0
-                end
+            -- the package has been downloaded in advance? we need to check it now,
+            -- because the dependent packages (e.g. toolchain) may be used in on_check
+            if packages_prefetched[tostring(instance)] ~= nil then
+                action_check(instance)
+            end
 
-                -- install package from the multiple schemes
-                for _, scheme in ipairs(instance:schemes_orderlist()) do
-                    instance:prepare_install_scheme(scheme)
-
-                    -- download this package first
-                    local downloaded = true
-                    if packages_download[tostring(instance)] then
-                        packages_downloading[index] = instance
-                        packages_installing[index] = nil
-                        action_check(instance)
-                        downloaded = action_download(instance)
-                        packages_downloading[index] = nil
-                    end
+            -- install package from the multiple schemes
+            _install_package(instance, index, packages_download, packages_prefetched, packages_downloading, packages_installing)
 
-                    packages_installing[index] = instance
-                    if downloaded then
-                        if action_install(instance) then
-                            -- install ok
-                            break
-                        end
-                    end
-                end
+            -- reset package status cache
+            _g.package_status_cache = nil
 
-                -- reset package status cache
-                _g.package_status_cache = nil
+            -- register it to local cache if it is root required package
+            --
+            -- @note we need to register the package in time,
+            -- because other packages may be used, e.g. toolchain/packages
+            if instance:is_toplevel() then
+                register_packages({instance})
+            end
 
-                -- register it to local cache if it is root required package
-                --
-                -- @note we need to register the package in time,
-                -- because other packages may be used, e.g. toolchain/packages
-                if instance:is_toplevel() then
-                    register_packages({instance})
-                end
+            -- mark this group as 'installed' or 'failed'
+            if group then
+                packages_in_group[group] = instance:exists() and 1 or -1
+            end
 
-                -- mark this group as 'installed' or 'failed'
-                if group then
-                    packages_in_group[group] = instance:exists() and 1 or -1
-                end
+            -- next
+            parallelize = true
+            installing_count = installing_count - 1
+            packages_installing[index] = nil
+        end)
+    end
 
-                -- next
-                parallelize = true
-                installing_count = installing_count - 1
-                packages_installing[index] = nil
-                packages_installed[tostring(instance)] = true
+    -- add job orders
+    local groups_last = {}
+    for _, instance in ipairs(packages_install) do
+        local key = tostring(instance)
+        local jobname = "install/" .. key
+        if jobs:has("download/" .. key) then
+            jobs:add_orders("download/" .. key, jobname)
+        end
+        for _, dep in pairs(installdeps[key]) do
+            local depname = "install/" .. tostring(dep)
+            if jobs:has(depname) then
+                jobs:add_orders(depname, jobname)
             end
-
-            -- update working count
-            working_count = working_count - 1
         end
-        packages_installing[index] = nil
-        packages_downloading[index] = nil
+        -- the packages in the same group are installed one by one
+        local group = instance:group()
+        if group then
+            if groups_last[group] then
+                jobs:add_orders(groups_last[group], jobname)
+            end
+            groups_last[group] = jobname
+        end
+    end
+    for idx = jobs_count + 1, #download_lanes do
+        jobs:add_orders(download_lanes[idx - jobs_count], download_lanes[idx])
+    end
 
-    end, {total = #packages_install,
-          comax = (option.get("verbose") or option.get("diagnosis")) and 1 or 4,
+    -- do install
+    runjobs("install_packages", jobs, {
+          comax = jobs_count > 1 and jobs_count * 2 or 1,
           isolate = true,
           on_timer = function (running_jobs_indices)
 
@@ -23,6 +23,7 @@ import("core.base.bytes")
 import("core.base.hashset")
 import("core.base.global")
 import("core.cache.memcache")
+import("core.cache.fingerprintcache")
 import("core.project.config")
 import("core.project.policy")
 import("core.project.project")
@@ -102,20 +103,133 @@ function is_supported(sourcekind)
     return sourcekinds:has(sourcekind)
 end
 
+-- get the copy strategy of the cached object files, e.g. auto, copy, hardlink, symlink
+function _copy_strategy()
+    local strategy = _g.copy_strategy
+    if strategy == nil then
+        if os.isfile(os.projectfile()) then
+            strategy = project.policy("build.ccache.copy_strategy")
+        end
+        strategy = strategy or "auto"
+        _g.copy_strategy = strategy
+    end
+    return strategy
+end
+
+-- the object file is linked to the cached file?
+--
+-- we cannot update the mtime of the linked object file, because it will also change the cached file,
+-- so the mtime of its dependfile is used to determine whether the object file has been changed.
+--
+function is_linked_strategy()
+    local strategy = _copy_strategy()
+    return strategy == "hardlink" or strategy == "symlink"
+end
+
+-- is the path-independent cache key enabled?
+--
+-- we map the project directory of the line markers when computing the cache key,
+-- and the compiler also need to map it in the object files, e.g. -ffile-prefix-map,
+-- so the tool needs to pass `path_independent = true` to build() only if it has mapped it.
+--
+function is_path_independent()
+    local result = _g.path_independent
+    if result == nil then
+        if os.isfile(os.projectfile()) then
+            result = project.policy("build.ccache.path_independent")
+        end
+        result = result or false
+        _g.path_independent = result
+    end
+    return result
+end
+
+-- get the path prefix map of the line markers, e.g. {"/home/runner/work/foo", "."}
+function _prefixmap()
+    local prefixmap = _g.prefixmap
+    if prefixmap == nil then
+        local projectdir = os.projectdir()
+        prefixmap = {projectdir, "."}
+        if projectdir:find("\\", 1, true) then
+            -- the line markers of msvc are escaped, e.g. #line 1 "C:\\foo\\src\\main.c"
+            table.insert(prefixmap, (projectdir:gsub("\\", "\\\\")))
+            table.insert(prefixmap, ".")
+        end
+        _g.prefixmap = prefixmap
+    end
+    return prefixmap
+end
+
+-- map the project directory in the given string to ".", e.g. -I/work/foo/inc -> -I./inc
+--
+-- we only map the whole directory like the line markers (hash.xxhash128 with prefixmap),
+-- e.g. -I/work/foo2/inc is not changed if the project directory is /work/foo
+--
+function _map_projectdir(str, projectdir)
+    local haystack = str
+    if is_host("windows") then
+        haystack = str:lower()
+        projectdir = projectdir:lower()
+    end
+    local parts
+    local last = 1
+    local pos = 1
+    while true do
+        local s, e = haystack:find(projectdir, pos, true)
+        if not s then
+            break
+        end
+        local c = haystack:sub(e + 1, e + 1)
+        if c == "" or c == "/" or c == "\\" or c == "\"" or c == "=" then
+            parts = parts or {}
+            table.insert(parts, str:sub(last, s - 1))
+            table.insert(parts, ".")
+            last = e + 1
+            pos = e + 1
+        else
+            pos = s + 1
+        end
+    end
+    if parts then
+        table.insert(parts, str:sub(last))
+        return table.concat(parts)
+    end
+    return str
+end
+
 -- get cache key
-function cachekey(program, cppinfo, envs)
+--
+-- @param opt   the options, e.g. {path_independent = true}
+--
+function cachekey(program, cppinfo, envs, opt)
+    opt = opt or {}
     local cppfile = cppinfo.cppfile
     local cppflags = cppinfo.cppflags
     local items = {program}
+    -- the program path is not changed after upgrading compiler, so we need to add the digest of the program file
+    local digest = fingerprintcache.digest(program)
+    if digest then
+        table.insert(items, digest)
+    end
+    local path_independent = opt.path_independent
+    local projectdir = path_independent and os.projectdir() or nil
     for _, cppflag in ipairs(cppflags) do
         if cppflag:startswith("-D") or cppflag:startswith("/D") then
             -- ignore `-Dxx` to improve the cache hit rate, as some source files may not use the defined macros.
             -- @see https://github.com/xmake-io/xmake/issues/2425
+        elseif projectdir then
+            -- e.g. -ffile-prefix-map=/home/runner/work/foo=.
+            table.insert(items, _map_projectdir(cppflag, projectdir))
         else
             table.insert(items, cppflag)
         end
     end
-    table.insert(items, hash.xxhash128(cppfile))
+    if path_independent then
+        table.insert(items, "path_independent")
+        table.insert(items, hash.xxhash128(cppfile, {prefixmap = _prefixmap()}))
+    else
+        table.insert(items, hash.xxhash128(cppfile))
+    end
     if envs then
         local basename = path.basename(program)
         if basename == "cl" then
@@ -232,10 +346,17 @@ function get(cachekey)
 end
 
 -- put object file
-function put(cachekey, objectfile, extrainfo)
+--
+-- @param opt   the options, e.g. {dwofile = "xxx.dwo"}
+--
+function put(cachekey, objectfile, extrainfo, opt)
+    opt = opt or {}
     local objectfile_cached = path.join(rootdir(), cachekey:sub(1, 2):lower(), cachekey)
     local objectfile_infofile = objectfile_cached .. ".txt"
     os.cp(objectfile, objectfile_cached)
+    if opt.dwofile and os.isfile(opt.dwofile) then
+        os.cp(opt.dwofile, objectfile_cached .. ".dwo")
+    end
     if extrainfo then
         io.save(objectfile_infofile, extrainfo)
     end
@@ -272,6 +393,17 @@ function put(cachekey, objectfile, extrainfo)
     end
 end
 
+-- get and remove the cache info of the last built object file, e.g. {cache = "hit", ppsize = 1024}
+function objectinfo(objectfile)
+    local objectinfos = _g.objectinfos
+    if objectinfos then
+        objectfile = path.absolute(objectfile)
+        local info = objectinfos[objectfile]
+        objectinfos[objectfile] = nil
+        return info
+    end
+end
+
 -- build with cache
 function build(program, argv, opt)
 
@@ -281,20 +413,44 @@ function build(program, argv, opt)
     local compile = assert(opt.compile, "compiler not found!")
     local cppinfo = preprocess(program, argv, opt)
     if cppinfo then
-        local cachekey = cachekey(program, cppinfo, opt.envs)
+        local cachekey = cachekey(program, cppinfo, opt.envs, {path_independent = opt.path_independent})
         local cache_hit_start_time = os.mclock()
         local objectfile_cached, objectfile_infofile = get(cachekey)
+
+        -- we also need the cached split dwarf file if it was stored with the object file,
+        -- it may be not found if the object file is pulled from remote
+        local dwofile = opt.dwofile
+        local extrainfo_cached
+        if objectfile_cached and objectfile_infofile and os.isfile(objectfile_infofile) then
+            extrainfo_cached = io.load(objectfile_infofile)
+        end
+        local dwofile_cached = extrainfo_cached and extrainfo_cached.dwo and objectfile_cached .. ".dwo" or nil
+        if dwofile_cached and not os.isfile(dwofile_cached) then
+            objectfile_cached = nil
+        end
         if objectfile_cached then
-            os.cp(objectfile_cached, cppinfo.objectfile)
+            -- the cached files are readonly, so we can reflink or link them instead of copying data
+            os.cp(objectfile_cached, cppinfo.objectfile, {strategy = _copy_strategy()})
+            if dwofile then
+                if dwofile_cached then
+                    os.cp(dwofile_cached, dwofile, {strategy = _copy_strategy()})
+                else
+                    os.tryrm(dwofile)
+                end
+            end
             -- we need to update mtime for incremental compilation
             -- @see https://github.com/xmake-io/xmake/issues/2620
-            os.touch(cppinfo.objectfile, {mtime = os.time()})
+            --
+            -- but the linked object file shares the mtime with the cached file,
+            -- so we use the mtime of the dependfile which will be saved after compiling it.
+            if not is_linked_strategy() then
+                os.touch(cppinfo.objectfile, {mtime = os.time()})
+            end
             -- we need to get outdata/errdata to show warnings,
             -- @see https://github.com/xmake-io/xmake/issues/2452
-            if objectfile_infofile and os.isfile(objectfile_infofile) then
-                local extrainfo = io.load(objectfile_infofile)
-                cppinfo.outdata = extrainfo.outdata
-                cppinfo.errdata = extrainfo.errdata
+            if extrainfo_cached then
+                cppinfo.outdata = extrainfo_cached.outdata
+                cppinfo.errdata = extrainfo_cached.errdata
             end
             _g.cache_hit_total_time = (_g.cache_hit_total_time or 0) + (os.mclock() - cache_hit_start_time)
         else
@@ -303,6 +459,14 @@ function build(program, argv, opt)
             local preprocess_errdata = cppinfo.errdata
             local compile_start_time = os.mclock()
             local compile_fallback = opt.compile_fallback
+            -- the object file may be linked to the cached file, we need to break it before writing the new object file,
+            -- otherwise the compiler will overwrite the cached file.
+            if is_linked_strategy() then
+                os.tryrm(cppinfo.objectfile)
+                if dwofile then
+                    os.tryrm(dwofile)
+                end
+            end
             if compile_fallback then
                 local ok = try {function () compile(program, cppinfo, opt); return true end}
                 if not ok then
@@ -334,11 +498,23 @@ function build(program, argv, opt)
                     extrainfo = extrainfo or {}
                     extrainfo.errdata = cppinfo.errdata
                 end
+                -- mark the split dwarf file is stored with the object file
+                if dwofile and os.isfile(dwofile) then
+                    extrainfo = extrainfo or {}
+                    extrainfo.dwo = true
+                end
                 local cache_miss_start_time = os.mclock()
-                put(cachekey, cppinfo.objectfile, extrainfo)
+                put(cachekey, cppinfo.objectfile, extrainfo, {dwofile = dwofile})
                 _g.cache_miss_total_time = (_g.cache_miss_total_time or 0) + (os.mclock() - cache_miss_start_time)
             end
         end
+        -- save the cache status and preprocessed size for the build stats
+        local objectinfos = _g.objectinfos
+        if objectinfos == nil then
+            objectinfos = {}
+            _g.objectinfos = objectinfos
+        end
+        objectinfos[path.absolute(cppinfo.objectfile)] = {cache = objectfile_cached and "hit" or "miss", ppsize = os.filesize(cppinfo.cppfile)}
         os.tryrm(cppinfo.cppfile)
     else
         _g.preprocess_error_count = (_g.preprocess_error_count or 0) + 1
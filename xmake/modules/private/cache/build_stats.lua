@@ -0,0 +1,134 @@
+--!A cross-platform build utility based on Lua
+--
+-- Licensed under the Apache License, Version 2.0 (the "License");
+-- you may not use this file except in compliance with the License.
+-- You may obtain a copy of the License at
+--
+--     http://www.apache.org/licenses/LICENSE-2.0
+--
+-- Unless required by applicable law or agreed to in writing, software
+-- distributed under the License is distributed on an "AS IS" BASIS,
+-- WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+-- See the License for the specific language governing permissions and
+-- limitations under the License.
+--
+-- Copyright (C) 2015-present, Xmake Open Source Community.
+--
+-- @author      ruki
+-- @file        build_stats.lua
+--
+
+-- imports
+import("core.project.config")
+
+-- the max count of the saved builds
+local MAX_BUILDS = 8
+
+-- the stats file header
+local STATS_HEADER = "#xmake-build-stats v1"
+
+-- get the stats directory
+function rootdir()
+    return path.join(config.builddir(), ".build_stats")
+end
+
+-- add a build record of the current build
+--
+-- @param kind      the record kind, e.g. compile, link
+-- @param target    the target instance
+-- @param filepath  the source file or target file
+-- @param info      the record info, e.g. {duration = 100, cache = "hit", ppsize = 1024, rss = 1024}
+--
+function add(kind, target, filepath, info)
+    info = info or {}
+    local records = _g.records
+    if records == nil then
+        records = {}
+        _g.records = records
+    end
+    table.insert(records, {
+        kind = kind,
+        target = target:fullname(),
+        file = filepath,
+        duration = info.duration or 0,
+        cache = info.cache,
+        ppsize = info.ppsize,
+        rss = info.rss})
+end
+
+-- save the records of the current build
+--
+-- each build is saved to an independent file, e.g. `build/.build_stats/000001712345678.txt`,
+-- and we only keep the last builds.
+--
+-- the record line format is `kind\ttarget\tfile\tduration\tcache\tppsize\trss`.
+--
+function save()
+    local records = _g.records
+    if not records or #records == 0 then
+        return
+    end
+    _g.records = nil
+
+    local lines = {STATS_HEADER}
+    for _, record in ipairs(records) do
+        table.insert(lines, table.concat({
+            record.kind,
+            record.target,
+            record.file,
+            tostring(math.floor(record.duration)),
+            record.cache or "-",
+            record.ppsize and tostring(record.ppsize) or "-",
+            record.rss and tostring(record.rss) or "-"}, "\t"))
+    end
+    local statsdir = rootdir()
+    local statsfile = path.join(statsdir, string.format("%015d.txt", os.time()))
+    local index = 1
+    while os.isfile(statsfile) do
+        statsfile = path.join(statsdir, string.format("%015d_%d.txt", os.time(), index))
+        index = index + 1
+    end
+    io.writefile(statsfile, table.concat(lines, "\n") .. "\n")
+
+    -- remove the old builds
+    local statsfiles = os.files(path.join(statsdir, "*.txt"))
+    if #statsfiles > MAX_BUILDS then
+        table.sort(statsfiles)
+        for i = 1, #statsfiles - MAX_BUILDS do
+            os.tryrm(statsfiles[i])
+        end
+    end
+end
+
+-- load the records of all saved builds, from old to new
+--
+-- @return      the builds, e.g. {{time = 1712345678, records = {{kind = "compile", target = "foo", file = "src/foo.c", duration = 100}}}}
+--
+function load()
+    local builds = {}
+    local statsfiles = os.files(path.join(rootdir(), "*.txt"))
+    table.sort(statsfiles)
+    for _, statsfile in ipairs(statsfiles) do
+        local records = {}
+        local lines = io.readfile(statsfile):split("\n")
+        if lines[1] == STATS_HEADER then
+            for i = 2, #lines do
+                local items = lines[i]:split("\t", {plain = true, strict = true})
+                if #items >= 7 then
+                    table.insert(records, {
+                        kind = items[1],
+                        target = items[2],
+                        file = items[3],
+                        duration = tonumber(items[4]) or 0,
+                        cache = items[5] ~= "-" and items[5] or nil,
+                        ppsize = tonumber(items[6]),
+                        rss = tonumber(items[7])})
+                end
+            end
+        end
+        if #records > 0 then
+            table.insert(builds, {time = tonumber(path.basename(statsfile):match("^(%d+)")), records = records})
+        end
+    end
+    return builds
+end
@@ -60,6 +60,8 @@ function checkers()
             ["api.target.toolset"]       = {description = "Check toolset configuration in target."},
             -- cuda checkers
             ["cuda.devlink"]             = {description = "Check devlink for targets.", build_failure = true},
+            -- build time checker
+            ["build.time"]               = {description = "Analyze the clang time trace files (-ftime-trace) of the build.", showstats = false},
             -- clang tidy checker
             ["clang.tidy"]               = {description = "Check project code using clang-tidy.", showstats = false},
             -- syntax checker
@@ -0,0 +1,200 @@
+--!A cross-platform build utility based on Lua
+--
+-- Licensed under the Apache License, Version 2.0 (the "License");
+-- you may not use this file except in compliance with the License.
+-- You may obtain a copy of the License at
+--
+--     http://www.apache.org/licenses/LICENSE-2.0
+--
+-- Unless required by applicable law or agreed to in writing, software
+-- distributed under the License is distributed on an "AS IS" BASIS,
+-- WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+-- See the License for the specific language governing permissions and
+-- limitations under the License.
+--
+-- Copyright (C) 2015-present, Xmake Open Source Community.
+--
+-- @author      ruki
+-- @file        time.lua
+--
+
+-- imports
+import("core.base.option")
+import("core.base.text")
+import("core.base.thread")
+import("core.project.project")
+import("private.check.checkers.build.time_analyzer")
+
+-- the build.time options
+local options = {
+    {"j", "jobs",       "kv", tostring(os.default_njob()),
+                                    "Set the number of parallel analysis threads."},
+    {"n", "top",        "kv", "10", "Set the count of the shown items in each report."},
+    {nil, "targets",    "vs", nil,  "Analyze the time trace files of the given targets.",
+                                    "e.g.",
+                                    "    - xmake check build.time",
+                                    "    - xmake check build.time [targets]"}
+}
+
+-- add the time trace files of target
+--
+-- the trace file is generated next to the object file, e.g. foo.cpp.o -> foo.cpp.json,
+-- and we ignore the stale trace files which are older than the object files.
+--
+function _add_target_files(tracefiles, target)
+    for _, sourcebatch in pairs(target:sourcebatches()) do
+        local objectfiles = sourcebatch.objectfiles
+        if objectfiles then
+            for idx, sourcefile in ipairs(sourcebatch.sourcefiles) do
+                local objectfile = objectfiles[idx]
+                if objectfile then
+                    local tracefile = path.join(path.directory(objectfile), path.basename(objectfile) .. ".json")
+                    if os.isfile(tracefile) and os.isfile(objectfile) and os.mtime(tracefile) >= os.mtime(objectfile) then
+                        table.insert(tracefiles, {tracefile = tracefile, sourcefile = sourcefile})
+                    end
+                end
+            end
+        end
+    end
+end
+
+-- get all time trace files
+function _get_tracefiles(opt)
+    local tracefiles = {}
+    local targetnames = opt.targets
+    if targetnames then
+        for _, targetname in ipairs(targetnames) do
+            local target = assert(project.target(targetname), "unknown target(%s)", targetname)
+            _add_target_files(tracefiles, target)
+        end
+    else
+        for _, target in ipairs(project.ordertargets()) do
+            _add_target_files(tracefiles, target)
+        end
+    end
+    return tracefiles
+end
+
+-- analyze the trace files in the worker thread
+function _analyze_in_thread(tracefiles, queue)
+    local analyzer = import("private.check.checkers.build.time_analyzer", {anonymous = true})
+    queue:push(analyzer.analyze(tracefiles))
+end
+
+-- analyze all trace files in parallel, each thread parses a part of the trace files
+function _analyze(tracefiles, jobs)
+    local nthreads = math.min(jobs, #tracefiles)
+    if nthreads <= 1 then
+        return time_analyzer.analyze(tracefiles)
+    end
+    local queue = thread.queue()
+    local threads = {}
+    for i = 1, nthreads do
+        local files = {}
+        for j = i, #tracefiles, nthreads do
+            table.insert(files, tracefiles[j])
+        end
+        table.insert(threads, thread.start_named("check.build.time", _analyze_in_thread, files, queue))
+    end
+    for _, t in ipairs(threads) do
+        t:wait(-1)
+    end
+    local result = time_analyzer.new_result()
+    local count = 0
+    while not queue:empty() do
+        time_analyzer.merge_result(result, assert(queue:pop()))
+        count = count + 1
+    end
+    assert(count == nthreads, "some time trace analysis threads failed!")
+    return result
+end
+
+-- get the top items of the given events
+function _get_top_events(events, top)
+    local items = {}
+    for name, event in pairs(events) do
+        table.insert(items, {name = name, time = event.time, count = event.count})
+    end
+    table.sort(items, function (a, b) return a.time > b.time end)
+    return table.slice(items, 1, top)
+end
+
+-- get the short name for showing
+function _get_shortname(name)
+    if #name > 120 then
+        name = name:sub(1, 117) .. "..."
+    end
+    return name
+end
+
+-- show the report of events
+function _show_events(title, events, top, opt)
+    opt = opt or {}
+    local tbl = {align = 'l', sep = "  "}
+    for _, item in ipairs(_get_top_events(events, top)) do
+        table.insert(tbl, {
+            {string.format("%.3fs", item.time / 1000000), style = "${color.dump.number}"},
+            string.format("%dx", item.count),
+            string.format("avg %.1fms", item.time / item.count / 1000),
+            _get_shortname(opt.filepath and path.relative(item.name, os.projectdir()) or item.name)})
+    end
+    cprint("${bright}%s:", title)
+    if #tbl > 0 then
+        cprint(text.table(tbl))
+    else
+        cprint("  ${dim}none")
+    end
+end
+
+-- show the report of translation units
+function _show_units(units, top)
+    table.sort(units, function (a, b) return a.frontend + a.backend > b.frontend + b.backend end)
+    local tbl = {align = 'l', sep = "  "}
+    for _, unit in ipairs(table.slice(units, 1, top)) do
+        table.insert(tbl, {
+            {string.format("%.3fs", (unit.frontend + unit.backend) / 1000000), style = "${color.dump.number}"},
+            string.format("frontend %.3fs", unit.frontend / 1000000),
+            string.format("backend %.3fs", unit.backend / 1000000),
+            unit.sourcefile})
+    end
+    cprint("${bright}translation units:")
+    if #tbl > 0 then
+        cprint(text.table(tbl))
+    else
+        cprint("  ${dim}none")
+    end
+end
+
+function main(argv)
+
+    -- parse arguments
+    local args = option.parse(argv or {}, options, "Analyze the clang time trace files (-ftime-trace) of the build."
+                                           , ""
+                                           , "Please enable the time trace files and rebuild the project first, e.g."
+                                           , ""
+                                           , "    set_policy(\"build.profile.ftime_trace\", true)"
+                                           , ""
+                                           , "Usage: xmake check build.time [options]")
+
+    -- get the time trace files
+    local tracefiles = _get_tracefiles(args)
+    if #tracefiles == 0 then
+        cprint("${color.warning}no time trace files found, please enable the policy(build.profile.ftime_trace) and rebuild the project with clang.")
+        return
+    end
+
+    -- analyze them
+    local analyze_time = os.mclock()
+    local top = tonumber(args.top) or 10
+    local result = _analyze(tracefiles, tonumber(args.jobs) or os.default_njob())
+    analyze_time = os.mclock() - analyze_time
+
+    -- show the reports
+    _show_events("headers (parse time)", result.headers, top, {filepath = true})
+    print("")
+    _show_events("template instantiations", result.templates, top)
+    print("")
+    _show_units(result.units, top)
+    print("")
+    cprint("${color.success}analyzed %d time trace files, spent %.3fs", #tracefiles, analyze_time / 1000)
+end
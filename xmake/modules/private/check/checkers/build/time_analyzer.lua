@@ -0,0 +1,108 @@
+--!A cross-platform build utility based on Lua
+--
+-- Licensed under the Apache License, Version 2.0 (the "License");
+-- you may not use this file except in compliance with the License.
+-- You may obtain a copy of the License at
+--
+--     http://www.apache.org/licenses/LICENSE-2.0
+--
+-- Unless required by applicable law or agreed to in writing, software
+-- distributed under the License is distributed on an "AS IS" BASIS,
+-- WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+-- See the License for the specific language governing permissions and
+-- limitations under the License.
+--
+-- Copyright (C) 2015-present, Xmake Open Source Community.
+--
+-- @author      ruki
+-- @file        time_analyzer.lua
+--
+
+-- imports
+import("core.base.json")
+
+-- add the duration of the given event
+function _add_event(events, name, duration)
+    local event = events[name]
+    if event == nil then
+        event = {time = 0, count = 0}
+        events[name] = event
+    end
+    event.time = event.time + duration
+    event.count = event.count + 1
+end
+
+-- analyze the given time trace file
+--
+-- @see https://github.com/llvm/llvm-project/blob/main/llvm/lib/Support/TimeProfiler.cpp
+--
+function _analyze_file(result, tracefile, sourcefile)
+    local trace = json.loadfile(tracefile)
+    if not trace or not trace.traceEvents then
+        return
+    end
+    local unit = {sourcefile = sourcefile, frontend = 0, backend = 0}
+    local total_frontend, total_backend
+    for _, event in ipairs(trace.traceEvents) do
+        local name = event.name
+        local duration = event.dur
+        if event.ph == "X" and name and duration then
+            local detail = event.args and event.args.detail
+            if name == "Source" and detail then
+                _add_event(result.headers, path.normalize(detail), duration)
+            elseif (name == "InstantiateClass" or name == "InstantiateFunction") and detail then
+                _add_event(result.templates, detail, duration)
+            elseif name == "Total Frontend" then
+                total_frontend = duration
+            elseif name == "Total Backend" then
+                total_backend = duration
+            elseif name == "Frontend" then
+                unit.frontend = unit.frontend + duration
+            elseif name == "Backend" then
+                unit.backend = unit.backend + duration
+            end
+        end
+    end
+
+    -- the old clang has no total events, so we use the sum of frontend/backend events
+    unit.frontend = total_frontend or unit.frontend
+    unit.backend = total_backend or unit.backend
+    table.insert(result.units, unit)
+end
+
+-- new an empty result
+function new_result()
+    return {headers = {}, templates = {}, units = {}}
+end
+
+-- merge the result to the given result
+function merge_result(result, other)
+    for _, kind in ipairs({"headers", "templates"}) do
+        local events = result[kind]
+        for name, event in pairs(other[kind]) do
+            local merged = events[name]
+            if merged then
+                merged.time = merged.time + event.time
+                merged.count = merged.count + event.count
+            else
+                events[name] = event
+            end
+        end
+    end
+    table.join2(result.units, other.units)
+    return result
+end
+
+-- analyze the given time trace files
+--
+-- @param tracefiles    the trace files, e.g. {{tracefile = "build/.objs/foo/src/foo.cpp.json", sourcefile = "src/foo.cpp"}}
+--
+-- @return              the result, e.g. {headers = {["foo.h"] = {time = 100, count = 1}}, templates = {}, units = {}}
+--
+function analyze(tracefiles)
+    local result = new_result()
+    for _, item in ipairs(tracefiles) do
+        _analyze_file(result, item.tracefile, item.sourcefile)
+    end
+    return result
+end
@@ -305,7 +305,8 @@ function new_existinfo(session_id, name, opt)
         code = message.CODE_EXISTINFO,
         name = name,
         session_id = session_id,
-        token = opt.token
+        token = opt.token,
+        bloom_version = opt.bloom_version
     })
 end
 
@@ -89,6 +89,7 @@ function filesync:snapshot()
         ignorefiles = "|" .. table.concat(ignorefiles, "|")
     end
     local count = 0
+    local changedfiles = {}
     -- we should not translate the whole pattern with ignorefiles in path.join,
     -- because the joined pattern string may be very long (> TB_PATH_MAXN)
     -- https://github.com/xmake-io/xmake/issues/6962
@@ -103,13 +104,26 @@ function filesync:snapshot()
             local manifest_info = manifest_old[fileitem]
             local mtime = os.mtime(filepath)
             if not manifest_info or not manifest_info.mtime or mtime > manifest_info.mtime then
-                manifest[fileitem] = {sha256 = hash.sha256(filepath), mtime = mtime}
+                manifest[fileitem] = {mtime = mtime}
+                table.insert(changedfiles, {fileitem = fileitem, filepath = filepath})
             else
                 manifest[fileitem] = manifest_info
             end
             count = count + 1
         end
     end
+
+    -- we hash all changed files in parallel
+    if #changedfiles > 0 then
+        local digests = hash.files(table.imap(changedfiles, function (_, item) return item.filepath end), {algo = "sha256"})
+        for _, item in ipairs(changedfiles) do
+            local sha256 = digests[item.filepath]
+            if not sha256 then
+                raise("cannot generate sha256 for %s", item.filepath)
+            end
+            manifest[item.fileitem].sha256 = sha256
+        end
+    end
     self._MANIFEST = manifest
     self:manifest_save()
     return manifest, count
@@ -262,7 +262,8 @@ function remote_cache_client:existinfo()
     local existinfo
     dprint("%s: get exist info in %s:%d ..", self, addr, port)
     local stream = socket_stream(sock, {send_timeout = self:send_timeout(), recv_timeout = self:recv_timeout()})
-    if stream:send_msg(message.new_existinfo(session_id, "objectfiles", {token = self:token()})) and stream:flush() then
+    local existmsg = message.new_existinfo(session_id, "objectfiles", {token = self:token(), bloom_version = bloom_filter.VERSION_BLOCKED})
+    if stream:send_msg(existmsg) and stream:flush() then
         local data = stream:recv_data()
         if data then
             local msg = stream:recv_msg()
@@ -271,6 +272,7 @@ function remote_cache_client:existinfo()
                 if msg:success() then
                     local count = msg:body().count
                     if count and count > 0 then
+                        -- the old server still sends the legacy data, data_set() will detect it
                         local filter = bloom_filter.new()
                         filter:data_set(data)
                         existinfo = filter
@@ -132,7 +132,13 @@ function server_session:existinfo(respmsg)
     local body = respmsg:body()
     local stream = self:stream()
     local cachedir = self:cachedir()
-    local filter = bloom_filter.new()
+
+    -- the old client can only load the legacy data of the tbox bloom filter
+    local version = bloom_filter.VERSION_LEGACY
+    if body.bloom_version == bloom_filter.VERSION_BLOCKED then
+        version = bloom_filter.VERSION_BLOCKED
+    end
+    local filter = bloom_filter.new({version = version})
     local count = 0
     vprint("get existinfo(%s) ..", body.name)
     for _, objectfile in ipairs(os.files(path.join(cachedir, "*", "*"))) do
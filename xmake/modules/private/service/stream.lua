@@ -30,6 +30,11 @@ import("private.service.message")
 local stream = stream or object()
 
 -- max data buffer size
+--
+-- @note the socket i/o is driven by the tbox poller (epoll/kqueue/iocp), we do not have an io_uring backend,
+-- so we reduce the syscalls in the stream layer instead: the data larger than the caches is sent/received
+-- directly in one blocking call. you can measure it by `xmake l tests/benchmarks/service/stream.lua`.
+--
 local STREAM_DATA_MAXN = 10 * 1024 * 1024
 
 -- the header flags
@@ -88,10 +93,20 @@ function stream:send(data, start, last, opt)
     local size = last + 1 - start
     assert(size <= data:size())
 
-    -- write data to cache first
+    -- send the large data directly to reduce the copies and syscalls
     local cache = self._WCACHE
     local cache_size = self._WCACHE_SIZE
     local cache_maxn = cache:size()
+    if size >= cache_maxn then
+        if not self:flush(opt) then
+            return
+        end
+        local sock = self._SOCK
+        local real = sock:send(data, {block = true, start = start, last = last, timeout = opt.timeout or self:send_timeout()})
+        return real > 0
+    end
+
+    -- write data to cache first
     local cache_left = cache_maxn - cache_size
     if size <= cache_left then
         cache:copy2(cache_size + 1, data, start, last)
@@ -153,18 +168,7 @@ function stream:send_data(data, opt)
     local size = data:size()
     assert(size < STREAM_DATA_MAXN, "too large data size(%d)", size)
     if self:send_header(size, flags, opt) then
-        local send = 0
-        local cache = self._WCACHE
-        local cache_maxn = cache:size()
-        while send < size do
-            local left = math.min(cache_maxn, size - send)
-            if self:send(data, send + 1, send + left, opt) then
-                send = send + left
-            else
-                break
-            end
-        end
-        if send == size then
+        if size == 0 or self:send(data, 1, size, opt) then
             return true
         end
     end
@@ -269,11 +273,21 @@ function stream:recv(buff, size, opt)
     end
     assert(cache_size == 0)
 
+    -- recv the large data to buffer directly to reduce the copies and syscalls
+    local sock = self._SOCK
+    if size - buffsize >= cache_maxn then
+        self._RCACHE_SIZE = 0
+        local real = sock:recv(buff, size - buffsize, {block = true, start = buffsize + 1, timeout = opt.timeout or self:recv_timeout()})
+        if real > 0 then
+            return buff:slice(1, size)
+        end
+        return
+    end
+
     -- recv data from socket
     local real = 0
     local data = nil
     local wait = false
-    local sock = self._SOCK
     while buffsize < size do
         real, data = sock:recv(cache)
         if real > 0 then
@@ -23,8 +23,42 @@ import("core.base.option")
 import("core.base.bytes")
 import("core.compress.lz4")
 
--- archive files
-function _archive_files(archivefile, inputfiles, opt)
+-- the xmz v2 format, all integers are big-endian
+--
+-- header:  "XMZ2" [u32 blocksize]
+-- blocks:  [lz4 block] [lz4 block] ...
+-- index:   [lz4 block]
+-- trailer: [u64 index offset] [u32 index compressed size] [u32 index size] "XMZ2"
+--
+-- the data of all files are concatenated and split into fixed-size blocks,
+-- and each block is compressed independently, so we can compress/decompress them in parallel.
+--
+-- the index data:
+--
+-- [u32 blockcount] {[u32 compressed size] [u32 size]} ...
+-- [u32 filecount] {[u16 pathlen] [path] [u64 size] [u64 offset] [8 bytes xxhash32 hex]} ...
+--
+local XMZ_MAGIC     = "XMZ2"
+local XMZ_BLOCKSIZE = 1024 * 1024
+
+-- make u32be data
+function _u32be(value)
+    return bytes(4):u32be_set(1, value)
+end
+
+-- make u64be data
+function _u64be(value)
+    local data = bytes(8)
+    data:u32be_set(1, math.floor(value / 0x100000000))
+    data:u32be_set(5, value % 0x100000000)
+    return data
+end
+
+-- archive files with the legacy v1 format
+--
+-- [u16 pathlen] [path] [u32 size] [data] ...
+--
+function _archive_files_v1(archivefile, inputfiles, opt)
     local curdir = opt.curdir
     local outputfile = io.open(archivefile, "wb")
     for _, inputfile in ipairs(inputfiles) do
@@ -42,16 +76,117 @@ function _archive_files(archivefile, inputfiles, opt)
     outputfile:close()
 end
 
--- compress file
-function _compress_file(archivefile, outputfile, opt)
-    lz4.compress_file(archivefile, outputfile)
+-- archive files with the v1 format
+function _archive_v1(archivefile, inputfiles, opt)
+    local archivefile_tmp = os.tmpfile({ramdisk = false})
+    _archive_files_v1(archivefile_tmp, inputfiles, opt)
+    lz4.compress_file(archivefile_tmp, archivefile)
+    os.tryrm(archivefile_tmp)
+end
+
+-- archive files with the v2 format
+function _archive_v2(archivefile, inputfiles, opt)
+    local curdir = opt.curdir
+    local threads = opt.threads or os.default_njob()
+    local blocksize = opt.blocksize or XMZ_BLOCKSIZE
+    local checksums = hash.files(inputfiles, {algo = "xxh32", threads = threads})
+
+    local outputfile = io.open(archivefile, "wb")
+    outputfile:write(XMZ_MAGIC)
+    outputfile:write(_u32be(blocksize))
+    local offset = 8
+
+    -- compress and write all pending blocks
+    local blocks = {}
+    local blockinfos = {}
+    local function flush_blocks()
+        if #blocks > 0 then
+            local results = lz4.block_compress_batch(blocks, {threads = threads})
+            for idx, result in ipairs(results) do
+                outputfile:write(result)
+                offset = offset + #result
+                table.insert(blockinfos, {csize = #result, size = #blocks[idx]})
+            end
+            blocks = {}
+        end
+    end
+
+    -- write data of all files to blocks
+    local pieces = {}
+    local pieces_size = 0
+    local datasize = 0
+    local fileinfos = {}
+    for _, inputfile in ipairs(inputfiles) do
+        local filepath = inputfile
+        if curdir then
+            filepath = path.relative(filepath, curdir)
+        end
+        filepath = filepath:gsub("\\", "/")
+        local filesize = os.filesize(inputfile)
+        vprint("archiving %s, %d bytes", inputfile, filesize)
+        table.insert(fileinfos, {path = filepath, size = filesize, offset = datasize, checksum = checksums[inputfile]})
+        if filesize > 0 then
+            local file = io.open(inputfile, "rb")
+            local leftsize = filesize
+            while leftsize > 0 do
+                local readsize = math.min(leftsize, blocksize - pieces_size)
+                local data = file:read(readsize)
+                assert(data and #data == readsize, "read %s failed!", inputfile)
+                table.insert(pieces, data)
+                pieces_size = pieces_size + readsize
+                leftsize = leftsize - readsize
+                if pieces_size == blocksize then
+                    table.insert(blocks, table.concat(pieces))
+                    pieces = {}
+                    pieces_size = 0
+                    if #blocks >= threads * 2 then
+                        flush_blocks()
+                    end
+                end
+            end
+            file:close()
+            datasize = datasize + filesize
+        end
+        assert(fileinfos[#fileinfos].checksum, "cannot generate checksum for %s", inputfile)
+    end
+    if pieces_size > 0 then
+        table.insert(blocks, table.concat(pieces))
+    end
+    flush_blocks()
+
+    -- write index
+    local index = {}
+    table.insert(index, _u32be(#blockinfos):str())
+    for _, blockinfo in ipairs(blockinfos) do
+        table.insert(index, _u32be(blockinfo.csize):str())
+        table.insert(index, _u32be(blockinfo.size):str())
+    end
+    table.insert(index, _u32be(#fileinfos):str())
+    for _, fileinfo in ipairs(fileinfos) do
+        table.insert(index, bytes(2):u16be_set(1, #fileinfo.path):str())
+        table.insert(index, fileinfo.path)
+        table.insert(index, _u64be(fileinfo.size):str())
+        table.insert(index, _u64be(fileinfo.offset):str())
+        table.insert(index, fileinfo.checksum)
+    end
+    index = table.concat(index)
+    local index_data = lz4.block_compress(index)
+    outputfile:write(index_data)
+
+    -- write trailer
+    outputfile:write(_u64be(offset))
+    outputfile:write(_u32be(index_data:size()))
+    outputfile:write(_u32be(#index))
+    outputfile:write(XMZ_MAGIC)
+    outputfile:close()
 end
 
 -- archive file
 --
 -- @param archivefile   the archive file. e.g. *.tar.gz, *.zip, *.7z, *.tar.bz2, ..
 -- @param inputfiles    the input file or directory or list
--- @param options       the options, e.g.. {curdir = "/tmp", recurse = true, compress = "fastest|faster|default|better|best", excludes = {"*/dir/*", "dir/*"}}
+-- @param options       the options, e.g.. {curdir = "/tmp", recurse = true, compress = "fastest|faster|default|better|best", excludes = {"*/dir/*", "dir/*"},
+--                      xmz_version = 2, blocksize = 1048576, threads = 8}
 --
 function main(archivefile, inputfiles, opt)
     opt = opt or {}
@@ -65,8 +200,9 @@ function main(archivefile, inputfiles, opt)
     end
     inputfiles = files
 
-    local archivefile_tmp = os.tmpfile({ramdisk = false})
-    _archive_files(archivefile_tmp, inputfiles, opt)
-    _compress_file(archivefile_tmp, archivefile, opt)
-    os.tryrm(archivefile_tmp)
+    if opt.xmz_version == 1 then
+        _archive_v1(archivefile, inputfiles, opt)
+    else
+        _archive_v2(archivefile, inputfiles, opt)
+    end
 end
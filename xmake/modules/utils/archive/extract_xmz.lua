@@ -23,8 +23,25 @@ import("core.base.option")
 import("core.base.bytes")
 import("core.compress.lz4")
 
--- extract files
-function _extract_files(archivefile, outputdir, opt)
+-- the xmz v2 magic, @see archive_xmz.lua
+local XMZ_MAGIC = "XMZ2"
+
+-- get u64be value
+function _u64be(data, offset)
+    local hi = data:u32be(offset)
+    local lo = data:u32be(offset + 4)
+    return (hi % 0x100000000) * 0x100000000 + (lo % 0x100000000)
+end
+
+-- is the xmz v2 format?
+function _is_v2(inputfile)
+    inputfile:seek("set", 0)
+    local magic = inputfile:read(4)
+    return magic == XMZ_MAGIC
+end
+
+-- extract files with the legacy v1 format
+function _extract_files_v1(archivefile, outputdir, opt)
     local inputfile = io.open(archivefile, "rb")
     local filesize = inputfile:size()
     local readsize = 0
@@ -55,22 +72,196 @@ function _extract_files(archivefile, outputdir, opt)
     inputfile:close()
 end
 
--- decompress file
-function _decompress_file(archivefile, outputfile, opt)
-    lz4.decompress_file(archivefile, outputfile)
+-- extract files with the v1 format
+function _extract_v1(archivefile, outputdir, opt)
+    local archivefile_tmp = os.tmpfile({ramdisk = false})
+    lz4.decompress_file(archivefile, archivefile_tmp)
+    _extract_files_v1(archivefile_tmp, outputdir, opt)
+    os.tryrm(archivefile_tmp)
+end
+
+-- load the index of v2 format
+function _load_index(inputfile)
+    local filesize = inputfile:size()
+    assert(filesize >= 28, "invalid xmz archive!")
+
+    -- load header
+    inputfile:seek("set", 4)
+    local blocksize = bytes(inputfile:read(4)):u32be(1)
+
+    -- load trailer
+    inputfile:seek("set", filesize - 20)
+    local trailer = bytes(inputfile:read(20))
+    assert(trailer:str(17, 20) == XMZ_MAGIC, "invalid xmz archive trailer!")
+    local index_offset = _u64be(trailer, 1)
+    local index_csize = trailer:u32be(9)
+    local index_size = trailer:u32be(13)
+
+    -- load index
+    inputfile:seek("set", index_offset)
+    local index = lz4.block_decompress(bytes(inputfile:read(index_csize)), index_size)
+    local pos = 1
+    local blockcount = index:u32be(pos)
+    pos = pos + 4
+    local blockinfos = {}
+    local offset = 8
+    for i = 1, blockcount do
+        local csize = index:u32be(pos)
+        local size = index:u32be(pos + 4)
+        table.insert(blockinfos, {offset = offset, csize = csize, size = size})
+        offset = offset + csize
+        pos = pos + 8
+    end
+    local filecount = index:u32be(pos)
+    pos = pos + 4
+    local fileinfos = {}
+    for i = 1, filecount do
+        local pathlen = index:u16be(pos)
+        local filepath = index:str(pos + 2, pos + 1 + pathlen)
+        pos = pos + 2 + pathlen
+        local size = _u64be(index, pos)
+        local fileoffset = _u64be(index, pos + 8)
+        local checksum = index:str(pos + 16, pos + 23)
+        pos = pos + 24
+        table.insert(fileinfos, {path = filepath, size = size, offset = fileoffset, checksum = checksum})
+    end
+    return {blocksize = blocksize, blocks = blockinfos, files = fileinfos}
+end
+
+-- extract files with the v2 format
+function _extract_v2(inputfile, outputdir, opt)
+    local index = _load_index(inputfile)
+    local threads = opt.threads or os.default_njob()
+    local blocksize = index.blocksize
+
+    -- get the files to be extracted
+    local fileinfos = index.files
+    if opt.files then
+        local selected = {}
+        for _, filepath in ipairs(table.wrap(opt.files)) do
+            selected[path.unix(filepath)] = true
+        end
+        fileinfos = {}
+        for _, fileinfo in ipairs(index.files) do
+            if selected[fileinfo.path] then
+                table.insert(fileinfos, fileinfo)
+            end
+        end
+    end
+
+    -- get the blocks to be decompressed
+    local blockindices = {}
+    local blockset = {}
+    local datafiles = {}
+    for _, fileinfo in ipairs(fileinfos) do
+        local outputfile = path.join(outputdir, fileinfo.path)
+        fileinfo.outputfile = outputfile
+        os.mkdir(path.directory(outputfile))
+        if fileinfo.size > 0 then
+            local first = math.floor(fileinfo.offset / blocksize) + 1
+            local last = math.floor((fileinfo.offset + fileinfo.size - 1) / blocksize) + 1
+            for blockidx = first, last do
+                if not blockset[blockidx] then
+                    blockset[blockidx] = true
+                    table.insert(blockindices, blockidx)
+                end
+            end
+            table.insert(datafiles, fileinfo)
+        else
+            vprint("extracting %s, 0 bytes", fileinfo.path)
+            io.writefile(outputfile, "", {encoding = "binary"})
+        end
+    end
+    table.sort(blockindices)
+    table.sort(datafiles, function (a, b) return a.offset < b.offset end)
+
+    -- write the decompressed block data to files
+    local fileidx = 1
+    local function write_block(blockidx, data)
+        local block_start = (blockidx - 1) * blocksize
+        local block_end = block_start + #data
+        local idx = fileidx
+        while idx <= #datafiles and datafiles[idx].offset < block_end do
+            local fileinfo = datafiles[idx]
+            local file_end = fileinfo.offset + fileinfo.size
+            if file_end > block_start then
+                if not fileinfo.file then
+                    vprint("extracting %s, %d bytes", fileinfo.path, fileinfo.size)
+                    fileinfo.file = io.open(fileinfo.outputfile, "wb")
+                end
+                local data_start = math.max(fileinfo.offset, block_start)
+                local data_end = math.min(file_end, block_end)
+                fileinfo.file:write(data:sub(data_start - block_start + 1, data_end - block_start))
+            end
+            if file_end <= block_end then
+                if fileinfo.file then
+                    fileinfo.file:close()
+                    fileinfo.file = nil
+                end
+                fileidx = idx + 1
+            end
+            idx = idx + 1
+        end
+    end
+
+    -- decompress blocks in parallel
+    local batchsize = threads * 2
+    for i = 1, #blockindices, batchsize do
+        local batch = {}
+        local blocks = {}
+        local realsizes = {}
+        for j = i, math.min(i + batchsize - 1, #blockindices) do
+            local blockidx = blockindices[j]
+            local blockinfo = index.blocks[blockidx]
+            assert(blockinfo, "invalid block(%d) in xmz archive!", blockidx)
+            inputfile:seek("set", blockinfo.offset)
+            table.insert(batch, blockidx)
+            table.insert(blocks, inputfile:read(blockinfo.csize))
+            table.insert(realsizes, blockinfo.size)
+        end
+        local results = lz4.block_decompress_batch(blocks, realsizes, {threads = threads})
+        for idx, blockidx in ipairs(batch) do
+            write_block(blockidx, results[idx])
+        end
+    end
+
+    -- verify checksums
+    local outputfiles = table.imap(fileinfos, function (_, fileinfo) return fileinfo.outputfile end)
+    local checksums = hash.files(outputfiles, {algo = "xxh32", threads = threads})
+    for _, fileinfo in ipairs(fileinfos) do
+        if checksums[fileinfo.outputfile] ~= fileinfo.checksum then
+            raise("extract %s failed, checksum mismatch!", fileinfo.path)
+        end
+    end
+end
+
+-- list files in the given xmz archive, only for v2 format
+--
+-- @param archivefile   the archive file
+-- @return              the file list, e.g. {{path = "a/b.lua", size = 100}, ...}
+--
+function list(archivefile)
+    local inputfile = io.open(archivefile, "rb")
+    assert(_is_v2(inputfile), "%s is not a xmz v2 archive, listing is not supported!", archivefile)
+    local index = _load_index(inputfile)
+    inputfile:close()
+    return table.imap(index.files, function (_, fileinfo) return {path = fileinfo.path, size = fileinfo.size} end)
 end
 
 -- extract file
 --
 -- @param archivefile   the archive file. e.g. *.tar.gz, *.zip, *.7z, *.tar.bz2, ..
 -- @param outputdir     the output directory
--- @param options       the options, e.g.. {excludes = {"*/dir/*", "dir/*"}}
+-- @param options       the options, e.g.. {excludes = {"*/dir/*", "dir/*"}, files = {"a/b.lua"}, threads = 8}
 --
 function main(archivefile, outputdir, opt)
     opt = opt or {}
-
-    local archivefile_tmp = os.tmpfile({ramdisk = false})
-    _decompress_file(archivefile, archivefile_tmp, opt)
-    _extract_files(archivefile_tmp, outputdir, opt)
-    os.tryrm(archivefile_tmp)
+    local inputfile = io.open(archivefile, "rb")
+    if _is_v2(inputfile) then
+        _extract_v2(inputfile, outputdir, opt)
+        inputfile:close()
+    else
+        inputfile:close()
+        _extract_v1(archivefile, outputdir, opt)
+    end
 end
@@ -23,6 +23,7 @@ import("core.base.option")
 import("core.base.hashset")
 import("core.tool.compiler")
 import("core.project.rule")
+import("core.project.config")
 import("core.project.project")
 import("core.language.language")
 import("private.utils.batchcmds")
@@ -225,6 +226,7 @@ function _make_arguments(jsonfile, arguments, opt)
     -- clear first line marks
     _g.firstline = false
     map[key] = true
+    table.insert(_g.fragment_keys, key)
 end
 
 -- add target custom commands
@@ -238,7 +240,7 @@ end
 
 -- add target source commands
 function _add_target_source_commands(jsonfile, target)
-    for _, sourcebatch in pairs(target:sourcebatches()) do
+    for _, sourcebatch in table.orderpairs(target:sourcebatches()) do
         local sourcekind = sourcebatch.sourcekind
         if sourcekind and _sourcebatch_is_built(sourcebatch) then
             for index, sourcefile in ipairs(sourcebatch.sourcefiles) do
@@ -251,23 +253,103 @@ function _add_target_source_commands(jsonfile, target)
 end
 
 -- add target commands
-function _add_target_commands(jsonfile, target)
+function _add_target_commands(jsonfile, target, cmds_before, cmds_after)
 
     -- add before commands
-    -- we use irpairs(groups), because the last group that should be given the highest priority.
-    local cmds_before = target_cmds.get_target_buildcmds(target, {stages = {"before", "on"}})
     _add_target_custom_commands(jsonfile, target, "before", cmds_before)
 
     -- add target source commands
     _add_target_source_commands(jsonfile, target)
 
     -- add after commands
-    local cmds_after = target_cmds.get_target_buildcmds(target, {stages = {"after"}})
     _add_target_custom_commands(jsonfile, target, "after", cmds_after)
 end
 
+-- get the cache directory of the target fragments
+function _get_cachedir()
+    return path.join(config.builddir(), ".gens", "project", "compile_commands")
+end
+
+-- get the fragment cache info
+function _get_cacheinfo()
+    local cacheinfo = _g.cacheinfo
+    if cacheinfo == nil then
+        local cachefile = path.join(_get_cachedir(), "fragments.txt")
+        cacheinfo = os.isfile(cachefile) and io.load(cachefile) or {}
+        _g.cacheinfo = cacheinfo
+    end
+    return cacheinfo
+end
+
+-- save the fragment cache info
+function _save_cacheinfo(cacheinfo)
+    io.save(path.join(_get_cachedir(), "fragments.txt"), cacheinfo, {orderkeys = true})
+end
+
+-- get the fragment key of target
+--
+-- it contains the target compile flags, the source files and their file configs,
+-- so we need not compute the compile arguments of all source files if nothing has been changed.
+--
+function _get_fragment_key(target, cmds_before, cmds_after)
+    local items = {xmake.version():shortstr(), _get_lsp() or "", os.projectdir()}
+    for _, cmds in ipairs({cmds_before, cmds_after}) do
+        for _, cmd in ipairs(cmds) do
+            if cmd.program then
+                table.insert(items, os.args(table.join(cmd.program, cmd.argv)))
+            end
+        end
+    end
+    local sourcekinds = {}
+    local pcheader_excluded = target:data("pcheader.auto.excluded")
+    for _, sourcebatch in table.orderpairs(target:sourcebatches()) do
+        local sourcekind = sourcebatch.sourcekind
+        if sourcekind and _sourcebatch_is_built(sourcebatch) then
+            local compinst = sourcekinds[sourcekind]
+            if not compinst then
+                compinst = compiler.load(sourcekind, {target = target})
+                table.insert(items, compinst:program())
+                table.insert(items, os.args(compinst:compflags({target = target})))
+                sourcekinds[sourcekind] = compinst
+            end
+            table.insert(items, sourcebatch.rulename)
+            for index, sourcefile in ipairs(sourcebatch.sourcefiles) do
+                table.insert(items, sourcefile)
+                table.insert(items, sourcebatch.objectfiles[index])
+
+                -- the files may have their own flags, e.g. add_files("src/*.c", {cxflags = "-O0"}) or the flags added by rules,
+                -- and we need not use the precompiled header for the files excluded by the auto pcheader.
+                if target:fileconfig(sourcefile) or (pcheader_excluded and pcheader_excluded[sourcefile]) then
+                    table.insert(items, os.args(compinst:compflags({target = target, sourcefile = sourcefile})))
+                end
+            end
+        end
+    end
+    return hash.strhash128(table.concat(items, "\n"))
+end
+
+-- try to reuse the cached fragment of target
+function _reuse_fragment(fragmentfile, fraginfo, fragmentkey)
+    if not fraginfo or fraginfo.key ~= fragmentkey or not os.isfile(fragmentfile) then
+        return false
+    end
+
+    -- some entries have been added by other targets? we need to regenerate it to remove them
+    local map = _g.map or {}
+    _g.map = map
+    for _, key in ipairs(fraginfo.keys) do
+        if map[key] then
+            return false
+        end
+    end
+    for _, key in ipairs(fraginfo.keys) do
+        map[key] = true
+    end
+    return true
+end
+
 -- add target
-function _add_target(jsonfile, target)
+function _add_target(fragments, target, cachename)
 
     -- https://github.com/xmake-io/xmake/issues/2337
     target:data_set("plugin.project.kind", "compile_commands")
@@ -280,8 +362,30 @@ function _add_target(jsonfile, target)
     -- enter package environments
     local oldenvs = os.addenvs(target:pkgenvs())
 
-    -- add target commands
-    _add_target_commands(jsonfile, target)
+    -- get custom commands
+    local cmds_before = target_cmds.get_target_buildcmds(target, {stages = {"before", "on"}})
+    local cmds_after = target_cmds.get_target_buildcmds(target, {stages = {"after"}})
+
+    -- only regenerate the fragment of the changed target
+    local cacheinfo = _get_cacheinfo()
+    local fraginfo = cacheinfo[cachename]
+    _g.visited = _g.visited or {}
+    _g.visited[cachename] = true
+    local fragmentkey = _get_fragment_key(target, cmds_before, cmds_after)
+    local fragmentfile = path.join(_get_cachedir(), hash.strhash32(cachename) .. ".json")
+    if not _reuse_fragment(fragmentfile, fraginfo, fragmentkey) then
+        local fragment = io.open(fragmentfile, "w")
+        _g.firstline = true
+        _g.fragment_keys = {}
+        _add_target_commands(fragment, target, cmds_before, cmds_after)
+        fragment:close()
+        fraginfo = {key = fragmentkey, keys = _g.fragment_keys}
+        cacheinfo[cachename] = fraginfo
+        _g.cacheinfo_changed = true
+    end
+    if #fraginfo.keys > 0 then
+        table.insert(fragments, {file = fragmentfile, key = fragmentkey})
+    end
 
     -- restore package environments
     os.setenvs(oldenvs)
@@ -293,7 +397,7 @@ function _get_test_targets()
     local test_targets = _g.test_targets
     if test_targets == nil then
         test_targets = {}
-        for _, test in pairs(test_action.get_tests()) do
+        for _, test in table.orderpairs(test_action.get_tests()) do
             local target = test.target
             if not target:is_phony() then
                 table.insert(test_targets, target)
@@ -304,22 +408,40 @@ function _get_test_targets()
     return test_targets
 end
 
--- add targets
-function _add_targets(jsonfile)
-    jsonfile:print("[")
-    _g.firstline = true
-
+-- add targets and get all target fragments
+function _add_targets()
+    local fragments = {}
     local project_targets = target_utils.get_project_targets()
-    for _, target in pairs(project_targets) do
+    for _, target in table.orderpairs(project_targets) do
         if not target:is_phony() then
-            _add_target(jsonfile, target)
+            _add_target(fragments, target, "target::" .. target:fullname())
         end
     end
     -- https://github.com/xmake-io/xmake/issues/4750
     for _, target in ipairs(_get_test_targets()) do
-        _add_target(jsonfile, target)
+        _add_target(fragments, target, "test::" .. target:fullname())
     end
-    jsonfile:print("]")
+    return fragments
+end
+
+-- write all target fragments to the compile_commands.json
+--
+-- we stream the fragments to a temporary file and rename it to compile_commands.json,
+-- so the LSP server (e.g. clangd) never reads a half-written file.
+--
+function _write_fragments(jsonpath, fragments)
+    local tmpfile = jsonpath .. ".tmp"
+    local jsonfile = io.open(tmpfile, "wb")
+    jsonfile:write("[\n")
+    for idx, fragment in ipairs(fragments) do
+        if idx > 1 then
+            jsonfile:write(",\n")
+        end
+        jsonfile:write(io.readfile(fragment.file))
+    end
+    jsonfile:write("]\n")
+    jsonfile:close()
+    os.mv(tmpfile, jsonpath)
 end
 
 -- prepare targets
@@ -338,11 +460,32 @@ end
 --
 function make(outputdir)
     local oldir = os.cd(os.projectdir())
-    local jsonfile = io.open(path.join(outputdir, "compile_commands.json"), "w")
     os.setenv("XMAKE_IN_COMPILE_COMMANDS_PROJECT_GENERATOR", "true")
     _prepare_targets()
-    _add_targets(jsonfile)
-    jsonfile:close()
+    local fragments = _add_targets()
+
+    -- remove the stale fragments of the removed targets
+    local cacheinfo = _get_cacheinfo()
+    for cachename, _ in pairs(table.clone(cacheinfo)) do
+        if cachename ~= "__jsonkey" and not (_g.visited and _g.visited[cachename]) then
+            os.tryrm(path.join(_get_cachedir(), hash.strhash32(cachename) .. ".json"))
+            cacheinfo[cachename] = nil
+            _g.cacheinfo_changed = true
+        end
+    end
+
+    -- write it only if some fragments have been changed
+    local keys = {}
+    for _, fragment in ipairs(fragments) do
+        table.insert(keys, fragment.key)
+    end
+    local jsonpath = path.join(outputdir or ".", "compile_commands.json")
+    local jsonkey = hash.strhash128(path.absolute(jsonpath) .. table.concat(keys, ","))
+    if _g.cacheinfo_changed or cacheinfo.__jsonkey ~= jsonkey or not os.isfile(jsonpath) then
+        _write_fragments(jsonpath, fragments)
+        cacheinfo.__jsonkey = jsonkey
+        _save_cacheinfo(cacheinfo)
+    end
     os.setenv("XMAKE_IN_COMPILE_COMMANDS_PROJECT_GENERATOR", nil)
     os.cd(oldir)
 end
@@ -19,6 +19,7 @@
 --
 
 -- imports
+import("core.base.hashset")
 import("core.project.config")
 import("core.project.project")
 import("core.platform.platform")
@@ -30,6 +31,7 @@ import("lib.detect.find_toolname")
 import("core.tools.cl.parse_include")
 import("plugins.project.utils.target_cmds", {rootdir = os.programdir()})
 import("private.utils.target", {alias = "target_utils"})
+import("rules.c++.modules.support", {rootdir = os.programdir(), alias = "modules_support"})
 
 -- this sourcebatch is built?
 function _sourcebatch_is_built(sourcebatch)
@@ -123,7 +125,7 @@ function _add_header(ninjafile)
 # it is autogenerated by the xmake build system.
 # do not edit by hand.
 ]], project.name() or "")
-    ninjafile:print("ninja_required_version = 1.5.1")
+    ninjafile:print("ninja_required_version = %s", _g.has_modules and "1.10" or "1.5.1")
     ninjafile:print("")
 end
 
@@ -133,6 +135,47 @@ function _add_rules_for_generator(ninjafile, outputdir)
     ninjafile:print("rule gen")
     ninjafile:print(" command = xmake project -P %s -k ninja", projectdir)
     ninjafile:print(" description = regenerating ninja files")
+    ninjafile:print(" generator = 1")
+    ninjafile:print(" restat = 1")
+    ninjafile:print("")
+end
+
+-- add rules for configfiles
+--
+-- the configfiles will be updated only if they have been changed,
+-- so we use `restat = 1` to avoid rebuilding all source files including them.
+--
+function _add_rules_for_configfiles(ninjafile, outputdir)
+    local projectdir = _get_relative_unix_path(os.projectdir(), outputdir)
+    ninjafile:print("rule configfiles")
+    ninjafile:print(" command = xmake config -P %s", projectdir)
+    ninjafile:print(" description = generating configfiles")
+    ninjafile:print(" restat = 1")
+    ninjafile:print("")
+end
+
+-- get the depth of link pool
+--
+-- the linker may use a lot of memory, e.g. lto and debug info,
+-- so we limit the parallel links according to the available memory, 2GB for each link by default.
+--
+-- we can also set it by `XMAKE_GENERATOR_NINJA_LINKPOOL=4 xmake project -k ninja`
+--
+function _get_link_pool_depth()
+    local depth = tonumber(os.getenv("XMAKE_GENERATOR_NINJA_LINKPOOL"))
+    if not depth then
+        local availsize = os.meminfo("availsize")
+        depth = availsize and math.floor(availsize / 2048) or 1
+        depth = math.min(depth, os.cpuinfo("ncpu") or 1)
+    end
+    return math.max(1, depth)
+end
+
+-- add pools
+function _add_pools(ninjafile)
+    ninjafile:print("# pools")
+    ninjafile:print("pool link_pool")
+    ninjafile:print(" depth = %d", _get_link_pool_depth())
     ninjafile:print("")
 end
 
@@ -258,6 +301,9 @@ function _add_rules_for_linker_gcc(ninjafile, linkerkind, program)
     ninjafile:print("rule %s", linkerkind)
     ninjafile:print(" command = %s -o $out $in $ARGS", program)
     ninjafile:print(" description = linking.%s $out", config.mode())
+    if linkerkind ~= "ar" then
+        ninjafile:print(" pool = link_pool")
+    end
     ninjafile:print("")
 end
 
@@ -279,6 +325,9 @@ function _add_rules_for_linker_msvc(ninjafile, linkerkind, program)
     ninjafile:print(" rspfile = $out.rsp")
     ninjafile:print(" rspfile_content = $ARGS -out:$out $in_newline")
     ninjafile:print(" description = linking.%s $out", config.mode())
+    if linkerkind ~= "ar" then
+        ninjafile:print(" pool = link_pool")
+    end
     ninjafile:print("")
 end
 
@@ -314,17 +363,109 @@ function _add_rules_for_linker(ninjafile)
     ninjafile:print("")
 end
 
+-- get the c++ modules toolkind of target, only gcc and clang are supported now
+function _get_modules_toolkind(target)
+    if not target:data("cxx.has_modules") then
+        return
+    end
+    if target:has_tool("cxx", "clang", "clangxx") then
+        return "clang"
+    elseif target:has_tool("cxx", "gcc", "gxx") then
+        return "gcc"
+    end
+end
+
+-- get the c++ modules rule name of target, e.g. cxx_scan_gcc_xxx, cxx_module_gcc_xxx
+--
+-- the targets may use the different compilers, so we need to add the rules for each compiler.
+--
+function _get_modules_rulename(target, name)
+    local program = target:tool("cxx")
+    return name .. "_" .. _get_modules_toolkind(target) .. "_" .. hash.strhash32(program)
+end
+
+-- add rules for c++ modules of the given compiler
+function _add_rules_for_modules_of(ninjafile, target)
+    local toolkind = _get_modules_toolkind(target)
+    local program = target:tool("cxx")
+    local cxx_scan = _get_modules_rulename(target, "cxx_scan")
+    local cxx_module = _get_modules_rulename(target, "cxx_module")
+    if toolkind == "gcc" then
+        ninjafile:print("rule %s", cxx_scan)
+        ninjafile:print(" command = %s $ARGS -E -x c++ $in -MT $out -MD -MF $out.d -fdeps-format=p1689r5 -fdeps-file=$out -fdeps-target=$OBJ -o $out.i", program)
+        ninjafile:print(" deps = gcc")
+        ninjafile:print(" depfile = $out.d")
+        ninjafile:print(" description = scanning.module.deps $in")
+        ninjafile:print("")
+        ninjafile:print("rule %s", cxx_module)
+        ninjafile:print(" command = %s $ARGS -fmodule-mapper=$MODMAP -MMD -MF $out.d -o $out -x c++ -c $in", program)
+    else
+        -- we need absolute path of clang to use clang-scan-deps
+        -- @see https://clang.llvm.org/docs/StandardCPlusPlusModules.html#possible-issues-failed-to-find-system-headers
+        local support = modules_support.import_implementation_of(target, "support")
+        local clangscandeps = assert(support.get_clang_scan_deps(target), "clang-scan-deps not found!")
+        local clang_path = support.get_clang_path(target) or program
+        ninjafile:print("rule %s", cxx_scan)
+        ninjafile:print(" command = %s --format=p1689 -o $out -- %s -x c++ $ARGS -c $in -o $OBJ -MT $out -MD -MF $out.d", clangscandeps, clang_path)
+        ninjafile:print(" deps = gcc")
+        ninjafile:print(" depfile = $out.d")
+        ninjafile:print(" description = scanning.module.deps $in")
+        ninjafile:print("")
+        ninjafile:print("rule %s", cxx_module)
+        ninjafile:print(" command = %s $ARGS @$MODMAP -MMD -MF $out.d -o $out -c $in", program)
+    end
+    ninjafile:print(" deps = gcc")
+    ninjafile:print(" depfile = $out.d")
+    ninjafile:print(" description = compiling.module.%s $in", config.mode())
+    ninjafile:print("")
+end
+
+-- add rules for c++ modules
+--
+-- we scan the module dependencies (p1689) of all source files, and collate them to the dyndep file of target,
+-- so ninja can know the bmi files provided and required by each object file before compiling it.
+--
+-- @see https://ninja-build.org/manual.html#ref_dyndep
+--
+function _add_rules_for_modules(ninjafile)
+    local modules_targets = _g.modules_targets
+    if not modules_targets then
+        return
+    end
+    ninjafile:print("# rules for c++ modules")
+    for _, target in ipairs(modules_targets) do
+        _add_rules_for_modules_of(ninjafile, target)
+    end
+
+    -- the dyndep and module mapper files are updated only if they have been changed
+    ninjafile:print("rule cxx_dyndep")
+    ninjafile:print(" command = xmake l %s $TOOLKIND $out $MODULES $BMIDIR $DEPS $in",
+        os.args(path.join(os.programdir(), "plugins", "project", "ninja", "dyndep.lua")))
+    ninjafile:print(" description = generating.module.dyndep $out")
+    ninjafile:print(" restat = 1")
+    ninjafile:print("")
+end
+
 -- add rules
 function _add_rules(ninjafile, outputdir)
 
+    -- add pools
+    _add_pools(ninjafile)
+
     -- add rules for generator
     _add_rules_for_generator(ninjafile, outputdir)
 
+    -- add rules for configfiles
+    _add_rules_for_configfiles(ninjafile, outputdir)
+
     -- add rules for complier
     _add_rules_for_compiler(ninjafile)
 
     -- add rules for linker
     _add_rules_for_linker(ninjafile)
+
+    -- add rules for c++ modules
+    _add_rules_for_modules(ninjafile)
 end
 
 -- add build rule for phony
@@ -332,21 +473,117 @@ function _add_build_for_phony(ninjafile, target)
     ninjafile:print("build %s: phony", target:name())
 end
 
+-- get the order-only dependencies of the object files, e.g. configfiles
+function _get_object_orderdeps(target, outputdir)
+    local orderdeps = {}
+    local _, dstfiles = target:configfiles()
+    for _, dstfile in ipairs(dstfiles) do
+        table.insert(orderdeps, _get_relative_unix_path(dstfile, outputdir))
+    end
+    return orderdeps
+end
+
 -- add build rule for object
-function _add_build_for_object(ninjafile, target, sourcekind, sourcefile, objectfile, outputdir)
+function _add_build_for_object(ninjafile, target, sourcekind, sourcefile, objectfile, outputdir, orderdeps)
+    local compflags = compiler.compflags(sourcefile, {target = target})
     objectfile = _get_relative_unix_path(objectfile, outputdir)
     sourcefile = _get_relative_unix_path(sourcefile, outputdir)
-    local compflags = compiler.compflags(sourcefile, {target = target})
-    ninjafile:print("build %s: %s %s", objectfile, sourcekind, sourcefile)
+    ninjafile:print("build %s: %s %s%s", objectfile, sourcekind, sourcefile,
+        #orderdeps > 0 and (" || " .. table.concat(orderdeps, " ")) or "")
     ninjafile:print(" ARGS = %s", os.args(_translate_compflags(compflags, outputdir)))
     ninjafile:print("")
 end
 
 -- add build rule for objects
-function _add_build_for_objects(ninjafile, target, sourcebatch, outputdir)
+function _add_build_for_objects(ninjafile, target, sourcebatch, outputdir, orderdeps, skipped)
     for index, objectfile in ipairs(sourcebatch.objectfiles) do
-        _add_build_for_object(ninjafile, target,  sourcebatch.sourcekind, sourcebatch.sourcefiles[index], objectfile, outputdir)
+        local sourcefile = sourcebatch.sourcefiles[index]
+        if not skipped or not skipped:has(sourcefile) then
+            _add_build_for_object(ninjafile, target,  sourcebatch.sourcekind, sourcefile, objectfile, outputdir, orderdeps)
+        end
+    end
+end
+
+-- get the c++ modules dyndep files of target
+function _get_modules_dyndep(target)
+    local dir = path.join(target:autogendir(), "rules", "modules", "ninja")
+    return path.join(dir, "modules.dd"), path.join(dir, "modules.json"), path.join(dir, "bmi")
+end
+
+-- get the c++ module source files of target
+function _get_modules_sourcefiles(target)
+    local sourcebatch = target:sourcebatches()["c++.build.modules.scanner"]
+    return sourcebatch and sourcebatch.sourcefiles or {}
+end
+
+-- add build rule for c++ modules
+--
+-- we use the bmi files of the dependent targets directly instead of rebuilding them in each target,
+-- so the module flags of the dependent targets should be compatible with the current target.
+--
+function _add_build_for_modules(ninjafile, target, outputdir, orderdeps)
+    local ddfile, modulesfile, bmidir = _get_modules_dyndep(target)
+    ddfile = _get_relative_unix_path(ddfile, outputdir)
+    modulesfile = _get_relative_unix_path(modulesfile, outputdir)
+    bmidir = _get_relative_unix_path(bmidir, outputdir)
+    local orderdeps_str = #orderdeps > 0 and (" || " .. table.concat(orderdeps, " ")) or ""
+
+    -- scan module dependencies
+    local objects = {}
+    for _, sourcefile in ipairs(_get_modules_sourcefiles(target)) do
+        local objectfile = _get_relative_unix_path(target:objectfile(sourcefile), outputdir)
+        local compflags = compiler.compflags(sourcefile, {target = target, sourcekind = "cxx"})
+        local object = {
+            objectfile = objectfile,
+            sourcefile = _get_relative_unix_path(sourcefile, outputdir),
+            ddifile = objectfile .. ".ddi",
+            modmapfile = objectfile .. ".modmap",
+            flags = os.args(_translate_compflags(compflags, outputdir))}
+        ninjafile:print("build %s: %s %s%s", object.ddifile, _get_modules_rulename(target, "cxx_scan"), object.sourcefile, orderdeps_str)
+        ninjafile:print(" ARGS = %s", object.flags)
+        ninjafile:print(" OBJ = %s", object.objectfile)
+        ninjafile:print("")
+        table.insert(objects, object)
     end
+
+    -- collate all scanned files to the dyndep file
+    local depsfiles = {}
+    for _, dep in ipairs(target:orderdeps()) do
+        if _get_modules_toolkind(dep) then
+            local _, dep_modulesfile = _get_modules_dyndep(dep)
+            table.insert(depsfiles, _get_relative_unix_path(dep_modulesfile, outputdir))
+        end
+    end
+    ninjafile:printf("build %s | %s", ddfile, modulesfile)
+    for _, object in ipairs(objects) do
+        ninjafile:write(" $\n  " .. object.modmapfile)
+    end
+    ninjafile:write(": cxx_dyndep")
+    for _, object in ipairs(objects) do
+        ninjafile:write(" $\n  " .. object.ddifile)
+    end
+    if #depsfiles > 0 then
+        ninjafile:write(" | " .. table.concat(depsfiles, " "))
+    end
+    ninjafile:print("")
+    ninjafile:print(" TOOLKIND = %s", _get_modules_toolkind(target))
+    ninjafile:print(" MODULES = %s", modulesfile)
+    ninjafile:print(" BMIDIR = %s", bmidir)
+    ninjafile:print(" DEPS = %s", #depsfiles > 0 and table.concat(depsfiles, ",") or "-")
+    ninjafile:print("")
+
+    -- compile module files, the provided and required bmi files will be loaded from the dyndep file
+    local objectfiles = {}
+    for _, object in ipairs(objects) do
+        ninjafile:print("build %s: %s %s | %s || %s%s", object.objectfile, _get_modules_rulename(target, "cxx_module"),
+            object.sourcefile, object.modmapfile, ddfile, #orderdeps > 0 and (" " .. table.concat(orderdeps, " ")) or "")
+        ninjafile:print(" ARGS = %s", object.flags)
+        ninjafile:print(" MODMAP = %s", object.modmapfile)
+        ninjafile:print(" dyndep = %s", ddfile)
+        ninjafile:print("")
+        table.insert(objectfiles, object.objectfile)
+    end
+    return objectfiles, ddfile
 end
 
 -- add build rule for target
@@ -355,8 +592,18 @@ function _add_build_for_target(ninjafile, target, outputdir)
     -- https://github.com/xmake-io/xmake/issues/2337
     target:data_set("plugin.project.kind", "ninja")
 
+    -- build c++ modules for the moduleonly target
+    local orderdeps = _get_object_orderdeps(target, outputdir)
+    local has_modules = _get_modules_toolkind(target) ~= nil
+    if target:is_moduleonly() and has_modules then
+        ninjafile:print("# build target: %s", target:name())
+        local _, ddfile = _add_build_for_modules(ninjafile, target, outputdir, orderdeps)
+        ninjafile:print("build %s: phony %s", target:name(), ddfile)
+        return
+    end
+
     -- is phony target?
-    if target:is_phony() or target:is_headeronly() then
+    if target:is_phony() or target:is_headeronly() or target:is_moduleonly() then
         return _add_build_for_phony(ninjafile, target)
     end
 
@@ -368,6 +615,21 @@ function _add_build_for_target(ninjafile, target, outputdir)
     -- build target file
     ninjafile:printf("build %s: %s", targetfile, target:linker():kind())
     local objectfiles = target:objectfiles()
+    local module_sourcefiles
+    if has_modules then
+        module_sourcefiles = hashset.from(_get_modules_sourcefiles(target))
+        local objectset = hashset.new()
+        objectfiles = table.clone(objectfiles)
+        for _, objectfile in ipairs(objectfiles) do
+            objectset:insert(objectfile)
+        end
+        for _, sourcefile in module_sourcefiles:orderkeys() do
+            local objectfile = target:objectfile(sourcefile)
+            if objectset:insert(objectfile) then
+                table.insert(objectfiles, objectfile)
+            end
+        end
+    end
     for _, objectfile in ipairs(objectfiles) do
         ninjafile:write(" " .. _get_relative_unix_path(objectfile, outputdir))
     end
@@ -383,7 +645,7 @@ function _add_build_for_target(ninjafile, target, outputdir)
         ninjafile:write("  ")
         for _, dep in ipairs(deps) do
             local dep_target = project.target(dep, {namespace = target:namespace()});
-            if not dep_target:is_headeronly() then
+            if not dep_target:is_headeronly() and not dep_target:is_moduleonly() then
                 ninjafile:write(" " .. _get_relative_unix_path(dep_target:targetfile(), outputdir))
             end
         end
@@ -396,9 +658,35 @@ function _add_build_for_target(ninjafile, target, outputdir)
     local sourcebatches = target:sourcebatches()
     for _, sourcebatch in table.orderpairs(sourcebatches) do
         if _sourcebatch_is_built(sourcebatch) then
-            _add_build_for_objects(ninjafile, target, sourcebatch, outputdir)
+            _add_build_for_objects(ninjafile, target, sourcebatch, outputdir, orderdeps, module_sourcefiles)
+        end
+    end
+
+    -- build c++ modules
+    if has_modules then
+        _add_build_for_modules(ninjafile, target, outputdir, orderdeps)
+    end
+end
+
+-- add build rule for configfiles
+function _add_build_for_configfiles(ninjafile, project_targets, outputdir)
+    local srcfiles = {}
+    local dstfiles = {}
+    local dstset = hashset.new()
+    for _, target in table.orderpairs(project_targets) do
+        local _srcfiles, _dstfiles = target:configfiles()
+        for idx, dstfile in ipairs(_dstfiles) do
+            if dstset:insert(path.absolute(dstfile)) then
+                table.insert(srcfiles, _get_relative_unix_path(_srcfiles[idx], outputdir))
+                table.insert(dstfiles, _get_relative_unix_path(dstfile, outputdir))
+            end
         end
     end
+    if #dstfiles > 0 then
+        ninjafile:print("# build configfiles")
+        ninjafile:print("build %s: configfiles %s", table.concat(dstfiles, " "), table.concat(srcfiles, " "))
+        ninjafile:print("")
+    end
 end
 
 -- add build rule for generator
@@ -432,6 +720,9 @@ function _add_build_for_targets(ninjafile, outputdir)
         target:set("pcxxheader", nil)
     end
 
+    -- build configfiles
+    _add_build_for_configfiles(ninjafile, project_targets, outputdir)
+
     -- build targets
     for _, target in pairs(project_targets) do
         _add_build_for_target(ninjafile, target, outputdir)
@@ -457,11 +748,31 @@ function _add_build_for_targets(ninjafile, outputdir)
     ninjafile:print("default default\n")
 end
 
+-- check c++ modules support of all targets
+function _check_modules(project_targets)
+    for _, target in table.orderpairs(project_targets) do
+        if target:data("cxx.has_modules") then
+            if _get_modules_toolkind(target) then
+                _g.has_modules = true
+                _g.modules_targets = _g.modules_targets or {}
+                _g.modules_rulenames = _g.modules_rulenames or hashset.new()
+                if _g.modules_rulenames:insert(_get_modules_rulename(target, "cxx_module")) then
+                    table.insert(_g.modules_targets, target)
+                end
+            else
+                local _, toolname = target:tool("cxx")
+                wprint("target(%s): c++ modules are not supported by the ninja generator for %s!", target:name(), toolname)
+            end
+        end
+    end
+end
+
 function make(outputdir)
     local oldir = os.cd(os.projectdir())
 
     -- prepare targets
     target_cmds.prepare_targets()
+    _check_modules(target_utils.get_project_targets())
 
     -- open the build.ninja file
     --
@@ -470,8 +781,13 @@ function make(outputdir)
     --
     -- TODO maybe we need support more encoding for other languages
     --
+    -- we write it to a temporary file first, and update build.ninja only if it has been changed,
+    -- so ninja need not reload it (restat) if nothing is changed.
+    --
     local encoding = is_subhost("windows") and "gbk"
-    local ninjafile = io.open(path.join(outputdir, "build.ninja"), "w", {encoding = encoding})
+    local ninjapath = path.join(outputdir, "build.ninja")
+    local ninjapath_tmp = ninjapath .. ".tmp"
+    local ninjafile = io.open(ninjapath_tmp, "w", {encoding = encoding})
 
     -- add header
     _add_header(ninjafile)
@@ -484,6 +800,11 @@ function make(outputdir)
 
     -- close the ninjafile
     ninjafile:close()
+    if os.isfile(ninjapath) and io.readfile(ninjapath, {encoding = "binary"}) == io.readfile(ninjapath_tmp, {encoding = "binary"}) then
+        os.rm(ninjapath_tmp)
+    else
+        os.mv(ninjapath_tmp, ninjapath)
+    end
     os.cd(oldir)
 end
 
@@ -0,0 +1,163 @@
+--!A cross-platform build utility based on Lua
+--
+-- Licensed under the Apache License, Version 2.0 (the "License");
+-- you may not use this file except in compliance with the License.
+-- You may obtain a copy of the License at
+--
+--     http://www.apache.org/licenses/LICENSE-2.0
+--
+-- Unless required by applicable law or agreed to in writing, software
+-- distributed under the License is distributed on an "AS IS" BASIS,
+-- WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+-- See the License for the specific language governing permissions and
+-- limitations under the License.
+--
+-- Copyright (C) 2015-present, Xmake Open Source Community.
+--
+-- @author      ruki
+-- @file        dyndep.lua
+--
+
+-- imports
+import("core.base.json")
+import("core.base.hashset")
+
+-- escape path for ninja
+function _escape_path(filepath)
+    return (filepath:gsub("%$", "$$"):gsub(" ", "$ "):gsub(":", "$:"))
+end
+
+-- write file only if the content has been changed, it will keep the mtime for `restat = 1`
+function _write_if_changed(filepath, content)
+    if not os.isfile(filepath) or io.readfile(filepath, {encoding = "binary"}) ~= content then
+        io.writefile(filepath, content, {encoding = "binary"})
+    end
+end
+
+-- get the bmi file of module
+function _get_bmifile(bmidir, name, toolkind)
+    local bmiext = toolkind == "gcc" and ".gcm" or ".pcm"
+    return path.unix(path.join(bmidir, name:gsub(":", "-") .. bmiext))
+end
+
+-- get all required modules, including the transitive dependencies
+function _get_required_modules(modules, requires, objectfile, result, visited)
+    result = result or {}
+    visited = visited or hashset.new()
+    for _, name in ipairs(requires) do
+        if visited:insert(name) then
+            local module = modules[name]
+            if not module then
+                raise("module(%s) required by %s not found!", name, objectfile)
+            end
+            table.insert(result, {name = name, bmifile = module.bmifile})
+            _get_required_modules(modules, module.deps or {}, objectfile, result, visited)
+        end
+    end
+    return result
+end
+
+-- parse the p1689 dependency file generated by the scanner
+function _parse_ddifile(ddifile)
+    local objectfile = ddifile:sub(1, -5)
+    local object = {objectfile = objectfile, requires = {}}
+    local ddi = assert(json.loadfile(ddifile), "cannot load %s", ddifile)
+    for _, rule in ipairs(ddi.rules or {}) do
+        local provide = rule.provides and rule.provides[1]
+        if provide then
+            object.name = provide["logical-name"]
+        end
+        for _, dep in ipairs(rule.requires or {}) do
+            local method = dep["lookup-method"] or "by-name"
+            if method:startswith("include") then
+                raise("%s: header unit(%s) is not supported by the ninja generator!", objectfile, dep["logical-name"])
+            end
+            table.insert(object.requires, dep["logical-name"])
+        end
+    end
+    return object
+end
+
+-- get the module mapper content
+--
+-- - gcc: module mapper file for -fmodule-mapper=
+-- - clang: response file with -fmodule-output= and -fmodule-file=
+--
+function _get_modmap(toolkind, object, requires)
+    local lines = {}
+    if toolkind == "gcc" then
+        if object.name then
+            table.insert(lines, object.name .. " " .. path.unix(path.absolute(object.bmifile)))
+        end
+        for _, module in ipairs(requires) do
+            table.insert(lines, module.name .. " " .. path.unix(path.absolute(module.bmifile)))
+        end
+    else
+        if object.name then
+            table.insert(lines, "-x c++-module")
+            table.insert(lines, os.args("-fmodule-output=" .. object.bmifile))
+        else
+            table.insert(lines, "-x c++")
+        end
+        for _, module in ipairs(requires) do
+            table.insert(lines, os.args("-fmodule-file=" .. module.name .. "=" .. module.bmifile))
+        end
+    end
+    return table.concat(lines, "\n") .. "\n"
+end
+
+-- generate the ninja dyndep file and module mapper files of target from all scanned files
+--
+-- e.g.
+--
+-- $ xmake l dyndep.lua gcc modules.dd modules.json bmidir - a.cpp.o.ddi b.mpp.o.ddi
+--
+-- ninja_dyndep_version = 1
+-- build b.mpp.o | bmidir/b.gcm: dyndep
+-- build a.cpp.o: dyndep | bmidir/b.gcm
+--
+function main(toolkind, ddfile, modulesfile, bmidir, depsfiles, ...)
+
+    -- load the modules provided by the dependent targets
+    local modules = {}
+    if depsfiles ~= "-" then
+        for _, depsfile in ipairs(depsfiles:split(",", {plain = true})) do
+            for name, module in pairs(json.loadfile(depsfile) or {}) do
+                modules[name] = module
+            end
+        end
+    end
+
+    -- parse all scanned files of this target
+    local objects = {}
+    for _, ddifile in ipairs({...}) do
+        local object = _parse_ddifile(ddifile)
+        if object.name then
+            object.bmifile = _get_bmifile(bmidir, object.name, toolkind)
+            modules[object.name] = {bmifile = object.bmifile, deps = object.requires}
+        end
+        table.insert(objects, object)
+    end
+
+    -- generate dyndep and module mapper files
+    local lines = {"ninja_dyndep_version = 1"}
+    for _, object in ipairs(objects) do
+        local requires = _get_required_modules(modules, object.requires, object.objectfile)
+        local line = "build " .. _escape_path(object.objectfile)
+        if object.bmifile then
+            line = line .. " | " .. _escape_path(object.bmifile)
+        end
+        line = line .. ": dyndep"
+        if #requires > 0 then
+            local bmifiles = {}
+            for _, module in ipairs(requires) do
+                table.insert(bmifiles, _escape_path(module.bmifile))
+            end
+            line = line .. " | " .. table.concat(bmifiles, " ")
+        end
+        table.insert(lines, line)
+        _write_if_changed(object.objectfile .. ".modmap", _get_modmap(toolkind, object, requires))
+    end
+    _write_if_changed(ddfile, table.concat(lines, "\n") .. "\n")
+    _write_if_changed(modulesfile, json.encode(modules))
+end
@@ -155,7 +155,11 @@ function _make_targetinfo(mode, arch, target)
     targetinfo.linkdirs      = _make_dirs(_get_values_from_target(target, "linkdirs"))
     targetinfo.forceincludes = path.joinenv(table.wrap(_get_values_from_target(target, "forceincludes")))
     targetinfo.sourcedirs    = _make_dirs(_get_values_from_target(target, "values.project.vsxmake.sourcedirs"))
-    targetinfo.pcheaderfile  = target:pcheaderfile("cxx") or target:pcheaderfile("c")
+    -- the automatic precompiled header is only used by some sourcefiles, and they have included all headers in it,
+    -- so we need not force to include it for all sourcefiles
+    if not target:data("pcheader.auto.excluded") then
+        targetinfo.pcheaderfile = target:pcheaderfile("cxx") or target:pcheaderfile("c")
+    end
 
     -- save defines
     targetinfo.defines       = _make_arrs(_get_values_from_target(target, "defines"))
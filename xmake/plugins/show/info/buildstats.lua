@@ -0,0 +1,197 @@
+--!A cross-platform build utility based on Lua
+--
+-- Licensed under the Apache License, Version 2.0 (the "License");
+-- you may not use this file except in compliance with the License.
+-- You may obtain a copy of the License at
+--
+--     http://www.apache.org/licenses/LICENSE-2.0
+--
+-- Unless required by applicable law or agreed to in writing, software
+-- distributed under the License is distributed on an "AS IS" BASIS,
+-- WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+-- See the License for the specific language governing permissions and
+-- limitations under the License.
+--
+-- Copyright (C) 2015-present, Xmake Open Source Community.
+--
+-- @author      ruki
+-- @file        buildstats.lua
+--
+
+-- imports
+import("core.base.option")
+import("core.base.json")
+import("core.project.config")
+import("private.cache.build_stats")
+
+-- the max count of the shown files
+local MAX_FILES = 20
+
+-- get the key of record
+function _get_recordkey(record)
+    return record.kind .. "|" .. record.target .. "|" .. record.file
+end
+
+-- get the last samples of all files, we ignore the cache hits because they are not the real build cost
+function _get_samples(builds, name)
+    local samples = {}
+    for _, build in ipairs(builds) do
+        for _, record in ipairs(build.records) do
+            if record.cache ~= "hit" and (not name or record.target == name) then
+                local key = _get_recordkey(record)
+                local sample = samples[key]
+                if sample == nil then
+                    sample = {}
+                    samples[key] = sample
+                end
+                if sample.current then
+                    sample.previous = sample.current
+                end
+                sample.current = record
+            end
+        end
+    end
+    return samples
+end
+
+-- get the slowest files of the last build
+function _get_slowest_files(records)
+    local files = {}
+    for _, record in ipairs(records) do
+        if record.cache ~= "hit" then
+            table.insert(files, record)
+        end
+    end
+    table.sort(files, function (a, b) return a.duration > b.duration end)
+    return table.slice(files, 1, MAX_FILES)
+end
+
+-- get the regressions of the last build compared to the previous build of the same file
+function _get_regressions(builds, records, name)
+    local regressions = {}
+    local samples = _get_samples(builds, name)
+    for _, record in ipairs(records) do
+        local sample = samples[_get_recordkey(record)]
+        if sample and sample.current == record and sample.previous then
+            local delta = record.duration - sample.previous.duration
+            if delta > 0 then
+                table.insert(regressions, {
+                    kind = record.kind,
+                    target = record.target,
+                    file = record.file,
+                    duration = record.duration,
+                    previous = sample.previous.duration,
+                    delta = delta})
+            end
+        end
+    end
+    table.sort(regressions, function (a, b) return a.delta > b.delta end)
+    return table.slice(regressions, 1, MAX_FILES)
+end
+
+-- get the totals of all targets in the last build
+function _get_target_totals(records)
+    local totals = {}
+    local targets = {}
+    for _, record in ipairs(records) do
+        local total = totals[record.target]
+        if total == nil then
+            total = {target = record.target, files = 0, hits = 0, compile = 0, link = 0}
+            totals[record.target] = total
+            table.insert(targets, total)
+        end
+        if record.kind == "compile" then
+            total.files = total.files + 1
+            total.compile = total.compile + record.duration
+            if record.cache == "hit" then
+                total.hits = total.hits + 1
+            end
+        else
+            total.link = total.link + record.duration
+        end
+    end
+    table.sort(targets, function (a, b) return a.compile + a.link > b.compile + b.link end)
+    return targets
+end
+
+-- get the size string
+function _get_sizestr(size)
+    if not size then
+        return "-"
+    elseif size >= 1024 * 1024 then
+        return string.format("%.1fM", size / (1024 * 1024))
+    elseif size >= 1024 then
+        return string.format("%.1fK", size / 1024)
+    end
+    return tostring(size)
+end
+
+-- show the build stats
+function _show_stats(stats)
+    cprint("${bright}slowest files:${clear}")
+    for _, record in ipairs(stats.slowest) do
+        cprint("    ${color.dump.number}%8.3fs${clear} %-6s %s ${dim}(%s, cache: %s, preprocessed: %s)${clear}",
+            record.duration / 1000, record.kind, record.file, record.target, record.cache or "-", _get_sizestr(record.ppsize))
+    end
+    print("")
+    cprint("${bright}regressions:${clear}")
+    if #stats.regressions == 0 then
+        cprint("    ${dim}none${clear}")
+    end
+    for _, record in ipairs(stats.regressions) do
+        cprint("    ${color.failure}+%7.3fs${clear} %-6s %s ${dim}(%s, %.3fs -> %.3fs)${clear}",
+            record.delta / 1000, record.kind, record.file, record.target, record.previous / 1000, record.duration / 1000)
+    end
+    print("")
+    cprint("${bright}targets:${clear}")
+    for _, total in ipairs(stats.targets) do
+        cprint("    ${color.dump.string}%s${clear}: %d files (%d cache hits), compile: %.3fs, link: %.3fs",
+            total.target, total.files, total.hits, total.compile / 1000, total.link / 1000)
+    end
+end
+
+-- show the build stats of the last build, e.g.
+--
+-- $ xmake show -i buildstats
+-- $ xmake show -i buildstats -t foo
+-- $ xmake show -i buildstats --format=json
+--
+function main(name)
+    config.load()
+
+    local builds = build_stats.load()
+    if #builds == 0 then
+        cprint("${color.warning}no build stats found, please run `xmake` first.")
+        return
+    end
+
+    -- get the records of the last build
+    local records = {}
+    for _, record in ipairs(builds[#builds].records) do
+        if not name or record.target == name then
+            table.insert(records, record)
+        end
+    end
+
+    local stats = {
+        time = builds[#builds].time,
+        slowest = _get_slowest_files(records),
+        regressions = _get_regressions(builds, records, name),
+        targets = _get_target_totals(records)}
+    local format = option.get("format") or "plain"
+    if format == "plain" and option.get("json") then
+        format = "json"
+    end
+    if format == "json" then
+        json.mark_as_array(stats.slowest)
+        json.mark_as_array(stats.regressions)
+        json.mark_as_array(stats.targets)
+        local json_opt = {pretty = true, orderkeys = true}
+        if option.get("json") and not option.get("pretty") then
+            json_opt = nil
+        end
+        print(json.encode(stats, json_opt))
+    else
+        _show_stats(stats)
+    end
+end
@@ -23,6 +23,7 @@ import("core.base.option")
 import("core.base.json")
 import("core.base.hashset")
 import("core.project.config")
+import("core.project.depend")
 import("core.language.language")
 import("private.detect.check_targetnames")
 
@@ -292,6 +293,13 @@ function _collect_target_info(target)
             flags = os.args(linker:linkflags()),
             flags_with_target = os.args(linker:linkflags({target = target}))
         }
+
+        -- get the last link time
+        local dependinfo = os.isfile(target:dependfile()) and depend.load(target:dependfile())
+        if dependinfo and dependinfo.linktime then
+            info.linker.linktime = dependinfo.linktime
+            info.linker.fastlinker = dependinfo.linker
+        end
     end
     return info
 end
@@ -356,6 +364,10 @@ function _print_target_info(info)
         cprint("      ${color.dump.reference}->${clear} %s", info.linker.flags)
         cprint("    ${color.dump.string}linkflags (%s)${clear}:", info.linker.kind)
         cprint("      ${color.dump.reference}->${clear} %s", info.linker.flags_with_target)
+        if info.linker.linktime then
+            cprint("    ${color.dump.string}linktime${clear}: %0.3fs%s", info.linker.linktime / 1000,
+                info.linker.fastlinker and (" (" .. info.linker.fastlinker .. ")") or "")
+        end
     end
 end
 
@@ -44,6 +44,7 @@ task("show")
                                          "    - xmake show --info=depgraph --target=app",
                                          "    - xmake show --info=depgraph --format=json",
                                          "    - xmake show --info=depgraph --format=dot",
+                                         "    - xmake show --info=buildstats",
                                          values = function (complete, opt)
                                              return import("list").infos()
                                          end},
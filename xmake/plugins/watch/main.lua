@@ -20,8 +20,17 @@
 
 -- imports
 import("core.base.option")
+import("core.base.task")
+import("core.base.hashset")
 import("core.base.fwatcher")
 import("core.project.config")
+import("core.project.depend")
+import("core.project.project")
+import("async.runjobs", {alias = "async_runjobs"})
+import("async.jobgraph", {alias = "async_jobgraph"})
+import("private.cache.build_stats")
+import("private.action.build.target", {alias = "target_buildutils"})
+import("private.action.build.depindex")
 
 -- add watchdir
 function _add_watchdir(watchdir, opt)
@@ -111,32 +120,259 @@ function _run_command(events)
     }
 end
 
+-- run target
+function _run_target()
+    local argv = {"run"}
+    if option.get("verbose") then
+        table.insert(argv, "-v")
+    end
+    if option.get("diagnosis") then
+        table.insert(argv, "-D")
+    end
+    local target = option.get("target")
+    if target then
+        table.insert(argv, target)
+    end
+    os.execv(os.programfile(), argv)
+end
+
+-- get the event status
+function _get_event_status(event)
+    if event.type == fwatcher.ET_CREATE then
+        return "created"
+    elseif event.type == fwatcher.ET_MODIFY then
+        return "modified"
+    elseif event.type == fwatcher.ET_DELETE then
+        return "deleted"
+    end
+end
+
+-- is incremental mode? we rebuild the changed files in the current process, e.g. `xmake watch -i`
+function _is_incremental()
+    return option.get("incremental") and os.isfile(os.projectfile()) and not option.get("commands")
+        and not option.get("script") and not option.get("arbitrary")
+end
+
+-- get the watched targets, root targets and their deps
+function _get_targets()
+    local targets = {}
+    local targetrefs = hashset.new()
+    local targetname = option.get("target")
+    for _, target in ipairs(target_buildutils.get_root_targets(targetname and {targetname} or nil)) do
+        for _, t in ipairs(table.join(target:orderdeps(), target)) do
+            if targetrefs:insert(t:fullname()) then
+                table.insert(targets, t)
+            end
+        end
+    end
+    return targets
+end
+
+-- build all targets in the current process
+function _build_all(state)
+    local ok = try
+    {
+        function ()
+            depend.clear_timecache()
+            task.run("build", {target = option.get("target")})
+            return true
+        end,
+        catch
+        {
+            function (errors)
+                cprint(tostring(errors))
+            end
+        }
+    }
+    if ok then
+        state.targets = _get_targets()
+        state.index = depindex.new(state.targets)
+    end
+    return ok
+end
+
+-- has the precompiled header in the given dirty objects?
+function _has_pcheader(objects)
+    for _, object in ipairs(objects) do
+        if object.pcheader then
+            return true
+        end
+    end
+end
+
+-- rebuild the dirty objects and relink the affected targets in the current process
+function _build_objects(state, objects)
+    local oldir = os.cd(project.directory())
+    local ok = try
+    {
+        function ()
+            depend.clear_timecache()
+
+            -- add object jobs for each dirty target
+            local jobgraph = async_jobgraph.new("build")
+            local object_groups = {}
+            local dirty_targets = hashset.new()
+            local target_objects = {}
+            for _, object in ipairs(objects) do
+                local targetname = object.target:fullname()
+                dirty_targets:insert(targetname)
+                target_objects[targetname] = target_objects[targetname] or {}
+                table.insert(target_objects[targetname], object)
+            end
+            for targetname, items in pairs(target_objects) do
+                local filepatterns = {}
+                for _, object in ipairs(items) do
+                    table.insert(filepatterns, {pattern = path.pattern(object.sourcefile)})
+                end
+
+                -- we also need to run the before_build scripts of target and rules, e.g. the code generators
+                local target = items[1].target
+                local group_before = target_buildutils.add_targetjobs_with_stage(jobgraph, target, "before", {job_kind = "build"})
+                local group = targetname .. "/watch_objects"
+                jobgraph:group(group, function ()
+                    target_buildutils.add_filejobs(jobgraph, target, {job_kind = "build", filepatterns = filepatterns})
+                end)
+                jobgraph:add_orders(group_before, group)
+                object_groups[targetname] = group
+            end
+
+            -- add link jobs for the dirty targets and the targets depending on them
+            local link_groups = {}
+            local link_targets = depindex.link_targets(state.targets, dirty_targets)
+            for _, target in ipairs(state.targets) do
+                local targetname = target:fullname()
+                if link_targets[targetname] then
+                    local group = targetname .. "/watch_link"
+                    jobgraph:group(group, function ()
+                        target_buildutils.add_linkjobs(jobgraph, target, {job_kind = "build"})
+                    end)
+                    link_groups[targetname] = group
+                    jobgraph:add_orders(object_groups[targetname], group)
+                    for _, dep in ipairs(target:orderdeps()) do
+                        jobgraph:add_orders(object_groups[dep:fullname()], group)
+                        jobgraph:add_orders(link_groups[dep:fullname()], group)
+                    end
+                end
+            end
+
+            -- run jobs
+            if not jobgraph:empty() then
+                async_runjobs("build", jobgraph, {
+                    comax = os.default_njob(),
+                    curdir = project.directory(),
+                    progress_factor = 1,
+                    progress_refresh = true})
+            end
+            build_stats.save()
+            return true
+        end,
+        catch
+        {
+            function (errors)
+                build_stats.save()
+                cprint(tostring(errors))
+            end
+        }
+    }
+
+    os.cd(oldir)
+
+    -- the included headers may be changed, so we need to update the dependencies of the rebuilt objects
+    depindex.update(state.index, objects)
+    return ok
+end
+
+-- is the project stale? e.g. the project files are changed or the source files are added/removed
+function _is_stale(state, events)
+    for _, event in ipairs(events) do
+        local filepath = event.path
+        if path.extension(filepath) == ".lua" then
+            return true
+        end
+        if event.type == fwatcher.ET_CREATE and depindex.is_sourcekind(state.index, filepath) then
+            return true
+        end
+        if event.type == fwatcher.ET_DELETE and depindex.is_sourcefile(state.index, filepath) then
+            return true
+        end
+    end
+end
+
+-- rebuild the changed files in the current process
+--
+-- we load the project once, and only rebuild the objects depending on the changed files,
+-- so we need not reload the project and check all dependencies in a new process for each change.
+--
+-- the project may be changed, e.g. xmake.lua is modified or the source files are added/removed,
+-- we cannot reload it in the current process, so we fallback to the full build in a new process.
+--
+function _watch_incremental()
+    local state = {}
+    local ok = _build_all(state)
+    if ok and option.get("run") then
+        _run_target()
+    end
+    while true do
+        local count, events = fwatcher.wait_events(-1, {debounce = tonumber(option.get("debounce"))})
+        if count > 0 then
+            for _, event in ipairs(events) do
+                print(event.path, _get_event_status(event))
+            end
+            if state.stale or (state.index and _is_stale(state, events)) then
+                if not state.stale then
+                    cprint("${color.warning}the project has been changed, we will do the full build in a new process, please restart `xmake watch` to enable the incremental build.")
+                    state.stale = true
+                end
+                _run_command(events)
+            else
+                -- we cannot find the dirty objects of the unknown files, e.g. the configuration files or
+                -- the included files which are not recorded in the dependfiles, so we need to check all dependencies.
+                local files = {}
+                local unknown = false
+                for _, event in ipairs(events) do
+                    table.insert(files, event.path)
+                    if state.index and not depindex.has_file(state.index, event.path) then
+                        unknown = true
+                    end
+                end
+                local objects = state.index and not unknown and depindex.dirty_objects(state.index, files)
+                if objects and _has_pcheader(objects) then
+                    -- all objects using the precompiled header need to be rebuilt after rebuilding it
+                    objects = nil
+                end
+                if objects then
+                    if #objects > 0 then
+                        ok = _build_objects(state, objects)
+                    end
+                else
+                    ok = _build_all(state)
+                end
+                if ok and option.get("run") then
+                    _run_target()
+                end
+            end
+        end
+    end
+end
+
 function main()
 
     -- add watchdirs
     _add_watchdirs()
 
+    -- do incremental build
+    if _is_incremental() then
+        return _watch_incremental()
+    end
+
     -- do watch
-    local count = 0
-    local events = {}
     while true do
-        local ok, event = fwatcher.wait(300)
-        if ok > 0 then
-            local status
-            if event.type == fwatcher.ET_CREATE then
-                status = "created"
-            elseif event.type == fwatcher.ET_MODIFY then
-                status = "modified"
-            elseif event.type == fwatcher.ET_DELETE then
-                status = "deleted"
+        local count, events = fwatcher.wait_events(-1, {debounce = tonumber(option.get("debounce"))})
+        if count > 0 then
+            for _, event in ipairs(events) do
+                print(event.path, _get_event_status(event))
             end
-            print(event.path, status)
-            -- we use map to remove repeat events
-            events[event.path .. tostring(event.type)] = event
-            count = count + 1
-        elseif count > 0 then
-            _run_command(table.values(events))
-            count = 0
+            _run_command(events)
         end
     end
 end
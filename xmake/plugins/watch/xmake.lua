@@ -41,6 +41,10 @@ task("watch")
                                           "    $ xmake watch -p src",
                                           "    $ xmake watch -p 'src/*" .. path.envsep() .. "tests/**/subdir'"},
             {'r', "run",       "k",  nil, "Build and run target."},
+            {'i', "incremental", "k", nil, "Rebuild only the changed files in the current process instead of running the full build in a new process.",
+                                          "e.g.",
+                                          "    $ xmake watch -i"},
+            {nil, "debounce",  "kv", "100", "Set the debounce time (ms) to coalesce the file events."},
             {'t', "target",    "kv", nil, "Build the given target.",
                                           values = function (complete, opt) return import("private.utils.complete_helper.targets")(complete, opt) end},
             {'-', "arbitrary", "vs", nil, "Run an arbitrary command.",
@@ -0,0 +1,111 @@
+--!A cross-platform build utility based on Lua
+--
+-- Licensed under the Apache License, Version 2.0 (the "License");
+-- you may not use this file except in compliance with the License.
+-- You may obtain a copy of the License at
+--
+--     http://www.apache.org/licenses/LICENSE-2.0
+--
+-- Unless required by applicable law or agreed to in writing, software
+-- distributed under the License is distributed on an "AS IS" BASIS,
+-- WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+-- See the License for the specific language governing permissions and
+-- limitations under the License.
+--
+-- Copyright (C) 2015-present, Xmake Open Source Community.
+--
+-- @author      ruki
+-- @file        fast_linker.lua
+--
+
+-- imports
+import("lib.detect.find_tool")
+
+-- get the merged link flags of target, e.g. the flags from toolchains, options, packages and the dependent targets
+function _get_linkflags(target, linker)
+    return linker:linkflags({target = target})
+end
+
+-- has the given flag prefix in the link flags?
+function _has_linkflag(linkflags, prefixes)
+    for _, flag in ipairs(linkflags) do
+        for _, prefix in ipairs(prefixes) do
+            if flag:startswith(prefix) then
+                return true
+            end
+        end
+    end
+end
+
+-- get the candidate linkers, mold is faster than lld, so we try it first
+--
+-- - gcc passes its own lto plugin to the linker, only mold supports it, lld only supports llvm lto
+-- - mold does not fully support the linker scripts, but lld does
+--
+function _get_candidates(target, ld, linkflags)
+    local candidates = {"mold", "lld"}
+    local is_gcc = ld == "gcc" or ld == "gxx"
+    if target:policy("build.optimization.lto") or _has_linkflag(linkflags, {"-flto"}) then
+        candidates = is_gcc and {"mold"} or {"lld"}
+    end
+    if _has_linkflag(linkflags, {"-T", "-Wl,-T", "-Wl,--script", "-Wl,-script"}) then
+        table.remove_if(candidates, function (_, name) return name == "mold" end)
+    end
+    return candidates
+end
+
+-- find the fast linker program, e.g. mold, ld.lld
+function _find_linker(name)
+    local linkers = _g.linkers
+    if linkers == nil then
+        linkers = {}
+        _g.linkers = linkers
+    end
+    local linker = linkers[name]
+    if linker == nil then
+        linker = find_tool(name == "lld" and "ld.lld" or name) or false
+        linkers[name] = linker
+    end
+    return linker or nil
+end
+
+-- select the fastest available linker
+function _add_fast_linker(target)
+    local _, ld = target:tool(target:is_shared() and "sh" or "ld")
+    if ld ~= "gcc" and ld ~= "gxx" and ld ~= "clang" and ld ~= "clangxx" then
+        return
+    end
+
+    -- the linker has been specified by user?
+    local linker = target:linker()
+    if not linker then
+        return
+    end
+    local linkflags = _get_linkflags(target, linker)
+    if _has_linkflag(linkflags, {"-fuse-ld=", "--ld-path="}) then
+        return
+    end
+
+    local flagskind = target:is_shared() and "shflags" or "ldflags"
+    for _, name in ipairs(_get_candidates(target, ld, linkflags)) do
+        if _find_linker(name) and linker:has_flags("-fuse-ld=" .. name, flagskind) then
+            target:add(flagskind, "-fuse-ld=" .. name)
+            target:data_set("build.linker.fast", name)
+            break
+        end
+    end
+end
+
+-- main entry
+function main(target, sourcekind)
+    if not (target:is_binary() or target:is_shared()) or target:data("build.linker.fast") ~= nil then
+        return
+    end
+    if target:policy("build.linker.fast")
+        and not target:is_plat("windows", "mingw", "msys", "cygwin", "macosx", "iphoneos", "watchos", "appletvos", "applexros") then
+        _add_fast_linker(target)
+    end
+    if target:data("build.linker.fast") == nil then
+        target:data_set("build.linker.fast", false)
+    end
+end
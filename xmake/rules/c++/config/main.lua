@@ -24,6 +24,8 @@ import("rules.c++.config.dynamic_debugging", {rootdir = os.programdir(), alias =
 import("rules.c++.config.optimization", {rootdir = os.programdir(), alias = "config_optimization"})
 import("rules.c++.config.sanitizer", {rootdir = os.programdir(), alias = "config_sanitizer"})
 import("rules.c++.config.runtime", {rootdir = os.programdir(), alias = "config_runtime"})
+import("rules.c++.config.fast_linker", {rootdir = os.programdir(), alias = "config_fast_linker"})
+import("rules.c++.config.split_dwarf", {rootdir = os.programdir(), alias = "config_split_dwarf"})
 
 -- main entry
 function main(target, sourcekind)
@@ -42,5 +44,11 @@ function main(target, sourcekind)
 
     -- config sanitizer configs
     config_sanitizer(target, sourcekind)
+
+    -- config fast linker (must be before split dwarf to check the linker flags)
+    config_fast_linker(target, sourcekind)
+
+    -- config split dwarf configs
+    config_split_dwarf(target, sourcekind)
 end
 
@@ -0,0 +1,80 @@
+--!A cross-platform build utility based on Lua
+--
+-- Licensed under the Apache License, Version 2.0 (the "License");
+-- you may not use this file except in compliance with the License.
+-- You may obtain a copy of the License at
+--
+--     http://www.apache.org/licenses/LICENSE-2.0
+--
+-- Unless required by applicable law or agreed to in writing, software
+-- distributed under the License is distributed on an "AS IS" BASIS,
+-- WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+-- See the License for the specific language governing permissions and
+-- limitations under the License.
+--
+-- Copyright (C) 2015-present, Xmake Open Source Community.
+--
+-- @author      ruki
+-- @file        split_dwarf.lua
+--
+
+-- get the link flags to select the linker, e.g. -fuse-ld=mold, --ld-path=/usr/bin/ld.lld
+function _get_linker_selectflags(target, linker)
+    local flags = {}
+    for _, flag in ipairs(linker:linkflags({target = target})) do
+        if flag:startswith("-fuse-ld=") or flag:startswith("--ld-path=") then
+            table.insert(flags, flag)
+        end
+    end
+    return flags
+end
+
+-- add split dwarf flags
+--
+-- the debug info will be written to the .dwo file next to each object file,
+-- so the linker need not read and copy it.
+--
+function _add_split_dwarf(target, sourcekind)
+    local _, cc = target:tool(sourcekind)
+    if cc ~= "gcc" and cc ~= "gxx" and cc ~= "clang" and cc ~= "clangxx" then
+        return
+    end
+    local flagnames = {
+        cc = "cflags",
+        cxx = "cxxflags",
+        mm = "mflags",
+        mxx = "mxxflags"
+    }
+    local cflag = flagnames[sourcekind] or "cxflags"
+    target:add(cflag, "-gsplit-dwarf")
+    target:data_set("build.split_dwarf", true)
+
+    -- add gdb index to speed up loading debug info in gdb, only gold/lld/mold support it
+    --
+    -- we need to check it with the linker selected by the link flags, e.g. `-fuse-ld=mold` added by the fast linker.
+    if target:is_binary() or target:is_shared() then
+        local linker = target:linker()
+        local flagskind = target:is_shared() and "shflags" or "ldflags"
+        if linker and linker:has_flags(table.join(_get_linker_selectflags(target, linker), "-Wl,--gdb-index"), flagskind) then
+            target:add(cflag, "-ggnu-pubnames")
+            target:add(flagskind, "-Wl,--gdb-index")
+        end
+        if target:policy("build.debug.split_dwarf.dwp") then
+            target:add("cleanfiles", target:targetfile() .. ".dwp")
+        end
+    end
+end
+
+-- has debug symbols? the compiler will not generate .dwo file without them
+function _has_debug_symbols(target)
+    return table.contains(table.wrap(target:get("symbols")), "debug")
+end
+
+-- main entry
+function main(target, sourcekind)
+    -- split dwarf is only supported for elf
+    if _has_debug_symbols(target) and target:policy("build.debug.split_dwarf")
+        and not target:is_plat("windows", "mingw", "msys", "cygwin", "macosx", "iphoneos", "watchos", "appletvos", "applexros") then
+        _add_split_dwarf(target, sourcekind)
+    end
+end
@@ -22,6 +22,7 @@
 import("core.base.semver")
 import("core.base.option")
 import("core.base.json")
+import("core.cache.fingerprintcache")
 import("lib.detect.find_tool")
 import("lib.detect.find_file")
 import(".support", {inherit = true})
@@ -161,17 +162,25 @@ function toolchain_includedirs(target)
                 runtime_flag = "-stdlib=libstdc++"
             end
         end
-        local _, result = try {function () return os.iorunv(clang, table.join({"-E", "-Wp,-v", "-xc++", os.nuldev()}, runtime_flag or {})) end}
-        if result then
-            for _, line in ipairs(result:split("\n", {plain = true})) do
-                local line = line:trim()
-                if os.isdir(line) then
-                    table.insert(includedirs, path.normalize(line))
-                elseif line:startswith("End") then
-                    break
+        -- the default include directories are cached in the global fingerprint cache, they are same for all projects
+        local fingerprintkey = "rules.c++.modules.includedirs_" .. (runtime_flag or "")
+        local default_includedirs = fingerprintcache.get(clang, fingerprintkey)
+        if default_includedirs == nil then
+            default_includedirs = {}
+            local _, result = try {function () return os.iorunv(clang, table.join({"-E", "-Wp,-v", "-xc++", os.nuldev()}, runtime_flag or {})) end}
+            if result then
+                for _, line in ipairs(result:split("\n", {plain = true})) do
+                    local line = line:trim()
+                    if os.isdir(line) then
+                        table.insert(default_includedirs, path.normalize(line))
+                    elseif line:startswith("End") then
+                        break
+                    end
                 end
+                fingerprintcache.set(clang, fingerprintkey, default_includedirs)
             end
         end
+        table.join2(includedirs, default_includedirs)
         _g.includedirs = includedirs
     end
     return includedirs
@@ -22,6 +22,7 @@
 import("core.base.json")
 import("core.base.semver")
 import("core.project.config")
+import("core.cache.fingerprintcache")
 import("lib.detect.find_tool")
 import(".support", {inherit = true})
 
@@ -111,17 +112,25 @@ function toolchain_includedirs(target)
         local gcc, toolname = target:tool("cxx")
         assert(toolname == "gcc" or toolname == "gxx")
         _get_toolchain_includedirs_for_stlheaders(includedirs, gcc)
-        local _, result = try {function () return os.iorunv(gcc, {"-E", "-Wp,-v", "-xc", os.nuldev()}) end}
-        if result then
-            for _, line in ipairs(result:split("\n", {plain = true})) do
-                local line = line:trim()
-                if os.isdir(line) then
-                    table.insert(includedirs, path.normalize(line))
-                elseif line:startswith("End") then
-                    break
+        -- the default include directories are cached in the global fingerprint cache, they are same for all projects
+        local fingerprintkey = "rules.c++.modules.includedirs"
+        local default_includedirs = fingerprintcache.get(gcc, fingerprintkey)
+        if default_includedirs == nil then
+            default_includedirs = {}
+            local _, result = try {function () return os.iorunv(gcc, {"-E", "-Wp,-v", "-xc", os.nuldev()}) end}
+            if result then
+                for _, line in ipairs(result:split("\n", {plain = true})) do
+                    local line = line:trim()
+                    if os.isdir(line) then
+                        table.insert(default_includedirs, path.normalize(line))
+                    elseif line:startswith("End") then
+                        break
+                    end
                 end
+                fingerprintcache.set(gcc, fingerprintkey, default_includedirs)
             end
         end
+        table.join2(includedirs, default_includedirs)
         _g.includedirs = includedirs
     end
     return includedirs
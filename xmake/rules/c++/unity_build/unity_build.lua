@@ -19,7 +19,233 @@
 --
 
 -- imports
+import("core.base.option")
 import("core.project.depend")
+import("core.cache.localcache")
+
+-- the default wall-time budget (ms) of each unity file in auto batch mode
+local AUTO_BATCHTIME = 20000
+
+-- the default compile rate (bytes/ms) to estimate the cost of sourcefile without build history
+local AUTO_BYTES_PER_MS = 1000
+
+-- the default edit count and time window (days) to detect the frequently-edited files
+local AUTO_HOTEDITS = 3
+local AUTO_HOTDAYS = 7
+
+-- get the auto batch history of the given source batch
+function _auto_history(target, sourcebatch)
+    local key = target:fullname() .. "/" .. sourcebatch.rulename
+    local history = localcache.get("unity_build", key) or {}
+    history.files = history.files or {}
+    history.batches = history.batches or {}
+    return history, key
+end
+
+-- get the estimated size of sourcefile, it contains the size of all included headers if we have built it before
+function _auto_filesize(target, sourcefile, dependfile)
+    local size = os.filesize(sourcefile)
+    local dependinfo = os.isfile(dependfile) and depend.load(dependfile, {target = target})
+    if dependinfo and dependinfo.files then
+        for _, file in ipairs(dependinfo.files) do
+            if file ~= sourcefile then
+                size = size + os.filesize(file)
+            end
+        end
+    end
+    return size
+end
+
+-- update the build history of all candidate files
+--
+-- we get the compile duration from the dependfile of object file,
+-- and the duration of unity file will be apportioned to all sourcefiles in it by their size.
+--
+function _auto_update_history(target, history, candidates, opt)
+    local files = history.files
+    for _, batch in pairs(history.batches) do
+        local dependfile = batch.dependfile
+        local mtime = os.isfile(dependfile) and os.mtime(dependfile) or 0
+        if mtime > (batch.mtime or 0) then
+            local dependinfo = depend.load(dependfile, {target = target})
+            if dependinfo and dependinfo.duration then
+                local totalsize = 0
+                for _, sourcefile in ipairs(batch.sourcefiles) do
+                    totalsize = totalsize + math.max(os.filesize(sourcefile), 1)
+                end
+                for _, sourcefile in ipairs(batch.sourcefiles) do
+                    local fileinfo = files[sourcefile] or {}
+                    fileinfo.cost = dependinfo.duration * math.max(os.filesize(sourcefile), 1) / totalsize
+                    files[sourcefile] = fileinfo
+                end
+            end
+            batch.mtime = mtime
+        end
+    end
+
+    local now = os.time()
+    local hotdays = opt.hotdays or AUTO_HOTDAYS
+    for _, candidate in ipairs(candidates) do
+        local sourcefile = candidate.sourcefile
+        local fileinfo = files[sourcefile] or {}
+        files[sourcefile] = fileinfo
+
+        -- it was built as a standalone object file?
+        local dependfile = candidate.dependfile
+        local depmtime = os.isfile(dependfile) and os.mtime(dependfile) or 0
+        if depmtime > (fileinfo.depmtime or 0) then
+            local dependinfo = depend.load(dependfile, {target = target})
+            if dependinfo and dependinfo.duration then
+                fileinfo.cost = dependinfo.duration
+            end
+            fileinfo.size = nil
+            fileinfo.depmtime = depmtime
+        end
+
+        -- record the edit time
+        local mtime = os.mtime(sourcefile)
+        if fileinfo.mtime and mtime > fileinfo.mtime then
+            fileinfo.edits = fileinfo.edits or {}
+            table.insert(fileinfo.edits, now)
+        end
+        fileinfo.mtime = mtime
+        if fileinfo.edits then
+            local edits = {}
+            for _, edittime in ipairs(fileinfo.edits) do
+                if now - edittime < hotdays * 86400 then
+                    table.insert(edits, edittime)
+                end
+            end
+            fileinfo.edits = #edits > 0 and edits or nil
+        end
+        if not fileinfo.size then
+            fileinfo.size = _auto_filesize(target, sourcefile, dependfile)
+        end
+    end
+end
+
+-- get the cost of all candidate files
+function _auto_costs(history, candidates)
+    local files = history.files
+
+    -- calibrate the compile rate from the files with build history
+    local rate = AUTO_BYTES_PER_MS
+    local known_cost = 0
+    local known_size = 0
+    for _, candidate in ipairs(candidates) do
+        local fileinfo = files[candidate.sourcefile]
+        if fileinfo.cost and fileinfo.size then
+            known_cost = known_cost + fileinfo.cost
+            known_size = known_size + fileinfo.size
+        end
+    end
+    if known_cost > 0 and known_size > 0 then
+        rate = known_size / known_cost
+    end
+
+    local costs = {}
+    for _, candidate in ipairs(candidates) do
+        local fileinfo = files[candidate.sourcefile]
+        costs[candidate.sourcefile] = fileinfo.cost or (fileinfo.size or 0) / rate
+    end
+    return costs
+end
+
+-- generate batches automatically from the build cost of sourcefiles
+--
+-- e.g.
+-- add_rules("c++.unity_build", {batchsize = "auto", batchtime = 20000, hotedits = 3, hotdays = 7})
+--
+-- - we fill each unity file until its cost reaches the wall-time budget (batchtime, ms),
+--   but we also keep enough unity files to use all build jobs.
+-- - the files that are edited frequently are built as standalone object files.
+-- - we try to keep the previous batches to avoid rebuilding them when the costs are changed slightly.
+--
+function _auto_batches(target, sourcebatch, candidates, opt)
+    local history, key = _auto_history(target, sourcebatch)
+    _auto_update_history(target, history, candidates, opt)
+    local costs = _auto_costs(history, candidates)
+
+    -- get the frequently-edited files
+    local hotfiles = {}
+    local hotedits = opt.hotedits or AUTO_HOTEDITS
+    local batchfiles = {}
+    for _, candidate in ipairs(candidates) do
+        local fileinfo = history.files[candidate.sourcefile]
+        if fileinfo.edits and #fileinfo.edits >= hotedits then
+            hotfiles[candidate.sourcefile] = true
+        else
+            table.insert(batchfiles, candidate.sourcefile)
+        end
+    end
+
+    -- get the budget of each unity file
+    local totalcost = 0
+    for _, sourcefile in ipairs(batchfiles) do
+        totalcost = totalcost + costs[sourcefile]
+    end
+    local budget = opt.batchtime or AUTO_BATCHTIME
+    local njobs = math.max(tonumber(option.get("jobs")) or os.default_njob(), 1)
+    budget = math.max(math.min(budget, totalcost / njobs), 1)
+
+    -- keep the previous batches if they are still fine
+    local batches = {}
+    local assigned = {}
+    local candidate_set = {}
+    for _, sourcefile in ipairs(batchfiles) do
+        candidate_set[sourcefile] = true
+    end
+    for _, unityfile in ipairs(table.orderkeys(history.batches)) do
+        local batch = history.batches[unityfile]
+        local batchcost = 0
+        local valid = #batch.sourcefiles > 1
+        for _, sourcefile in ipairs(batch.sourcefiles) do
+            if not candidate_set[sourcefile] or assigned[sourcefile] then
+                valid = false
+                break
+            end
+            batchcost = batchcost + costs[sourcefile]
+        end
+        if valid and batchcost <= budget * 1.25 then
+            batches[unityfile] = batch
+            for _, sourcefile in ipairs(batch.sourcefiles) do
+                assigned[sourcefile] = true
+            end
+        end
+    end
+
+    -- fill new batches with the remaining files
+    local sourcedir = path.join(target:autogendir({root = true}), target:plat(), "unity_build")
+    local current
+    local current_cost = 0
+    local function add_batch(sourcefiles)
+        local sourcefile1 = sourcefiles[1]
+        local unityfile = path.join(sourcedir, "unity_auto_" .. hash.strhash32(sourcefile1) .. path.extension(sourcefile1))
+        batches[unityfile] = {sourcefiles = sourcefiles, dependfile = target:dependfile(target:objectfile(unityfile))}
+    end
+    for _, sourcefile in ipairs(batchfiles) do
+        if not assigned[sourcefile] then
+            local cost = costs[sourcefile]
+            if current and current_cost + cost > budget then
+                add_batch(current)
+                current = nil
+                current_cost = 0
+            end
+            current = current or {}
+            table.insert(current, sourcefile)
+            current_cost = current_cost + cost
+        end
+    end
+    if current then
+        add_batch(current)
+    end
+
+    -- save history
+    history.batches = batches
+    localcache.set("unity_build", key, history)
+    localcache.save("unity_build")
+    return batches, hotfiles
+end
 
 function _merge_unityfile(target, sourcefile_unity, sourcefiles, opt)
     local dependfile = target:dependfile(sourcefile_unity)
@@ -71,6 +297,10 @@ end
 -- add_files("src/foo/*.c", {unity_group = "foo"})
 -- add_files("src/bar/*.c", {unity_group = "bar"})
 --
+-- or generate batches automatically from the build cost of sourcefiles
+--
+-- add_rules("c++.unity_build", {batchsize = "auto", batchtime = 20000})
+--
 function main(target, sourcebatch)
 
     -- we cannot generate unity build files in project generator
@@ -82,6 +312,11 @@ function main(target, sourcebatch)
     local extraconf = target:extraconf("rules", sourcebatch.sourcekind == "cxx" and "c++.unity_build" or "c.unity_build")
     local batchsize = extraconf and extraconf.batchsize
     local uniqueid = extraconf and extraconf.uniqueid
+    local autobatch = batchsize == "auto"
+    if autobatch then
+        batchsize = nil
+    end
+    local candidates = {}
     local id = 1
     local count = 0
     local group_id = {}
@@ -116,6 +351,8 @@ function main(target, sourcebatch)
             table.insert(sourcefiles, sourcefile)
             table.insert(objectfiles, objectfile)
             table.insert(dependfiles, dependfile)
+        elseif autobatch then
+            table.insert(candidates, {sourcefile = sourcefile, objectfile = objectfile, dependfile = dependfile})
         else
             if batchsize and count >= batchsize then
                 id = id + 1
@@ -140,6 +377,33 @@ function main(target, sourcebatch)
         end
     end
 
+    -- generate batches automatically
+    if #candidates > 0 then
+        local batches, hotfiles = _auto_batches(target, sourcebatch, candidates, extraconf)
+        for _, candidate in ipairs(candidates) do
+            if hotfiles[candidate.sourcefile] then
+                table.insert(sourcefiles, candidate.sourcefile)
+                table.insert(objectfiles, candidate.objectfile)
+                table.insert(dependfiles, candidate.dependfile)
+            end
+        end
+        local candidate_map = {}
+        for _, candidate in ipairs(candidates) do
+            candidate_map[candidate.sourcefile] = candidate
+        end
+        for sourcefile_unity, batch in pairs(batches) do
+            local candidate1 = candidate_map[batch.sourcefiles[1]]
+            local sourceinfo = {}
+            sourceinfo.objectfile = target:objectfile(sourcefile_unity)
+            sourceinfo.dependfile = target:dependfile(sourceinfo.objectfile)
+            sourceinfo.sourcefile1 = candidate1.sourcefile
+            sourceinfo.objectfile1 = candidate1.objectfile
+            sourceinfo.dependfile1 = candidate1.dependfile
+            sourceinfo.sourcefiles = batch.sourcefiles
+            unity_batch[sourcefile_unity] = sourceinfo
+        end
+    end
+
     -- use unit batch
     for _, sourcefile_unity in ipairs(table.orderkeys(unity_batch)) do
         local sourceinfo = unity_batch[sourcefile_unity]